@@ -0,0 +1,135 @@
+/* ========================================================= */
+/*  GENERATEUR DE PROGRAMMES POUR LA MESURE DU COMPILATEUR    */
+/* ========================================================= */
+/*
+ * Ecrit sur la sortie standard un programme MathLang synthetique dont
+ * la forme est parametree :
+ *
+ *   gen_program [-f fonctions] [-d profondeur] [-w largeur]
+ *               [-s chaines] [-l lignes]
+ *
+ *   -f  nombre de fonctions (10 par defaut)
+ *   -d  profondeur d'imbrication des blocs dans chaque fonction :
+ *       POUR et SI alternes (3)
+ *   -w  nombre de termes de chaque expression (4)
+ *   -s  chaines litterales de 64 caracteres par fonction (0)
+ *   -l  nombre de lignes vise (10000) : les fonctions sont remplies
+ *       d'affectations jusqu'a l'atteindre
+ *
+ * Le programme principal appelle chaque fonction dans une boucle, avec
+ * des arguments qui dependent de la variable de boucle : aucun appel
+ * n'est evalue a la compilation. La sortie est deterministe pour des
+ * parametres donnes.
+ */
+
+#include <stdarg.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#define STRING_WIDTH 64
+
+static int functions = 10, depth = 3, width = 4, strings = 0;
+static long lines = 10000;
+
+static void line(int indent, const char* fmt, ...) {
+    va_list ap;
+    printf("%*s", indent * 4, "");
+    va_start(ap, fmt);
+    vprintf(fmt, ap);
+    va_end(ap);
+    putchar('\n');
+}
+
+/* Une affectation de "width" termes sur les variables visibles au
+   niveau "level" (n, s et les variables de boucle j1..) */
+static void assignment(int indent, int level, long seed) {
+    int loops = (level + 1) / 2;
+    printf("%*ss <- (s", indent * 4, "");
+    for (int t = 1; t < width; t++) {
+        int v = loops > 0 ? (int)((seed + t) % (loops + 1)) : 0;
+        long c = (seed * 31 + t * 7) % 97 + 2;
+        if (v == 0) printf(" + n * %ld", c);
+        else printf(" %c j%d * %ld", t % 3 == 2 ? '-' : '+', v, c);
+    }
+    printf(") mod 100003\n");
+}
+
+static void string_literal(int indent, int f, int k) {
+    char text[STRING_WIDTH + 1];
+    for (int i = 0; i < STRING_WIDTH; i++) text[i] = (char)('a' + (f * 7 + k * 13 + i) % 26);
+    text[STRING_WIDTH] = '\0';
+    line(indent, "AFFICHER_LIGNE(\"%s\")", text);
+}
+
+/* Lignes fixes d'une fonction hors affectations du bloc le plus
+   interne : en-tete, chaines, ouverture et fermeture des blocs (un SI
+   a aussi son SINON et son affectation), RETOURNER, FIN, ligne vide */
+static long function_overhead(void) {
+    long count = 4 + strings;
+    for (int level = 1; level <= depth; level++) count += level % 2 ? 2 : 4;
+    return count;
+}
+
+static void function(int f, long body) {
+    line(0, "FONCTION f%d(n : Z, s : Z) : Z", f);
+    for (int k = 0; k < strings; k++) string_literal(1, f, k);
+
+    /* Ouverture des blocs : POUR aux niveaux impairs, SI aux niveaux pairs */
+    for (int level = 1; level <= depth; level++) {
+        if (level % 2) {
+            line(level, "POUR j%d DE 1 A n FAIRE", (level + 1) / 2);
+        } else {
+            line(level, "SI j%d mod %d = 0 ALORS", level / 2, level + 1);
+        }
+    }
+    for (long k = 0; k < body; k++) assignment(depth + 1, depth, f * 1009L + k);
+    for (int level = depth; level >= 1; level--) {
+        if (level % 2 == 0) {
+            line(level, "SINON");
+            line(level + 1, "s <- s - j%d + %d", level / 2, f % 13 + 1);
+        }
+        line(level, "FIN");
+    }
+    line(1, "RETOURNER s mod 1000");
+    line(0, "FIN");
+    line(0, "%s", "");
+}
+
+static int usage(const char* prog) {
+    fprintf(stderr, "Usage : %s [-f fonctions] [-d profondeur] [-w largeur] [-s chaines] [-l lignes]\n",
+            prog);
+    return 1;
+}
+
+int main(int argc, char** argv) {
+    for (int i = 1; i < argc; i++) {
+        if (i + 1 >= argc || argv[i][0] != '-' || strlen(argv[i]) != 2) return usage(argv[0]);
+        long value = atol(argv[++i]);
+        switch (argv[i - 1][1]) {
+            case 'f': functions = (int)value; break;
+            case 'd': depth = (int)value; break;
+            case 'w': width = (int)value; break;
+            case 's': strings = (int)value; break;
+            case 'l': lines = value; break;
+            default: return usage(argv[0]);
+        }
+    }
+    if (functions < 1 || depth < 0 || width < 1 || strings < 0 || lines < 1) return usage(argv[0]);
+
+    /* Programme principal : 6 lignes plus un appel par fonction */
+    long main_lines = 6 + functions;
+    long body = (lines - main_lines) / functions - function_overhead();
+    if (body < 1) body = 1;
+
+    printf("# Programme genere : %d fonctions, profondeur %d, largeur %d, %d chaines par fonction\n",
+           functions, depth, width, strings);
+    for (int f = 1; f <= functions; f++) function(f, body);
+
+    line(0, "SOIT total dans Z tel que total <- 0");
+    line(0, "POUR k DE 1 A 3 FAIRE");
+    for (int f = 1; f <= functions; f++) line(1, "total <- total + f%d(k + %d, total)", f, f % 17);
+    line(0, "FIN");
+    line(0, "AFFICHER_LIGNE(total)");
+    return 0;
+}
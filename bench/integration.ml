@@ -0,0 +1,47 @@
+# Mesure de l'integration des petites fonctions (-finline, actif en -O1) :
+# une boucle POUR de 3e7 tours appelle trois fonctions courtes et une
+# procedure. Le C genere est compile par gcc sans -O, pour que gcc
+# n'integre pas lui-meme les appels.
+#
+#   ./parser -q --emit=c:a.c -fno-inline bench/integration.ml && gcc a.c -lm -o a && time ./a
+#   ./parser -q --emit=c:b.c bench/integration.ml && gcc b.c -lm -o b && time ./b
+
+SOIT total dans R tel que total <- 0.0
+SOIT cpt dans Z tel que cpt <- 0
+
+FONCTION somme_carres(a : R, b : R) : R
+    RETOURNER a * a + b * b
+FIN
+
+FONCTION maxi(a : Z, b : Z) : Z
+    SI a > b ALORS
+        RETOURNER a
+    FIN
+    RETOURNER b
+FIN
+
+FONCTION carre(x : Z) : Z
+    RETOURNER x * x
+FIN
+
+PROCEDURE incr(k : Z)
+    cpt <- cpt + k
+FIN
+
+FONCTION factorielle(n : Z) : Z
+    SI n <= 1 ALORS
+        RETOURNER 1
+    SINON
+        RETOURNER n * factorielle(n - 1)
+    FIN
+FIN
+
+POUR i DE 1 A 30000000 FAIRE
+    total <- total + somme_carres(i, 0.5)
+    cpt <- cpt + maxi(i mod 7, 3) + carre(i mod 5)
+    incr(1)
+FIN
+AFFICHER_LIGNE(total)
+AFFICHER_LIGNE(cpt)
+AFFICHER_LIGNE(factorielle(15))
+AFFICHER_LIGNE(maxi(4, 9))
@@ -0,0 +1,36 @@
+# Noyau : boucles numeriques imbriquees
+# Produit de deux matrices 200 x 200 definies par une formule (sans
+# tableaux, les coefficients sont recalcules a chaque acces), puis une
+# somme en reels sur trois niveaux de boucle.
+
+FONCTION coef(i : Z, j : Z) : Z
+    RETOURNER (i * 31 + j * 17) mod 101 - 50
+FIN
+
+SOIT diagonale dans Z tel que diagonale <- 0
+SOIT total dans Z tel que total <- 0
+SOIT c dans Z tel que c <- 0
+POUR i DE 1 A 200 FAIRE
+    POUR j DE 1 A 200 FAIRE
+        c <- 0
+        POUR k DE 1 A 200 FAIRE
+            c <- c + coef(i, k) * coef(k, j)
+        FIN
+        total <- (total + c) mod 1000003
+        SI i = j ALORS
+            diagonale <- diagonale + c
+        FIN
+    FIN
+FIN
+AFFICHER("diagonale = ") AFFICHER_LIGNE(diagonale)
+AFFICHER("somme = ") AFFICHER_LIGNE(total)
+
+SOIT s dans R tel que s <- 0.0
+POUR a DE 1 A 200 FAIRE
+    POUR b DE 1 A 200 FAIRE
+        POUR d DE 1 A 50 FAIRE
+            s <- s + (a * 0.5 - b * 0.25) * d / 1000.0
+        FIN
+    FIN
+FIN
+AFFICHER("reels = ") AFFICHER_LIGNE(s)
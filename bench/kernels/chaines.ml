@@ -0,0 +1,33 @@
+# Noyau : construction de chaines
+# Concatenations successives (chaque + alloue une nouvelle chaine) et
+# conversions de casse.
+
+SOIT mot dans Sigma tel que mot <- ""
+SOIT ligne dans Sigma tel que ligne <- ""
+SOIT derniere dans Sigma tel que derniere <- ""
+SOIT tours dans Z tel que tours <- 0
+POUR n DE 1 A 12000 FAIRE
+    ligne <- ""
+    POUR k DE 1 A 40 FAIRE
+        SI (n + k) mod 3 = 0 ALORS
+            mot <- "abc"
+        SINON SI (n + k) mod 3 = 1 ALORS
+            mot <- "De"
+        SINON
+            mot <- "f"
+        FIN
+        ligne <- ligne + mot
+    FIN
+    SI n mod 2 = 0 ALORS
+        ligne <- majuscules(ligne)
+    SINON
+        ligne <- minuscules(ligne)
+    FIN
+    derniere <- ligne + "|" + derniere
+    SI n mod 25 = 0 ALORS
+        derniere <- ""
+    FIN
+    tours <- tours + 1
+FIN
+AFFICHER_LIGNE(ligne)
+AFFICHER("tours = ") AFFICHER_LIGNE(tours)
@@ -0,0 +1,59 @@
+# Noyau : classification riche en branchements
+# Des valeurs pseudo-aleatoires (generateur congruentiel) sont rangees
+# dans des classes par des SI / SINON SI imbriques dont l'issue est peu
+# previsible.
+
+FONCTION classe(v : Z) : Z
+    SI v mod 2 = 0 ALORS
+        SI v mod 3 = 0 ALORS
+            RETOURNER 0
+        SINON SI v mod 5 = 0 ALORS
+            RETOURNER 1
+        SINON
+            RETOURNER 2
+        FIN
+    SINON SI v mod 7 < 3 ALORS
+        SI v > 500000 ALORS
+            RETOURNER 3
+        SINON
+            RETOURNER 4
+        FIN
+    SINON SI v mod 11 = 4 ALORS
+        RETOURNER 5
+    SINON SI v mod 13 = 6 ALORS
+        RETOURNER 5
+    FIN
+    RETOURNER 6
+FIN
+
+SOIT graine dans Z tel que graine <- 12345
+SOIT k0 dans Z tel que k0 <- 0
+SOIT k1 dans Z tel que k1 <- 0
+SOIT k2 dans Z tel que k2 <- 0
+SOIT k3 dans Z tel que k3 <- 0
+SOIT k4 dans Z tel que k4 <- 0
+SOIT k5 dans Z tel que k5 <- 0
+SOIT k6 dans Z tel que k6 <- 0
+SOIT k dans Z tel que k <- 0
+POUR i DE 1 A 3000000 FAIRE
+    graine <- (graine * 1103515245 + 12345) mod 2147483648
+    k <- classe(graine div 1024)
+    SI k = 0 ALORS
+        k0 <- k0 + 1
+    SINON SI k = 1 ALORS
+        k1 <- k1 + 1
+    SINON SI k = 2 ALORS
+        k2 <- k2 + 1
+    SINON SI k = 3 ALORS
+        k3 <- k3 + 1
+    SINON SI k = 4 ALORS
+        k4 <- k4 + 1
+    SINON SI k = 5 ALORS
+        k5 <- k5 + 1
+    SINON
+        k6 <- k6 + 1
+    FIN
+FIN
+AFFICHER(k0) AFFICHER(" ") AFFICHER(k1) AFFICHER(" ") AFFICHER(k2) AFFICHER(" ")
+AFFICHER(k3) AFFICHER(" ") AFFICHER(k4) AFFICHER(" ") AFFICHER(k5) AFFICHER(" ")
+AFFICHER_LIGNE(k6)
@@ -0,0 +1,35 @@
+# Noyau : arithmetique complexe
+# Ensemble de Mandelbrot sur une grille 160 x 80 : z <- z * z + c
+# jusqu'a |z| > 2 ou 1500 iterations. Affiche la grille et le nombre
+# total d'iterations.
+
+SOIT z dans C tel que z <- 0i
+SOIT c dans C tel que c <- 0i
+SOIT n dans Z tel que n <- 0
+SOIT total dans Z tel que total <- 0
+SOIT ligne dans Sigma tel que ligne <- ""
+POUR y DE 0 A 79 FAIRE
+    ligne <- ""
+    POUR x DE 0 A 159 FAIRE
+        c <- (x * 0.01875 - 2.0) + (y * 0.03 - 1.2) * 1i
+        z <- 0i
+        n <- 0
+        TANT QUE n < 1500 FAIRE
+            SI re(z) * re(z) + im(z) * im(z) > 4.0 ALORS
+                SORTIR
+            FIN
+            z <- z * z + c
+            n <- n + 1
+        FIN
+        total <- total + n
+        SI n = 1500 ALORS
+            ligne <- ligne + "#"
+        SINON SI n > 20 ALORS
+            ligne <- ligne + "+"
+        SINON
+            ligne <- ligne + "."
+        FIN
+    FIN
+    AFFICHER_LIGNE(ligne)
+FIN
+AFFICHER("iterations = ") AFFICHER_LIGNE(total)
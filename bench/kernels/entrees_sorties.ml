@@ -0,0 +1,14 @@
+# Noyau : entrees et sorties
+# Lit un nombre N puis N entiers sur l'entree standard (fournis par
+# bench/run_kernels.sh) et affiche une ligne par valeur lue.
+
+SOIT n dans Z tel que n <- 0
+SOIT v dans Z tel que v <- 0
+SOIT somme dans Z tel que somme <- 0
+LIRE(n)
+POUR i DE 1 A n FAIRE
+    LIRE(v)
+    somme <- somme + v
+    AFFICHER(i) AFFICHER(" : ") AFFICHER(v * 3 + 1) AFFICHER(" ") AFFICHER_LIGNE(somme)
+FIN
+AFFICHER("somme = ") AFFICHER_LIGNE(somme)
@@ -0,0 +1,36 @@
+# Noyau : recursion
+# Fibonacci naif (sans MEMOISER), fonction d'Ackermann et une recursion
+# terminale avec accumulateur.
+
+FONCTION fibonacci(n : Z) : Z
+    SI n <= 1 ALORS
+        RETOURNER n
+    SINON
+        RETOURNER fibonacci(n - 1) + fibonacci(n - 2)
+    FIN
+FIN
+
+FONCTION ackermann(m : Z, n : Z) : Z
+    SI m = 0 ALORS
+        RETOURNER n + 1
+    FIN
+    SI n = 0 ALORS
+        RETOURNER ackermann(m - 1, 1)
+    FIN
+    RETOURNER ackermann(m - 1, ackermann(m, n - 1))
+FIN
+
+FONCTION somme_chiffres(n : Z, acc : Z) : Z
+    SI n = 0 ALORS
+        RETOURNER acc
+    FIN
+    RETOURNER somme_chiffres(n div 10, acc + n mod 10)
+FIN
+
+AFFICHER("fibonacci(30) = ") AFFICHER_LIGNE(fibonacci(30))
+AFFICHER("ackermann(2, 2000) = ") AFFICHER_LIGNE(ackermann(2, 2000))
+SOIT chiffres dans Z tel que chiffres <- 0
+POUR i DE 1 A 300000 FAIRE
+    chiffres <- chiffres + somme_chiffres(i * 7919, 0)
+FIN
+AFFICHER("chiffres = ") AFFICHER_LIGNE(chiffres)
@@ -0,0 +1,87 @@
+/* ========================================================= */
+/*  MESURE D'UNE COMMANDE (temps et memoire)                  */
+/* ========================================================= */
+/*
+ *   measure [-t secondes] commande [arguments...]
+ *
+ * Lance la commande (sortie standard vers /dev/null, erreurs
+ * conservees) et ecrit sur la sortie standard "<ms> <ko>" : le temps
+ * ecoule en millisecondes et le pic de memoire residente en Ko. Le pic
+ * compte aussi les processus lances par la commande (cc1 pour gcc),
+ * wait4 cumulant ceux qu'elle a attendus.
+ *
+ * Code de sortie : celui de la commande, 124 si elle depasse le delai
+ * de -t (elle est alors tuee avec ses descendants), 127 si elle ne
+ * peut etre lancee, 125 si son attente echoue.
+ */
+
+#define _GNU_SOURCE
+#include <errno.h>
+#include <fcntl.h>
+#include <signal.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+#include <sys/resource.h>
+#include <sys/wait.h>
+
+static pid_t child = -1;
+static volatile sig_atomic_t timed_out = 0;
+
+static void on_alarm(int sig) {
+    (void)sig;
+    timed_out = 1;
+    if (child > 0) kill(-child, SIGKILL);
+}
+
+int main(int argc, char** argv) {
+    int first = 1;
+    unsigned limit = 0;
+    if (argc > 2 && strcmp(argv[1], "-t") == 0) {
+        limit = (unsigned)atoi(argv[2]);
+        first = 3;
+    }
+    if (first >= argc) {
+        fprintf(stderr, "Usage : %s [-t secondes] commande [arguments...]\n", argv[0]);
+        return 2;
+    }
+
+    struct timespec t0, t1;
+    clock_gettime(CLOCK_MONOTONIC, &t0);
+    child = fork();
+    if (child == 0) {
+        setpgid(0, 0);      /* groupe de processus : -t tue aussi cc1 */
+        int null = open("/dev/null", O_WRONLY);
+        if (null >= 0) dup2(null, STDOUT_FILENO);
+        execvp(argv[first], argv + first);
+        _exit(127);
+    }
+    if (child < 0) return 127;
+    setpgid(child, child);
+
+    if (limit > 0) {
+        struct sigaction sa;
+        memset(&sa, 0, sizeof(sa));
+        sa.sa_handler = on_alarm;
+        sigaction(SIGALRM, &sa, NULL);
+        alarm(limit);
+    }
+    int wstatus;
+    struct rusage usage;
+    while (wait4(child, &wstatus, 0, &usage) < 0) {
+        /* EINTR : l'alarme a tue la commande, on attend sa fin */
+        if (errno == EINTR) continue;
+        perror("measure : wait4");
+        kill(-child, SIGKILL);
+        return 125;
+    }
+    alarm(0);
+    clock_gettime(CLOCK_MONOTONIC, &t1);
+
+    double ms = (t1.tv_sec - t0.tv_sec) * 1e3 + (t1.tv_nsec - t0.tv_nsec) / 1e6;
+    printf("%.1f %ld\n", ms, usage.ru_maxrss);
+    if (timed_out) return 124;
+    return WIFEXITED(wstatus) ? WEXITSTATUS(wstatus) : 128 + WTERMSIG(wstatus);
+}
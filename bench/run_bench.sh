@@ -0,0 +1,151 @@
+#!/usr/bin/env bash
+# Mesure du compilateur sur des programmes generes (bench/gen_program) :
+# temps de chaque phase (lex, parse + quadruplets, opt, c, gcc) et pic de
+# memoire residente, ecrits dans un rapport JSON a comparer d'un commit a
+# l'autre (diff, une ligne par programme). Lance par "make bench".
+#
+# Les phases du compilateur sont mesurees par --stop-after : la phase k
+# vaut le temps jusqu'a k moins le temps jusqu'a k-1 (meilleur de
+# BENCH_RUNS essais). gcc compile le C produit comme le fait le pilote.
+# Une phase qui depasse BENCH_TIMEOUT secondes est notee dans "timeout"
+# et les suivantes ne sont pas mesurees.
+#
+# Variables : PARSER (./parser), BENCH_RUNS (3), BENCH_TIMEOUT (60),
+# BENCH_OUT (bench/results/<commit>.json), BENCH_ONLY (noms des
+# programmes a mesurer, separes par des espaces).
+set -euo pipefail
+
+cd "$(dirname "$0")/.."
+PARSER=${PARSER:-./parser}
+RUNS=${BENCH_RUNS:-3}
+TIMEOUT=${BENCH_TIMEOUT:-60}
+
+for tool in "$PARSER" bench/gen_program bench/measure; do
+  if [ ! -x "$tool" ]; then
+    echo "$tool not found or not executable. Run 'make bench' first." >&2
+    exit 2
+  fi
+done
+
+commit=$(git rev-parse --short HEAD 2>/dev/null || echo inconnu)
+if [ -n "$(git status --porcelain --untracked-files=no 2>/dev/null)" ]; then
+  commit="$commit-modifie"
+fi
+OUT=${BENCH_OUT:-bench/results/$commit.json}
+mkdir -p "$(dirname "$OUT")"
+WORK=$(mktemp -d /tmp/mathlang_bench_XXXXXX)
+trap 'rm -rf "$WORK"' EXIT
+
+# nom : options de gen_program (-f fonctions, -d profondeur, -w largeur,
+# -s chaines par fonction, -l lignes)
+PROGRAMS=(
+  "lignes_10k:-f 100 -l 10000"
+  "lignes_100k:-f 1000 -l 100000"
+  "lignes_1m:-f 10000 -l 1000000"
+  "fonctions_5000:-f 5000 -d 1 -l 25000"
+  "profondeur_16:-f 50 -d 16 -l 10000"
+  "largeur_64:-f 100 -w 64 -l 10000"
+  "chaines:-f 100 -s 40 -l 10000"
+)
+
+STAGES=(lex parse opt c)
+
+# measure_best <fichier_resultat> <commande...> : meilleur temps et pic
+# de memoire sur RUNS essais ; code 124 si un essai depasse le delai
+measure_best() {
+  local result=$1; shift
+  local best_ms="" best_kb=0 ms kb status
+  for _ in $(seq "$RUNS"); do
+    status=0
+    bench/measure -t "$TIMEOUT" "$@" > "$WORK/run" || status=$?
+    [ "$status" -eq 0 ] || return "$status"
+    read -r ms kb < "$WORK/run"
+    if [ -z "$best_ms" ] || awk -v a="$ms" -v b="$best_ms" 'BEGIN { exit !(a < b) }'; then
+      best_ms=$ms
+    fi
+    [ "$kb" -gt "$best_kb" ] && best_kb=$kb
+  done
+  echo "$best_ms $best_kb" > "$result"
+}
+
+json_value() { if [ -n "$1" ]; then echo "$1"; else echo null; fi; }
+
+{
+  echo "{"
+  echo "  \"commit\": \"$commit\","
+  echo "  \"date\": \"$(date -u +%Y-%m-%dT%H:%M:%SZ)\","
+  echo "  \"runs\": $RUNS,"
+  echo "  \"timeout_s\": $TIMEOUT,"
+  echo "  \"programs\": ["
+} > "$OUT"
+
+printf '%-16s %8s %8s %9s %9s %9s %9s %10s %10s  %s\n' \
+  programme lignes "lex" "parse" "opt" "c" "gcc" "rss ml" "rss gcc" "(ms, Ko)"
+
+first=1
+for entry in "${PROGRAMS[@]}"; do
+  name=${entry%%:*}
+  args=${entry#*:}
+  if [ -n "${BENCH_ONLY:-}" ] && [[ " $BENCH_ONLY " != *" $name "* ]]; then
+    continue
+  fi
+  src="$WORK/$name.ml"
+  # shellcheck disable=SC2086
+  bench/gen_program $args > "$src"
+  lines=$(wc -l < "$src")
+  bytes=$(stat -c %s "$src")
+
+  # Temps cumules jusqu'a chaque etape, puis gcc sur le C produit
+  declare -A total=() rss=()
+  timeout=""
+  for stage in "${STAGES[@]}" gcc; do
+    if [ "$stage" = gcc ]; then
+      command=(gcc "$WORK/$name.c" -lm -o "$WORK/$name")
+    else
+      command=("$PARSER" -q --stop-after="$stage" --emit=c:"$WORK/$name.c" "$src")
+    fi
+    status=0
+    measure_best "$WORK/result" "${command[@]}" || status=$?
+    if [ "$status" -eq 124 ]; then
+      timeout=$stage
+      break
+    elif [ "$status" -ne 0 ]; then
+      echo "$name : echec de l'etape $stage (code $status)" >&2
+      exit 1
+    fi
+    read -r total[$stage] rss[$stage] < "$WORK/result"
+  done
+
+  # Duree propre de chaque phase
+  declare -A phase=()
+  previous=0
+  for stage in "${STAGES[@]}"; do
+    [ -n "${total[$stage]:-}" ] || break
+    phase[$stage]=$(awk -v a="${total[$stage]}" -v b="$previous" 'BEGIN { d = a - b; printf "%.1f", (d > 0 ? d : 0) }')
+    previous=${total[$stage]}
+  done
+  phase[gcc]=${total[gcc]:-}
+  sum=""
+  if [ -z "$timeout" ]; then
+    sum=$(awk -v a="${total[c]}" -v b="${total[gcc]}" 'BEGIN { printf "%.1f", a + b }')
+  fi
+
+  printf '%-16s %8d %8s %9s %9s %9s %9s %10s %10s  %s\n' "$name" "$lines" \
+    "${phase[lex]:--}" "${phase[parse]:--}" "${phase[opt]:--}" "${phase[c]:--}" "${phase[gcc]:--}" \
+    "${rss[c]:--}" "${rss[gcc]:--}" "${timeout:+delai depasse : $timeout}"
+
+  [ "$first" -eq 1 ] || echo "," >> "$OUT"
+  first=0
+  printf '    {"name": "%s", "args": "%s", "lines": %d, "bytes": %d, "ms": {"lex": %s, "parse": %s, "opt": %s, "c": %s, "gcc": %s, "total": %s}, "rss_kb": {"lex": %s, "parse": %s, "opt": %s, "c": %s, "gcc": %s}, "timeout": %s}' \
+    "$name" "$args" "$lines" "$bytes" \
+    "$(json_value "${phase[lex]:-}")" "$(json_value "${phase[parse]:-}")" "$(json_value "${phase[opt]:-}")" \
+    "$(json_value "${phase[c]:-}")" "$(json_value "${phase[gcc]:-}")" "$(json_value "$sum")" \
+    "$(json_value "${rss[lex]:-}")" "$(json_value "${rss[parse]:-}")" "$(json_value "${rss[opt]:-}")" \
+    "$(json_value "${rss[c]:-}")" "$(json_value "${rss[gcc]:-}")" \
+    "$(if [ -n "$timeout" ]; then echo "\"$timeout\""; else echo null; fi)" >> "$OUT"
+  unset total rss phase
+  rm -f "$WORK/$name" "$WORK/$name.c" "$src"
+done
+
+printf '\n  ]\n}\n' >> "$OUT"
+echo "Rapport : $OUT"
@@ -0,0 +1,160 @@
+#!/usr/bin/env bash
+# Temps d'execution du code genere sur les noyaux de bench/kernels :
+# chaque noyau est compile pour chaque reglage (optimisation de MathLang
+# puis de gcc), sa sortie comparee a la sortie attendue, et son temps
+# (mediane de KERNEL_RUNS essais) compare a une reference enregistree.
+# Lance par "make bench-kernels".
+#
+# Sortie attendue : <noyau>.out, ou sa somme de controle (cksum) dans
+# <noyau>.cksum quand elle est volumineuse. Un noyau qui lit l'entree
+# standard recoit celle de kernel_input.
+#
+# Le temps retenu est la mediane de KERNEL_RUNS essais ; le bruit est
+# l'ecart entre le plus lent et le plus rapide, en % de la mediane.
+# Echec (code 1) si une sortie differe ou si un temps depasse celui de
+# la reference de plus de KERNEL_THRESHOLD %, ou du bruit mesure s'il est
+# plus grand. Le bruit d'une execution a l'autre atteint 20 a 30 % sur
+# une machine partagee, d'ou le seuil par defaut de 35 %. Une mesure sans
+# echec devient la reference s'il n'y en a pas ; --update-baseline la
+# remplace. Les temps dependent de la machine : la reference n'est pas
+# versionnee.
+#
+# Variables : PARSER (./parser), KERNEL_RUNS (5), KERNEL_THRESHOLD (35),
+# KERNEL_SETTINGS (reglages "MathLang:gcc", "O0:O0 O1:O0 O0:O2 O1:O2"),
+# KERNEL_BASELINE (bench/results/kernels_baseline.txt), KERNEL_TIMEOUT
+# (60), KERNEL_ONLY (noms des noyaux a mesurer, separes par des espaces).
+set -euo pipefail
+
+cd "$(dirname "$0")/.."
+PARSER=${PARSER:-./parser}
+RUNS=${KERNEL_RUNS:-5}
+THRESHOLD=${KERNEL_THRESHOLD:-35}
+SETTINGS=${KERNEL_SETTINGS:-O0:O0 O1:O0 O0:O2 O1:O2}
+BASELINE=${KERNEL_BASELINE:-bench/results/kernels_baseline.txt}
+TIMEOUT=${KERNEL_TIMEOUT:-60}
+
+update=0
+if [ "${1:-}" = "--update-baseline" ]; then
+  update=1
+elif [ $# -gt 0 ]; then
+  echo "Usage : $0 [--update-baseline]" >&2
+  exit 2
+fi
+
+for tool in "$PARSER" bench/measure; do
+  if [ ! -x "$tool" ]; then
+    echo "$tool not found or not executable. Run 'make' first." >&2
+    exit 2
+  fi
+done
+
+commit=$(git rev-parse --short HEAD 2>/dev/null || echo inconnu)
+if [ -n "$(git status --porcelain --untracked-files=no 2>/dev/null)" ]; then
+  commit="$commit-modifie"
+fi
+OUT=bench/results/kernels_$commit.txt
+mkdir -p bench/results "$(dirname "$BASELINE")"
+WORK=$(mktemp -d /tmp/mathlang_kernels_XXXXXX)
+trap 'rm -rf "$WORK"' EXIT
+
+# kernel_input <noyau> : entree standard du noyau (vide par defaut)
+kernel_input() {
+  case $1 in
+    entrees_sorties)
+      echo 200000
+      awk 'BEGIN { for (i = 1; i <= 200000; i++) print (i * 7919) % 100003 }'
+      ;;
+  esac
+}
+
+# Reference : "noyau reglage ms" par ligne
+declare -A reference=()
+if [ "$update" -eq 0 ] && [ -f "$BASELINE" ]; then
+  while read -r name setting ms; do
+    reference["$name $setting"]=$ms
+  done < "$BASELINE"
+fi
+
+printf '%-20s' noyau
+for setting in $SETTINGS; do printf ' %18s' "$setting"; done
+printf '   (ms, ecart a la reference)\n'
+
+: > "$OUT"
+fail=0
+for src in bench/kernels/*.ml; do
+  name=$(basename "$src" .ml)
+  if [ -n "${KERNEL_ONLY:-}" ] && [[ " $KERNEL_ONLY " != *" $name "* ]]; then
+    continue
+  fi
+  kernel_input "$name" > "$WORK/input"
+  printf '%-20s' "$name"
+
+  for setting in $SETTINGS; do
+    ml_opt=-${setting%%:*}
+    gcc_opt=-${setting#*:}
+    cell="-"
+    if ! "$PARSER" -q "$ml_opt" --emit=c:"$WORK/$name.c" "$src" > /dev/null ||
+       ! gcc "$gcc_opt" "$WORK/$name.c" -lm -o "$WORK/$name" 2> "$WORK/gcc.log"; then
+      cell="compilation"
+      fail=1
+    elif ! timeout "$TIMEOUT" "$WORK/$name" < "$WORK/input" > "$WORK/output"; then
+      cell="execution"
+      fail=1
+    elif { [ -f "${src%.ml}.out" ] && ! cmp -s "$WORK/output" "${src%.ml}.out"; } ||
+         { [ -f "${src%.ml}.cksum" ] && [ "$(cksum < "$WORK/output")" != "$(cat "${src%.ml}.cksum")" ]; }; then
+      cell="sortie differente"
+      fail=1
+    else
+      : > "$WORK/times"
+      for _ in $(seq "$RUNS"); do
+        status=0
+        bench/measure -t "$TIMEOUT" "$WORK/$name" < "$WORK/input" > "$WORK/run" || status=$?
+        if [ "$status" -ne 0 ]; then
+          : > "$WORK/times"
+          break
+        fi
+        read -r ms _ < "$WORK/run"
+        echo "$ms" >> "$WORK/times"
+      done
+      # "mediane bruit%" des essais
+      read -r median noise < <(sort -g "$WORK/times" | awk '
+        { t[NR] = $1 }
+        END {
+          if (NR == 0) exit
+          m = (NR % 2) ? t[(NR + 1) / 2] : (t[NR / 2] + t[NR / 2 + 1]) / 2
+          printf "%.2f %.1f\n", m, (m > 0 ? 100 * (t[NR] - t[1]) / m : 0)
+        }') || true
+      if [ -z "${median:-}" ]; then
+        cell="execution"
+        fail=1
+      else
+        echo "$name $setting $median" >> "$OUT"
+        ref=${reference["$name $setting"]:-}
+        if [ -z "$ref" ]; then
+          cell="$median"
+        else
+          delta=$(awk -v a="$median" -v b="$ref" 'BEGIN { printf "%+.1f", (b > 0 ? 100 * (a - b) / b : 0) }')
+          cell="$median ($delta%)"
+          if awk -v d="$delta" -v t="$THRESHOLD" -v n="$noise" 'BEGIN { exit !(d > (n > t ? n : t)) }'; then
+            cell="$cell !"
+            fail=1
+          fi
+        fi
+      fi
+    fi
+    printf ' %18s' "$cell"
+  done
+  printf '\n'
+done
+
+echo "Mesures : $OUT"
+if [ "$fail" -eq 0 ] && { [ "$update" -eq 1 ] || [ ${#reference[@]} -eq 0 ]; }; then
+  cp "$OUT" "$BASELINE"
+  echo "Reference enregistree : $BASELINE"
+elif [ "$update" -eq 1 ] || [ ${#reference[@]} -eq 0 ]; then
+  echo "Reference non enregistree : la mesure a echoue" >&2
+fi
+if [ "$fail" -ne 0 ]; then
+  echo "Echec : sortie incorrecte, ou regression de plus de $THRESHOLD % (!)" >&2
+fi
+exit "$fail"
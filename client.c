@@ -0,0 +1,249 @@
+/* ========================================================= */
+/*  CLIENT DU SERVEUR DE COMPILATION (mlclient)               */
+/* ========================================================= */
+/*
+ * mlclient [-s socket] [-i entree] [options] fichier.ml
+ *   envoie une requete a "parser --server" et affiche la reponse :
+ *   diagnostics sur stderr, vidages, C et sortie du programme (--run)
+ *   sur stdout. Les options sont celles du serveur (-O0, -fno-inline,
+ *   --emit=..., --stop-after=..., --run).
+ *
+ * mlclient [-s socket] --load [-n N] [-c C] [options] fichier.ml
+ *   test de charge : C clients en parallele envoient N requetes au
+ *   total, puis affiche les latences p50/p99/max et le debit.
+ */
+
+#define _GNU_SOURCE
+#include "server.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+#include <pthread.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+
+static const char* socket_path = "/tmp/mathlang.sock";
+static char* options = NULL;       /* options du compilateur, separees par des espaces */
+static char* source = NULL;
+static size_t source_size = 0;
+
+static char* read_file(const char* path, size_t* size) {
+    FILE* f = fopen(path, "rb");
+    if (!f) return NULL;
+    char* text = NULL;
+    size_t cap = 0, len = 0, n;
+    do {
+        if (len + 4096 > cap) {
+            cap = cap ? cap * 2 : 65536;
+            text = (char*)realloc(text, cap);
+        }
+        n = fread(text + len, 1, cap - len, f);
+        len += n;
+    } while (n > 0);
+    fclose(f);
+    *size = len;
+    return text;
+}
+
+static int connect_server(void) {
+    struct sockaddr_un addr;
+    memset(&addr, 0, sizeof(addr));
+    addr.sun_family = AF_UNIX;
+    snprintf(addr.sun_path, sizeof(addr.sun_path), "%s", socket_path);
+    int fd = socket(AF_UNIX, SOCK_STREAM, 0);
+    if (fd >= 0 && connect(fd, (struct sockaddr*)&addr, sizeof(addr)) != 0) {
+        close(fd);
+        fd = -1;
+    }
+    return fd;
+}
+
+/* Envoie une requete ; 0 si toutes les trames sont parties */
+static int send_request(int fd, const char* input, size_t input_size) {
+    if (ml_frame_write(fd, ML_FRAME_OPTIONS, options, strlen(options)) != 0) return -1;
+    if (ml_frame_write(fd, ML_FRAME_SOURCE, source, source_size) != 0) return -1;
+    if (input && ml_frame_write(fd, ML_FRAME_INPUT, input, input_size) != 0) return -1;
+    return ml_frame_write(fd, ML_FRAME_GO, "", 0);
+}
+
+/* Statut de compilation lu dans la trame finale ("status=N ...") */
+static int frame_status(const char* summary) {
+    return strncmp(summary, "status=", 7) == 0 ? atoi(summary + 7) : 1;
+}
+
+/* ========================================================= */
+/*  REQUETE UNIQUE                                            */
+/* ========================================================= */
+
+static int single_request(const char* input_path) {
+    char* input = NULL;
+    size_t input_size = 0;
+    if (input_path && !(input = read_file(input_path, &input_size))) {
+        fprintf(stderr, "mlclient : impossible de lire %s\n", input_path);
+        return 1;
+    }
+    int fd = connect_server();
+    if (fd < 0) {
+        fprintf(stderr, "mlclient : pas de serveur sur %s\n", socket_path);
+        free(input);
+        return 1;
+    }
+    int status = 1;
+    if (send_request(fd, input, input_size) == 0) {
+        char type;
+        char* data;
+        size_t size;
+        while (ml_frame_read(fd, &type, &data, &size) == 1) {
+            int done = type == ML_FRAME_STATUS;
+            if (type == ML_FRAME_DIAGNOSTICS) {
+                fwrite(data, 1, size, stderr);
+            } else if (type == ML_FRAME_BINARY) {
+                printf("Executable : %s\n", data);
+            } else if (done) {
+                status = frame_status(data);
+                fprintf(stderr, "[%s]\n", data);
+            } else {
+                fwrite(data, 1, size, stdout);
+            }
+            free(data);
+            if (done) break;
+        }
+    }
+    close(fd);
+    free(input);
+    return status;
+}
+
+/* ========================================================= */
+/*  TEST DE CHARGE                                            */
+/* ========================================================= */
+
+typedef struct {
+    int requests;
+    double* latencies;      /* secondes, une par requete */
+    int failures;
+} LoadWorker;
+
+static double now(void) {
+    struct timespec t;
+    clock_gettime(CLOCK_MONOTONIC, &t);
+    return t.tv_sec + t.tv_nsec / 1e9;
+}
+
+/* Une connexion par client, requetes enchainees dessus */
+static void* load_main(void* arg) {
+    LoadWorker* w = (LoadWorker*)arg;
+    int fd = connect_server();
+    for (int r = 0; r < w->requests; r++) {
+        double t0 = now();
+        int ok = fd >= 0 && send_request(fd, NULL, 0) == 0;
+        while (ok) {
+            char type;
+            char* data;
+            size_t size;
+            if (ml_frame_read(fd, &type, &data, &size) != 1) {
+                ok = 0;
+                break;
+            }
+            int done = type == ML_FRAME_STATUS;
+            if (done && frame_status(data) != 0) ok = 0;
+            free(data);
+            if (done) break;
+        }
+        w->latencies[r] = now() - t0;
+        if (!ok) w->failures++;
+    }
+    if (fd >= 0) close(fd);
+    return NULL;
+}
+
+static int compare_doubles(const void* a, const void* b) {
+    double x = *(const double*)a, y = *(const double*)b;
+    return (x > y) - (x < y);
+}
+
+static int load_test(int total, int clients) {
+    if (clients > total) clients = total;
+    pthread_t* threads = (pthread_t*)malloc(sizeof(pthread_t) * (size_t)clients);
+    LoadWorker* workers = (LoadWorker*)calloc((size_t)clients, sizeof(LoadWorker));
+    double* latencies = (double*)malloc(sizeof(double) * (size_t)total);
+
+    double t0 = now();
+    int offset = 0;
+    for (int c = 0; c < clients; c++) {
+        workers[c].requests = total / clients + (c < total % clients);
+        workers[c].latencies = latencies + offset;
+        offset += workers[c].requests;
+        pthread_create(&threads[c], NULL, load_main, &workers[c]);
+    }
+    int failures = 0;
+    for (int c = 0; c < clients; c++) {
+        pthread_join(threads[c], NULL);
+        failures += workers[c].failures;
+    }
+    double elapsed = now() - t0;
+
+    qsort(latencies, (size_t)total, sizeof(double), compare_doubles);
+    printf("%d requete(s), %d client(s), %d echec(s), %.3f s, %.1f requetes/s\n",
+           total, clients, failures, elapsed, total / elapsed);
+    printf("latence : p50 %.2f ms, p99 %.2f ms, max %.2f ms\n",
+           latencies[(total - 1) / 2] * 1e3,
+           latencies[(int)((total - 1) * 0.99)] * 1e3,
+           latencies[total - 1] * 1e3);
+
+    free(threads);
+    free(workers);
+    free(latencies);
+    return failures > 0 ? 1 : 0;
+}
+
+/* ========================================================= */
+/*  MAIN                                                      */
+/* ========================================================= */
+
+int main(int argc, char** argv) {
+    const char* input_path = NULL;
+    const char* path = NULL;
+    int load = 0, total = 200, clients = 4;
+    size_t cap = 1;
+    for (int i = 1; i < argc; i++) cap += strlen(argv[i]) + 1;
+    options = (char*)calloc(cap, 1);
+
+    for (int i = 1; i < argc; i++) {
+        if (strcmp(argv[i], "-s") == 0 && i + 1 < argc) {
+            socket_path = argv[++i];
+        } else if (strcmp(argv[i], "-i") == 0 && i + 1 < argc) {
+            input_path = argv[++i];
+        } else if (strcmp(argv[i], "--load") == 0) {
+            load = 1;
+        } else if (strcmp(argv[i], "-n") == 0 && i + 1 < argc) {
+            total = atoi(argv[++i]);
+        } else if (strcmp(argv[i], "-c") == 0 && i + 1 < argc) {
+            clients = atoi(argv[++i]);
+        } else if (argv[i][0] == '-') {
+            if (options[0]) strcat(options, " ");
+            strcat(options, argv[i]);
+        } else {
+            path = argv[i];
+        }
+    }
+    if (!path || total < 1 || clients < 1) {
+        fprintf(stderr, "Usage : %s [-s socket] [-i entree] [options] <fichier>\n"
+                        "        %s [-s socket] --load [-n N] [-c C] [options] <fichier>\n",
+                argv[0], argv[0]);
+        free(options);
+        return 1;
+    }
+    if (!(source = read_file(path, &source_size))) {
+        fprintf(stderr, "mlclient : impossible de lire %s\n", path);
+        free(options);
+        return 1;
+    }
+
+    int status = load ? load_test(total, clients) : single_request(input_path);
+    free(source);
+    free(options);
+    return status;
+}
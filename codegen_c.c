@@ -1,5 +1,6 @@
 #include "codegen_c.h"
 #include <stdlib.h>
+#include <stdint.h>
 #include <string.h>
 #include <ctype.h>
 
@@ -11,27 +12,47 @@
  * doit le déduire nous-mêmes. On fait une première passe sur
  * la liste de quadruplets (dans l'ordre où ils ont été générés)
  * et on retient, pour chaque temporaire "Tn", quel type il a.
+ * Un nom est propre a la fonction qui le definit (NULL : main) :
+ * deux fonctions qui utilisent la meme variable de boucle la
+ * declarent chacune.
  */
 
 typedef struct
 {
     char *name;
+    const FunctionInfo *fn; /* fonction proprietaire, NULL : main */
     DataType type;
     int owner_quad; /* indice du quadruplet ou ce nom a ete defini en premier */
 } TempEntry;
 
+/* Les entrees restent dans l'ordre d'insertion (ordre des declarations
+   emises) ; "slots" les retrouve par hachage du couple (nom, fonction)
+   (sondage lineaire, -1 = case vide, jamais plus d'a moitie pleine) */
 typedef struct
 {
     TempEntry *entries;
     int count;
     int capacity;
+    int *slots;
+    int slot_count; /* puissance de 2 */
 } TempMap;
 
+static unsigned temp_hash(const char *name, const FunctionInfo *fn)
+{
+    unsigned h = 2166136261u;
+    for (; *name; name++)
+        h = (h ^ (unsigned char)*name) * 16777619u;
+    return h ^ (unsigned)((uintptr_t)fn >> 4) * 2654435761u;
+}
+
 static void temp_map_init(TempMap *map)
 {
     map->capacity = 64;
     map->count = 0;
     map->entries = (TempEntry *)malloc(sizeof(TempEntry) * map->capacity);
+    map->slot_count = 2 * map->capacity;
+    map->slots = (int *)malloc(sizeof(int) * map->slot_count);
+    memset(map->slots, -1, sizeof(int) * map->slot_count);
 }
 
 static void temp_map_free(TempMap *map)
@@ -41,38 +62,52 @@ static void temp_map_free(TempMap *map)
         free(map->entries[i].name);
     }
     free(map->entries);
+    free(map->slots);
 }
 
-static DataType temp_map_get(TempMap *map, const char *name)
+/* Case du nom : celle qui le contient, ou la case vide ou l'inserer */
+static int temp_map_slot(const TempMap *map, const char *name, const FunctionInfo *fn)
 {
-    for (int i = 0; i < map->count; i++)
-    {
-        if (strcmp(map->entries[i].name, name) == 0)
-        {
-            return map->entries[i].type;
-        }
-    }
-    return TYPE_UNKNOWN;
+    unsigned mask = (unsigned)map->slot_count - 1;
+    unsigned k = temp_hash(name, fn) & mask;
+    while (map->slots[k] >= 0 && (map->entries[map->slots[k]].fn != fn ||
+                                  strcmp(map->entries[map->slots[k]].name, name) != 0))
+        k = (k + 1) & mask;
+    return (int)k;
 }
 
-static void temp_map_set(TempMap *map, const char *name, DataType type, int quad_index)
+static DataType temp_map_get(TempMap *map, const char *name, const FunctionInfo *fn)
 {
-    for (int i = 0; i < map->count; i++)
+    int e = map->slots[temp_map_slot(map, name, fn)];
+    return e >= 0 ? map->entries[e].type : TYPE_UNKNOWN;
+}
+
+static void temp_map_set(TempMap *map, const char *name, const FunctionInfo *fn,
+                         DataType type, int quad_index)
+{
+    int k = temp_map_slot(map, name, fn);
+    if (map->slots[k] >= 0)
     {
-        if (strcmp(map->entries[i].name, name) == 0)
-        {
-            map->entries[i].type = type;
-            return; /* on conserve owner_quad de la premiere apparition */
-        }
+        map->entries[map->slots[k]].type = type;
+        return; /* on conserve owner_quad de la premiere apparition */
     }
     if (map->count >= map->capacity)
     {
         map->capacity *= 2;
         map->entries = (TempEntry *)realloc(map->entries, sizeof(TempEntry) * map->capacity);
+        free(map->slots);
+        map->slot_count = 2 * map->capacity;
+        map->slots = (int *)malloc(sizeof(int) * map->slot_count);
+        memset(map->slots, -1, sizeof(int) * map->slot_count);
+        for (int i = 0; i < map->count; i++)
+            map->slots[temp_map_slot(map, map->entries[i].name, map->entries[i].fn)] = i;
+        k = temp_map_slot(map, name, fn);
     }
     map->entries[map->count].name = stringDuplicate(name);
+    map->entries[map->count].fn = fn;
     map->entries[map->count].type = type;
     map->entries[map->count].owner_quad = quad_index;
+    map->slots[k] = map->count;
     map->count++;
 }
 
@@ -203,55 +238,7 @@ static DataType resolve_type(const char *addr, SymbolTable *table, TempMap *tmap
             return e->type;
     }
 
-    return temp_map_get(tmap, addr);
-}
-
-/* Opérations dont le champ "result" désigne une variable qui reçoit
-   une valeur (par opposition à une cible de branchement, comme dans
-   BR/BZ/BG..., ou un résultat non pertinent comme WRITE/WRITELN). */
-static int is_assigning_op(QuadOp op)
-{
-    switch (op)
-    {
-    case QUAD_ADD:
-    case QUAD_SUB:
-    case QUAD_MUL:
-    case QUAD_DIV:
-    case QUAD_DIV_INT:
-    case QUAD_MOD:
-    case QUAD_POW:
-    case QUAD_NEG:
-    case QUAD_AND:
-    case QUAD_OR:
-    case QUAD_NOT:
-    case QUAD_XOR:
-    case QUAD_EQ:
-    case QUAD_NEQ:
-    case QUAD_LT:
-    case QUAD_GT:
-    case QUAD_LEQ:
-    case QUAD_GEQ:
-    case QUAD_ASSIGN:
-    case QUAD_SIN:
-    case QUAD_COS:
-    case QUAD_EXP:
-    case QUAD_LOG:
-    case QUAD_SQRT:
-    case QUAD_ABS:
-    case QUAD_FLOOR:
-    case QUAD_CEIL:
-    case QUAD_ROUND:
-    case QUAD_RE:
-    case QUAD_IM:
-    case QUAD_ARG:
-    case QUAD_MAJUSCULES:
-    case QUAD_MINUSCULES:
-    case QUAD_READ:
-    case QUAD_CALL:
-        return 1;
-    default:
-        return 0;
-    }
+    return temp_map_get(tmap, addr, current_fn);
 }
 
 /* ========================================================= */
@@ -275,7 +262,7 @@ static void infer_types_pass(const QuadList *list, SymbolTable *table, TempMap *
     for (int i = 0; i < list->count; i++)
     {
         const Quadruplet *q = &list->quads[i];
-        if (!q->result || !is_assigning_op(q->op))
+        if (!q->result || !isAssigningOp(q->op))
             continue;
 
         FunctionInfo *current_fn = (owner[i] >= 0) ? &functions[owner[i]] : NULL;
@@ -385,7 +372,7 @@ static void infer_types_pass(const QuadList *list, SymbolTable *table, TempMap *
             /* On ne peut rien déduire d'un READ isolé : on garde
                ce qu'on connaît déjà de cette variable si on l'a
                déjà vue, sinon on retombe sur R par défaut. */
-            result_type = temp_map_get(tmap, q->result);
+            result_type = temp_map_get(tmap, q->result, current_fn);
             if (result_type == TYPE_UNKNOWN)
                 result_type = TYPE_R;
             break;
@@ -402,7 +389,7 @@ static void infer_types_pass(const QuadList *list, SymbolTable *table, TempMap *
             break;
         }
 
-        temp_map_set(tmap, q->result, result_type, i);
+        temp_map_set(tmap, q->result, current_fn, result_type, i);
     }
 }
 
@@ -422,6 +409,18 @@ static char *format_operand(const char *addr)
     return stringDuplicate(addr);
 }
 
+/* Nom C d'une fonction. Les clones specialises par l'optimiseur
+   s'appellent "f#1" dans les quadruplets (impossible a ecrire en
+   MathLang, '#' ouvre un commentaire) et deviennent f__spec1. */
+static const char *c_function_name(const char *name, char *buf, size_t size)
+{
+    const char *hash = strchr(name, '#');
+    if (!hash)
+        return name;
+    snprintf(buf, size, "%.*s__spec%s", (int)(hash - name), name, hash + 1);
+    return buf;
+}
+
 /* ========================================================= */
 /*  TYPES C CORRESPONDANTS                                    */
 /* ========================================================= */
@@ -478,16 +477,86 @@ static void emit_write(FILE *out, const char *addr, DataType type)
     }
 }
 
+/* ========================================================= */
+/*  DIRECTIVES #line                                          */
+/* ========================================================= */
+/*
+ * Chaque quadruplet traduit est precede d'un #line vers sa ligne du
+ * source : gcc, gdb, perf annotate et gcov designent alors les lignes
+ * MathLang et non celles du C. Un quadruplet ajoute par l'optimiseur
+ * (ligne 0) reprend la ligne du precedent ; #line n'a pas de colonne.
+ */
+
+static _Thread_local const char *source_name = NULL;
+static _Thread_local int source_line = 0;   /* derniere ligne connue */
+
+void set_source_name(const char *path)
+{
+    source_name = path;
+}
+
+static void emit_line_directive(FILE *out, int line)
+{
+    fprintf(out, "#line %d \"", line);
+    for (const char *c = source_name; *c; c++)
+    {
+        if (*c == '"' || *c == '\\')
+            fputc('\\', out);
+        fputc(*c, out);
+    }
+    fprintf(out, "\"\n");
+}
+
+/* Etiquette (used) et #line avant la traduction du quadruplet index ;
+   l'etiquette est a la ligne du quadruplet qu'elle precede, et un
+   quadruplet sans C (PARAM, NOP) n'a pas de directive */
+static void emit_quad_prefix(FILE *out, const Quadruplet *q, int index, int used)
+{
+    if (q->line > 0)
+        source_line = q->line;
+    int directive = source_name && source_line > 0;
+    if (used)
+    {
+        if (directive)
+            emit_line_directive(out, source_line);
+        fprintf(out, "L%d:;\n", index);
+    }
+    if (directive && q->op != QUAD_PARAM && q->op != QUAD_LABEL && q->op != QUAD_NOP)
+        emit_line_directive(out, source_line);
+}
+
 /* ========================================================= */
 /*  TRADUCTION D'UN QUADRUPLET EN C                            */
 /* ========================================================= */
 
+/* --profile : compteur de boucle du quadruplet (saut arriere, -1 :
+   aucun), fonction chronometree a arreter a chaque RETURN (-1 : aucune)
+   et corps appele par les appels recursifs directs (NULL : la fonction) */
+typedef struct
+{
+    int loop_site;
+    int function;
+    const char *self_call;
+} ProfilePoint;
+
 static void translate_quad(FILE *out, const Quadruplet *q, SymbolTable *table,
-                           TempMap *tmap, ParamBuffer *pb, FunctionInfo *current_fn)
+                           TempMap *tmap, ParamBuffer *pb, FunctionInfo *current_fn,
+                           const ProfilePoint *prof)
 {
     char *a1 = format_operand(q->arg1);
     char *a2 = format_operand(q->arg2);
 
+    /* Saut ; le retour d'une boucle profilee compte une iteration */
+    char jump[96] = "";
+    if (isBranchOp(q->op))
+    {
+        if (prof && prof->loop_site >= 0)
+            snprintf(jump, sizeof(jump), "{ ml_prof_loops[%d].count++; goto L%d; }",
+                     prof->loop_site, q->target);
+        else
+            snprintf(jump, sizeof(jump), "goto L%d;", q->target);
+    }
+
     switch (q->op)
     {
 
@@ -588,31 +657,31 @@ static void translate_quad(FILE *out, const Quadruplet *q, SymbolTable *table,
 
     /* --- Branchements inconditionnels et conditionnels --- */
     case QUAD_BR:
-        fprintf(out, "    goto L%s;\n", q->result);
+        fprintf(out, "    %s\n", jump);
         break;
     case QUAD_BZ:
-        fprintf(out, "    if (!(%s)) goto L%s;\n", a1, q->result);
+        fprintf(out, "    if (!(%s)) %s\n", a1, jump);
         break;
     case QUAD_BNZ:
-        fprintf(out, "    if (%s) goto L%s;\n", a1, q->result);
+        fprintf(out, "    if (%s) %s\n", a1, jump);
         break;
     case QUAD_BG:
-        fprintf(out, "    if ((%s) > (%s)) goto L%s;\n", a1, a2, q->result);
+        fprintf(out, "    if ((%s) > (%s)) %s\n", a1, a2, jump);
         break;
     case QUAD_BGE:
-        fprintf(out, "    if ((%s) >= (%s)) goto L%s;\n", a1, a2, q->result);
+        fprintf(out, "    if ((%s) >= (%s)) %s\n", a1, a2, jump);
         break;
     case QUAD_BL:
-        fprintf(out, "    if ((%s) < (%s)) goto L%s;\n", a1, a2, q->result);
+        fprintf(out, "    if ((%s) < (%s)) %s\n", a1, a2, jump);
         break;
     case QUAD_BLE:
-        fprintf(out, "    if ((%s) <= (%s)) goto L%s;\n", a1, a2, q->result);
+        fprintf(out, "    if ((%s) <= (%s)) %s\n", a1, a2, jump);
         break;
     case QUAD_BE:
-        fprintf(out, "    if ((%s) == (%s)) goto L%s;\n", a1, a2, q->result);
+        fprintf(out, "    if ((%s) == (%s)) %s\n", a1, a2, jump);
         break;
     case QUAD_BNE:
-        fprintf(out, "    if ((%s) != (%s)) goto L%s;\n", a1, a2, q->result);
+        fprintf(out, "    if ((%s) != (%s)) %s\n", a1, a2, jump);
         break;
 
     /* --- Fonctions mathématiques --- */
@@ -713,7 +782,13 @@ static void translate_quad(FILE *out, const Quadruplet *q, SymbolTable *table,
         break;
 
     case QUAD_RETURN:
-        fprintf(out, "    return %s;\n", a1 ? a1 : "0");
+        if (prof && prof->function >= 0 && current_fn && current_fn->is_function)
+            fprintf(out, "    { %s ml_prof_v = %s; ML_PROF_EXIT(%d); return ml_prof_v; }\n",
+                    get_c_type(current_fn->return_type), a1 ? a1 : "0", prof->function);
+        else if (prof && prof->function >= 0)
+            fprintf(out, "    { ML_PROF_EXIT(%d); return; }\n", prof->function);
+        else
+            fprintf(out, "    return %s;\n", a1 ? a1 : "0");
         break;
 
     case QUAD_LABEL:
@@ -726,10 +801,14 @@ static void translate_quad(FILE *out, const Quadruplet *q, SymbolTable *table,
 
     case QUAD_CALL:
     {
+        char buf[160];
+        const char *callee = c_function_name(q->arg1 ? q->arg1 : "", buf, sizeof(buf));
+        if (prof && prof->self_call && current_fn && q->arg1 && strcmp(q->arg1, current_fn->name) == 0)
+            callee = prof->self_call;
         fprintf(out, "    ");
         if (q->result)
             fprintf(out, "%s = ", q->result);
-        fprintf(out, "%s(", q->arg1 ? q->arg1 : "");
+        fprintf(out, "%s(", callee);
         for (int k = 0; k < pb->count; k++)
         {
             fprintf(out, "%s%s", (k > 0) ? ", " : "", pb->items[k]);
@@ -772,9 +851,11 @@ static int *build_quad_owner_array(const QuadList *list, FunctionInfo *functions
     return owner;
 }
 
-static void emit_signature(FILE *out, FunctionInfo *fi)
+static void emit_signature_named(FILE *out, FunctionInfo *fi, const char *name)
 {
-    fprintf(out, "%s %s(", fi->is_function ? get_c_type(fi->return_type) : "void", fi->name);
+    char c_name[160];
+    fprintf(out, "%s %s(", fi->is_function ? get_c_type(fi->return_type) : "void",
+            c_function_name(name, c_name, sizeof(c_name)));
     if (fi->param_count == 0)
     {
         fprintf(out, "void");
@@ -790,149 +871,844 @@ static void emit_signature(FILE *out, FunctionInfo *fi)
     fprintf(out, ")");
 }
 
-void generate_c_code(FILE *out, QuadList *list, SymbolTable *table,
-                     FunctionInfo *functions, int function_count)
+static void emit_signature(FILE *out, FunctionInfo *fi)
 {
-    if (!out || !list)
-        return;
+    emit_signature_named(out, fi, fi->name);
+}
+
+/* ========================================================= */
+/*  MEMOISER : CACHE DES RESULTATS                            */
+/* ========================================================= */
+/*
+ * Le corps de f devient "static ... f_calcul(...)" et f est remplacee
+ * par une enveloppe qui consulte un cache a correspondance directe :
+ * chaque parametre est converti en un mot de 64 bits (les bits du
+ * double pour R), les mots sont haches, et l'entree correspondante est
+ * reutilisee si elle porte exactement la meme cle, ecrasee sinon. La
+ * memoire reste donc bornee par memo_capacity entrees. Les appels
+ * recursifs passent par l'enveloppe : fibonacci devient lineaire.
+ */
+
+static _Thread_local int memo_capacity = MEMO_DEFAULT_CAPACITY;
+
+void set_memo_capacity(int capacity)
+{
+    if (capacity > 0)
+        memo_capacity = capacity;
+}
+
+static void memo_impl_name(FunctionInfo *fi, char *buf, size_t size)
+{
+    snprintf(buf, size, "%s_calcul", fi->name);
+}
 
+static void emit_memo_wrapper(FILE *out, FunctionInfo *fi)
+{
+    char impl[160];
+    memo_impl_name(fi, impl, sizeof(impl));
+    int nkeys = fi->param_count > 0 ? fi->param_count : 1;
+    const char *ret_type = get_c_type(fi->return_type);
+
+    fprintf(out, "/* MEMOISER : cache de %d entrees pour %s */\n", memo_capacity, fi->name);
+    fprintf(out, "static struct { int used; unsigned long k[%d]; %s value; } %s_memo[%d];\n\n",
+            nkeys, ret_type, fi->name, memo_capacity);
+
+    emit_signature(out, fi);
+    fprintf(out, " {\n");
+    fprintf(out, "    unsigned long k[%d] = {0};\n", nkeys);
+    for (int p = 0; p < fi->param_count; p++)
+    {
+        const char *name = fi->params[p].name;
+        if (fi->params[p].type == TYPE_R)
+            fprintf(out, "    memcpy(&k[%d], &%s, sizeof(double));\n", p, name);
+        else if (fi->params[p].type == TYPE_CHAR)
+            fprintf(out, "    k[%d] = (unsigned char)%s;\n", p, name);
+        else
+            fprintf(out, "    k[%d] = (unsigned long)%s;\n", p, name);
+    }
+    fprintf(out, "    unsigned long h = 1469598103934665603UL;\n");
+    fprintf(out, "    for (int i = 0; i < %d; i++) h = (h ^ k[i]) * 1099511628211UL;\n", nkeys);
+    fprintf(out, "    h ^= h >> 33;\n    h *= 0xff51afd7ed558ccdUL;\n    h ^= h >> 33;\n");
+    fprintf(out, "    unsigned long slot = h %% %dUL;\n", memo_capacity);
+    fprintf(out, "    if (%s_memo[slot].used && memcmp(%s_memo[slot].k, k, sizeof(k)) == 0)\n",
+            fi->name, fi->name);
+    fprintf(out, "        return %s_memo[slot].value;\n", fi->name);
+    fprintf(out, "    %s v = %s(", ret_type, impl);
+    for (int p = 0; p < fi->param_count; p++)
+        fprintf(out, "%s%s", (p > 0) ? ", " : "", fi->params[p].name);
+    fprintf(out, ");\n");
+    fprintf(out, "    %s_memo[slot].used = 1;\n", fi->name);
+    fprintf(out, "    memcpy(%s_memo[slot].k, k, sizeof(k));\n", fi->name);
+    fprintf(out, "    %s_memo[slot].value = v;\n", fi->name);
+    fprintf(out, "    return v;\n}\n\n");
+}
+
+/* ========================================================= */
+/*  PROFIL A L'EXECUTION (--profile)                          */
+/* ========================================================= */
+/*
+ * Le C instrumente compte les appels de chaque fonction et son temps
+ * inclusif (rdtsc sur x86, horloge monotone sinon ; une fonction
+ * recursive n'est chronometree qu'a son activation la plus externe),
+ * et les iterations de chaque boucle : ses sauts arriere (retour en
+ * tete, CONTINUER, REPETER) incrementent un compteur. A la sortie du
+ * programme, un rapport trie part sur stderr avec les lignes du source.
+ * Une fonction integree a l'appelant est comptee dans celui-ci ; pour
+ * une fonction MEMOISER, seuls les calculs (defauts du cache) sont
+ * comptes. Sans --profile, rien de tout cela n'est emis.
+ *
+ * Lire l'horloge coute plus cher qu'un petit corps de fonction :
+ *   - une fonction sans boucle ni appel n'est que comptee, son temps
+ *     revient a l'appelant ;
+ *   - une fonction qui s'appelle elle-meme devient un corps
+ *     "f_profil", qui compte ses appels et s'appelle directement, et
+ *     une enveloppe f, qui le chronometre : seuls les appels venus
+ *     d'ailleurs lisent l'horloge ;
+ *   - si ce corps est court et sans boucle, meme le compteur pese :
+ *     seule l'enveloppe compte, le rapport marque ces appels d'un '*'.
+ */
+
+static _Thread_local int profile_mode = 0;
+
+void set_profile_mode(int enabled)
+{
+    profile_mode = enabled;
+}
+
+/* Types, horloge et macros d'entree/sortie de fonction */
+static const char *const profile_runtime =
+    "/* --- Profil (--profile) --- */\n"
+    "#if defined(__x86_64__) || defined(__i386__)\n"
+    "#define ml_prof_ticks() __builtin_ia32_rdtsc()\n"
+    "#else\n"
+    "static unsigned long long ml_prof_ticks(void) {\n"
+    "    struct timespec t;\n"
+    "    clock_gettime(CLOCK_MONOTONIC, &t);\n"
+    "    return t.tv_sec * 1000000000ULL + t.tv_nsec;\n"
+    "}\n"
+    "#endif\n"
+    "typedef struct { const char *name; int line; int timed; unsigned long calls; int active; unsigned long long ticks; } MlProfFunction;\n"
+    "typedef struct { const char *function; int line; unsigned long count; } MlProfLoop;\n"
+    "#define ML_PROF_COUNT(k) ml_prof_functions[k].calls++\n"
+    "#define ML_PROF_START(k) unsigned long long ml_prof_t0 = ml_prof_functions[k].active++ ? 0 : ml_prof_ticks()\n"
+    "#define ML_PROF_ENTER(k) ML_PROF_START(k); ML_PROF_COUNT(k)\n"
+    "#define ML_PROF_EXIT(k) if (--ml_prof_functions[k].active == 0) ml_prof_functions[k].ticks += ml_prof_ticks() - ml_prof_t0\n";
+
+/* Rapport, emis apres les tables ml_prof_functions et ml_prof_loops */
+static const char *const profile_report =
+    "static struct timespec ml_prof_start;\n"
+    "static unsigned long long ml_prof_start_ticks;\n"
+    "static int ml_prof_by_time(const void *a, const void *b) {\n"
+    "    unsigned long long x = ((const MlProfFunction *)a)->ticks, y = ((const MlProfFunction *)b)->ticks;\n"
+    "    return (x < y) - (x > y);\n"
+    "}\n"
+    "static int ml_prof_by_count(const void *a, const void *b) {\n"
+    "    unsigned long x = ((const MlProfLoop *)a)->count, y = ((const MlProfLoop *)b)->count;\n"
+    "    return (x < y) - (x > y);\n"
+    "}\n"
+    "static void ml_prof_report(void) {\n"
+    "    struct timespec now;\n"
+    "    clock_gettime(CLOCK_MONOTONIC, &now);\n"
+    "    unsigned long long ticks = ml_prof_ticks() - ml_prof_start_ticks;\n"
+    "    double ms = (now.tv_sec - ml_prof_start.tv_sec) * 1e3 + (now.tv_nsec - ml_prof_start.tv_nsec) / 1e6;\n"
+    "    double ms_per_tick = ticks ? ms / ticks : 0.0;\n"
+    "    qsort(ml_prof_functions, ML_PROF_NFUNCTIONS, sizeof(MlProfFunction), ml_prof_by_time);\n"
+    "    qsort(ml_prof_loops, ML_PROF_NLOOPS, sizeof(MlProfLoop), ml_prof_by_count);\n"
+    "    fprintf(stderr, \"\\n=== Profil : %.3f ms ===\\n\", ms);\n"
+    "    fprintf(stderr, \"%-24s %6s %14s %12s %7s\\n\", \"Fonction\", \"Ligne\", \"Appels\", \"Temps (ms)\", \"%\");\n"
+    "    int short_seen = 0;\n"
+    "    for (int k = 0; k < ML_PROF_NFUNCTIONS; k++) {\n"
+    "        const MlProfFunction *f = &ml_prof_functions[k];\n"
+    "        if (f->calls == 0) continue;\n"
+    "        double f_ms = f->ticks * ms_per_tick;\n"
+    "        if (!f->timed)\n"
+    "            fprintf(stderr, \"%-24s %6d %14lu %12s %7s\\n\", f->name, f->line, f->calls, \"-\", \"-\");\n"
+    "        else\n"
+    "            fprintf(stderr, \"%-24s %6d %13lu%c %12.3f %6.1f%%\\n\", f->name, f->line, f->calls,\n"
+    "                    f->timed == 2 ? '*' : ' ', f_ms, ms > 0 ? 100.0 * f_ms / ms : 0.0);\n"
+    "        if (f->timed == 2) short_seen = 1;\n"
+    "    }\n"
+    "    if (short_seen) fprintf(stderr, \"* appels recursifs non comptes (fonction courte)\\n\");\n"
+    "    fprintf(stderr, \"%-24s %6s %14s\\n\", \"Boucle (dans)\", \"Ligne\", \"Iterations\");\n"
+    "    for (int k = 0; k < ML_PROF_NLOOPS; k++) {\n"
+    "        const MlProfLoop *l = &ml_prof_loops[k];\n"
+    "        if (l->count > 0) fprintf(stderr, \"%-24s %6d %14lu\\n\", l->function, l->line, l->count);\n"
+    "    }\n"
+    "}\n";
+
+/* ========================================================= */
+/*  GENERATION PAR PARTIES                                    */
+/* ========================================================= */
+
+/* --profile : instrumentation d'une fonction */
+typedef enum
+{
+    PROF_TIMED,     /* comptee et chronometree */
+    PROF_COUNTED,   /* ni boucle ni appel : comptee seulement */
+    PROF_RECURSIVE, /* corps f_profil compte, enveloppe f chronometree */
+    PROF_SHORT      /* recursive courte : seule l'enveloppe compte et chronometre */
+} ProfKind;
+
+/* Au-dela, compter chaque appel recursif coute peu devant le corps */
+#define PROF_SHORT_MAX_QUADS 24
+
+/* Etat partage par le programme complet et les unites separees */
+typedef struct
+{
+    QuadList *list;
+    SymbolTable *table;
+    FunctionInfo *functions;
+    int function_count;
     TempMap tmap;
-    temp_map_init(&tmap);
+    TempMap shared; /* noms cites par au moins une fonction (types inutilises) */
+    int *owner;
+    char *used_labels;
+    ParamBuffer pb;
+    int *loop_site;     /* --profile : compteur du saut arriere i (-1 : aucun) */
+    int site_count;
+    int *site_owner;    /* fonction de la boucle (-1 : main) */
+    int *site_line;
+    ProfKind *prof_kind; /* --profile : par fonction */
+} CodegenState;
+
+/* Une variable du programme que seul main utilise devient une locale de
+   main : gcc peut alors la garder en registre a travers les appels. */
+static int is_main_only(const CodegenState *st, const char *name)
+{
+    const TempMap *shared = &st->shared;
+    return shared->slots[temp_map_slot(shared, name, NULL)] < 0;
+}
 
-    int *owner = build_quad_owner_array(list, functions, function_count); /* AVANT infer_types_pass maintenant */
-    infer_types_pass(list, table, &tmap, functions, owner);
+/* Boucles profilees : un compteur par boucle du source, reperee par sa
+   tete (cible des sauts arriere) et nommee par la ligne que porte son
+   saut de retour. Les copies d'une boucle dans une meme fonction
+   (deroulement, integration) partagent le compteur de leur ligne. Un
+   saut vers un LABEL vient d'un appel terminal elimine : pas compte. */
+typedef struct
+{
+    int owner;
+    int key;        /* ligne, ou -(tete + 1) si elle est inconnue */
+    int quad;
+} BackEdge;
 
+static int compare_back_edges(const void *a, const void *b)
+{
+    const BackEdge *x = (const BackEdge *)a, *y = (const BackEdge *)b;
+    if (x->owner != y->owner)
+        return (x->owner > y->owner) - (x->owner < y->owner);
+    return (x->key > y->key) - (x->key < y->key);
+}
 
-    fprintf(out, "/* ===================================================== */\n");
-    fprintf(out, "/* Fichier genere automatiquement par le compilateur      */\n");
-    fprintf(out, "/* MathLang -> C. Ne pas modifier a la main.              */\n");
-    fprintf(out, "/* ===================================================== */\n\n");
-    fprintf(out, "#include <stdio.h>\n#include <stdlib.h>\n#include <string.h>\n");
-    fprintf(out, "#include <math.h>\n#include <ctype.h>\n#include <stdbool.h>\n");
-    fprintf(out, "#include <complex.h>\n\n");
+static void find_profile_sites(CodegenState *st)
+{
+    const QuadList *list = st->list;
+    int n = list->count;
+    int *header_line = (int *)calloc(n + 1, sizeof(int));
+    BackEdge *edges = (BackEdge *)malloc(sizeof(BackEdge) * (n + 1));
+    int nedges = 0;
+    st->loop_site = (int *)malloc(sizeof(int) * (n + 1));
+    for (int i = 0; i < n; i++)
+    {
+        st->loop_site[i] = -1;
+        int t = getQuadTarget(&list->quads[i]);
+        if (t < 0 || t > i || st->owner[t] != st->owner[i] || list->quads[t].op == QUAD_LABEL)
+            continue;
+        if (list->quads[i].line > header_line[t])
+            header_line[t] = list->quads[i].line;
+        edges[nedges].owner = st->owner[i];
+        edges[nedges].quad = i;
+        nedges++;
+    }
+    for (int e = 0; e < nedges; e++)
+    {
+        int t = getQuadTarget(&list->quads[edges[e].quad]);
+        edges[e].key = header_line[t] > 0 ? header_line[t] : -(t + 1);
+    }
+    qsort(edges, nedges, sizeof(BackEdge), compare_back_edges);
 
-    /* --- Variables globales MathLang (portee programme) : declarees a
-       l'echelle du fichier pour rester visibles depuis les fonctions --- */
-    fprintf(out, "/* --- Variables globales declarees dans MathLang --- */\n");
-    if (table)
+    st->site_owner = (int *)malloc(sizeof(int) * (nedges + 1));
+    st->site_line = (int *)malloc(sizeof(int) * (nedges + 1));
+    st->site_count = 0;
+    for (int e = 0; e < nedges; e++)
+    {
+        if (e == 0 || compare_back_edges(&edges[e - 1], &edges[e]) != 0)
+        {
+            int owner = edges[e].owner;
+            st->site_owner[st->site_count] = owner;
+            st->site_line[st->site_count] = edges[e].key > 0 ? edges[e].key
+                                            : owner >= 0 ? st->functions[owner].decl_line : 0;
+            st->site_count++;
+        }
+        st->loop_site[edges[e].quad] = st->site_count - 1;
+    }
+    free(edges);
+    free(header_line);
+
+    st->prof_kind = (ProfKind *)malloc(sizeof(ProfKind) * (st->function_count + 1));
+    for (int f = 0; f < st->function_count; f++)
     {
-        for (int i = 0; i < HASH_TABLE_SIZE; i++)
+        const FunctionInfo *fi = &st->functions[f];
+        int calls = 0, self_calls = 0, loops = 0;
+        for (int i = fi->quad_start; i < fi->quad_end && i < n; i++)
         {
-            SymbolEntry *e = table->entries[i];
-            while (e)
+            const Quadruplet *q = &list->quads[i];
+            if (q->op == QUAD_CALL)
             {
-                if (e->category == SYMBOL_VARIABLE || e->category == SYMBOL_CONSTANT)
-                {
-                    if (e->type == TYPE_SIGMA)
-                    {
-                        fprintf(out, "%s %s = NULL;\n", get_c_type(e->type), e->name);
-                    }
-                    else
-                    {
-                        fprintf(out, "%s %s;\n", get_c_type(e->type), e->name);
-                    }
-                }
-                e = e->next;
+                calls++;
+                if (q->arg1 && strcmp(q->arg1, fi->name) == 0)
+                    self_calls++;
             }
+            if (st->loop_site[i] >= 0)
+                loops++;
         }
+        /* MEMOISER : les appels recursifs passent par le cache */
+        if (fi->memoize)
+            st->prof_kind[f] = PROF_TIMED;
+        else if (calls == 0 && loops == 0)
+            st->prof_kind[f] = PROF_COUNTED;
+        else if (self_calls > 0 && loops == 0 && fi->quad_end - fi->quad_start <= PROF_SHORT_MAX_QUADS)
+            st->prof_kind[f] = PROF_SHORT;
+        else if (self_calls > 0)
+            st->prof_kind[f] = PROF_RECURSIVE;
+        else
+            st->prof_kind[f] = PROF_TIMED;
     }
-    fprintf(out, "\n/* --- Prototypes --- */\n");
-    for (int f = 0; f < function_count; f++)
+}
+
+static void profile_body_name(const FunctionInfo *fi, char *buf, size_t size)
+{
+    snprintf(buf, size, "%s_profil", fi->name);
+}
+
+/* Runtime du profil et tables des fonctions et des boucles */
+static void emit_profile_data(FILE *out, const CodegenState *st)
+{
+    fputs(profile_runtime, out);
+    fprintf(out, "enum { ML_PROF_NFUNCTIONS = %d, ML_PROF_NLOOPS = %d };\n",
+            st->function_count, st->site_count);
+    fprintf(out, "static MlProfFunction ml_prof_functions[%d] = {\n", st->function_count + 1);
+    for (int f = 0; f < st->function_count; f++)
+        fprintf(out, "    {\"%s\", %d, %d},\n", st->functions[f].name, st->functions[f].decl_line,
+                st->prof_kind[f] == PROF_SHORT ? 2 : st->prof_kind[f] != PROF_COUNTED);
+    fprintf(out, "    {0}\n};\nstatic MlProfLoop ml_prof_loops[%d] = {\n", st->site_count + 1);
+    for (int k = 0; k < st->site_count; k++)
+        fprintf(out, "    {\"%s\", %d},\n",
+                st->site_owner[k] >= 0 ? st->functions[st->site_owner[k]].name : "main",
+                st->site_line[k]);
+    fprintf(out, "    {0}\n};\n");
+    fputs(profile_report, out);
+    for (int f = 0; f < st->function_count; f++)
     {
-        emit_signature(out, &functions[f]);
+        if (st->prof_kind[f] != PROF_RECURSIVE && st->prof_kind[f] != PROF_SHORT)
+            continue;
+        char body[160];
+        profile_body_name(&st->functions[f], body, sizeof(body));
+        fprintf(out, "static ");
+        emit_signature_named(out, &st->functions[f], body);
         fprintf(out, ";\n");
     }
     fprintf(out, "\n");
+}
 
-    ParamBuffer pb;
-    pb_init(&pb);
-
-    /* --- Determine quels labels sont reellement des cibles de saut --- */
-    char *used_labels = calloc(list->count + 1, 1);
+static void codegen_begin(CodegenState *st, QuadList *list, SymbolTable *table,
+                          FunctionInfo *functions, int function_count)
+{
+    st->list = list;
+    st->table = table;
+    st->functions = functions;
+    st->function_count = function_count;
+    temp_map_init(&st->tmap);
+    st->owner = build_quad_owner_array(list, functions, function_count); /* AVANT infer_types_pass maintenant */
+    infer_types_pass(list, table, &st->tmap, functions, st->owner);
+    pb_init(&st->pb);
+
+    temp_map_init(&st->shared);
     for (int i = 0; i < list->count; i++)
     {
-        QuadOp op = list->quads[i].op;
-        if (op == QUAD_BR || op == QUAD_BZ || op == QUAD_BNZ ||
-            op == QUAD_BG || op == QUAD_BGE || op == QUAD_BL ||
-            op == QUAD_BLE || op == QUAD_BE || op == QUAD_BNE)
+        const Quadruplet *q = &list->quads[i];
+        if (st->owner[i] < 0)
+            continue;
+        const char *names[3] = {q->arg1, q->arg2, q->result};
+        for (int a = 0; a < 3; a++)
         {
-            int target = atoi(list->quads[i].result);
-            if (target >= 0 && target <= list->count)
-                used_labels[target] = 1;
+            if (names[a])
+                temp_map_set(&st->shared, names[a], NULL, TYPE_UNKNOWN, i);
         }
     }
 
-    /* --- Corps de chaque fonction/procedure --- */
-    for (int f = 0; f < function_count; f++)
+    /* --- Determine quels labels sont reellement des cibles de saut --- */
+    st->used_labels = calloc(list->count + 1, 1);
+    for (int i = 0; i < list->count; i++)
     {
-        FunctionInfo *fi = &functions[f];
-        emit_signature(out, fi);
-        fprintf(out, " {\n    /* --- Temporaires / variables locales --- */\n");
+        int target = getQuadTarget(&list->quads[i]);
+        if (target >= 0 && target <= list->count)
+            st->used_labels[target] = 1;
+    }
+
+    st->loop_site = st->site_owner = st->site_line = NULL;
+    st->prof_kind = NULL;
+    st->site_count = 0;
+    if (profile_mode)
+        find_profile_sites(st);
+}
+
+static void codegen_end(CodegenState *st)
+{
+    free(st->loop_site);
+    free(st->site_owner);
+    free(st->site_line);
+    free(st->prof_kind);
+    free(st->used_labels);
+    pb_free(&st->pb);
+    free(st->owner);
+    temp_map_free(&st->shared);
+    temp_map_free(&st->tmap);
+}
 
-        for (int t = 0; t < tmap.count; t++)
+static void emit_prelude(FILE *out)
+{
+    fprintf(out, "/* ===================================================== */\n");
+    fprintf(out, "/* Fichier genere automatiquement par le compilateur      */\n");
+    fprintf(out, "/* MathLang -> C. Ne pas modifier a la main.              */\n");
+    fprintf(out, "/* ===================================================== */\n\n");
+    fprintf(out, "#include <stdio.h>\n#include <stdlib.h>\n#include <string.h>\n");
+    fprintf(out, "#include <math.h>\n#include <ctype.h>\n#include <stdbool.h>\n");
+    fprintf(out, "#include <complex.h>\n");
+    if (profile_mode)
+        fprintf(out, "#include <time.h>\n");
+    fprintf(out, "\n");
+}
+
+/* 1 si l'identificateur "name" apparait dans "text" (mot entier) */
+static int mentions(const char *text, const char *name)
+{
+    size_t len = strlen(name);
+    for (const char *p = strstr(text, name); p; p = strstr(p + 1, name))
+    {
+        int before = (p > text) && (isalnum((unsigned char)p[-1]) || p[-1] == '_');
+        int after = isalnum((unsigned char)p[len]) || p[len] == '_';
+        if (!before && !after)
+            return 1;
+    }
+    return 0;
+}
+
+/* Variables globales MathLang, sauf celles de main seul (emit_main).
+   "used_by" : seulement celles que ce texte utilise, declarees extern
+   (unite d'une fonction) ; NULL : toutes, definies ici (programme
+   complet, unite de main) */
+static void emit_globals(FILE *out, const CodegenState *st, const char *used_by)
+{
+    SymbolTable *table = st->table;
+    if (!table)
+        return;
+    for (int i = 0; i < table->capacity; i++)
+    {
+        for (SymbolEntry *e = table->slots[i].decls; e; e = e->next)
         {
-            if (owner[tmap.entries[t].owner_quad] != f)
+            if (e->category != SYMBOL_VARIABLE && e->category != SYMBOL_CONSTANT)
+                continue;
+            if (is_main_only(st, e->name))
                 continue;
-            int is_param = 0;
-            for (int p = 0; p < fi->param_count; p++)
+            if (used_by)
             {
-                if (strcmp(fi->params[p].name, tmap.entries[t].name) == 0)
-                {
-                    is_param = 1;
-                    break;
-                }
+                if (mentions(used_by, e->name))
+                    fprintf(out, "extern %s %s;\n", get_c_type(e->type), e->name);
+            }
+            else if (e->type == TYPE_SIGMA)
+            {
+                fprintf(out, "%s %s = NULL;\n", get_c_type(e->type), e->name);
+            }
+            else
+            {
+                fprintf(out, "%s %s;\n", get_c_type(e->type), e->name);
             }
-            if (is_param)
-                continue;
-            fprintf(out, "    %s %s;\n", get_c_type(tmap.entries[t].type), tmap.entries[t].name);
         }
-        fprintf(out, "\n");
+    }
+}
 
-        for (int i = fi->quad_start; i < fi->quad_end && i < list->count; i++)
+/* Prototypes des fonctions ("used_by" : seulement celles appelees) */
+static void emit_prototypes(FILE *out, FunctionInfo *functions, int function_count,
+                            const char *used_by)
+{
+    for (int f = 0; f < function_count; f++)
+    {
+        char c_name[160];
+        if (used_by && !mentions(used_by, c_function_name(functions[f].name, c_name, sizeof(c_name))))
+            continue;
+        emit_signature(out, &functions[f]);
+        fprintf(out, ";\n");
+        char impl[160];
+        memo_impl_name(&functions[f], impl, sizeof(impl));
+        if (functions[f].memoize && (!used_by || mentions(used_by, impl)))
         {
-            if (used_labels[i])
-                fprintf(out, "L%d:;\n", i);
-            translate_quad(out, &list->quads[i], table, &tmap, &pb,fi);
+            fprintf(out, "static ");
+            emit_signature_named(out, &functions[f], impl);
+            fprintf(out, ";\n");
         }
-        if (used_labels[fi->quad_end])
-            fprintf(out, "L%d:;\n", fi->quad_end);
+    }
+}
 
-        if (fi->is_function)
-        {
-            fprintf(out, "    /* filet de securite si aucun RETOURNER n'est atteint */\n");
-            fprintf(out, "    return (%s)0;\n", get_c_type(fi->return_type));
-        }
-        else
+/* --profile, PROF_RECURSIVE : f chronometre son corps f_profil ;
+   PROF_SHORT : f compte aussi l'appel, le corps n'est pas instrumente */
+static void emit_profile_wrapper(FILE *out, FunctionInfo *fi, int f, ProfKind kind)
+{
+    char body[160], buf[160];
+    profile_body_name(fi, body, sizeof(body));
+    const char *c_body = c_function_name(body, buf, sizeof(buf));
+    emit_signature(out, fi);
+    fprintf(out, " {\n    %s(%d);\n    ", kind == PROF_SHORT ? "ML_PROF_ENTER" : "ML_PROF_START", f);
+    if (fi->is_function)
+        fprintf(out, "%s ml_prof_v = ", get_c_type(fi->return_type));
+    fprintf(out, "%s(", c_body);
+    for (int p = 0; p < fi->param_count; p++)
+        fprintf(out, "%s%s", (p > 0) ? ", " : "", fi->params[p].name);
+    fprintf(out, ");\n    ML_PROF_EXIT(%d);\n", f);
+    if (fi->is_function)
+        fprintf(out, "    return ml_prof_v;\n");
+    fprintf(out, "}\n\n");
+}
+
+/* Corps de la fonction f (et son enveloppe MEMOISER ou de profil) */
+static void emit_function(FILE *out, CodegenState *st, int f)
+{
+    FunctionInfo *fi = &st->functions[f];
+    TempMap *tmap = &st->tmap;
+    ProfKind kind = profile_mode ? st->prof_kind[f] : PROF_TIMED;
+    char profile_body[160], buf[160];
+    profile_body_name(fi, profile_body, sizeof(profile_body));
+    const char *c_profile_body = c_function_name(profile_body, buf, sizeof(buf));
+    source_line = fi->decl_line;
+    if (source_name && source_line > 0)
+        emit_line_directive(out, source_line);
+    if (fi->memoize)
+    {
+        char impl[160];
+        memo_impl_name(fi, impl, sizeof(impl));
+        fprintf(out, "static ");
+        emit_signature_named(out, fi, impl);
+    }
+    else if (kind == PROF_RECURSIVE || kind == PROF_SHORT)
+    {
+        fprintf(out, "static ");
+        emit_signature_named(out, fi, profile_body);
+    }
+    else
+    {
+        emit_signature(out, fi);
+    }
+    fprintf(out, " {\n    /* --- Temporaires / variables locales --- */\n");
+
+    for (int t = 0; t < tmap->count; t++)
+    {
+        if (st->owner[tmap->entries[t].owner_quad] != f)
+            continue;
+        int is_param = 0;
+        for (int p = 0; p < fi->param_count; p++)
         {
-            fprintf(out, "    return;\n");
+            if (strcmp(fi->params[p].name, tmap->entries[t].name) == 0)
+            {
+                is_param = 1;
+                break;
+            }
         }
-        fprintf(out, "}\n\n");
+        if (is_param)
+            continue;
+        fprintf(out, "    %s %s;\n", get_c_type(tmap->entries[t].type), tmap->entries[t].name);
+    }
+    fprintf(out, "\n");
+    if (profile_mode && kind != PROF_SHORT)
+        fprintf(out, "    %s(%d);\n", kind == PROF_TIMED ? "ML_PROF_ENTER" : "ML_PROF_COUNT", f);
+
+    /* Seule une fonction chronometree ici arrete l'horloge en sortie */
+    ProfilePoint point = {-1, kind == PROF_TIMED ? f : -1,
+                          kind == PROF_RECURSIVE || kind == PROF_SHORT ? c_profile_body : NULL};
+    for (int i = fi->quad_start; i < fi->quad_end && i < st->list->count; i++)
+    {
+        emit_quad_prefix(out, &st->list->quads[i], i, st->used_labels[i]);
+        point.loop_site = st->loop_site ? st->loop_site[i] : -1;
+        translate_quad(out, &st->list->quads[i], st->table, tmap, &st->pb, fi,
+                       profile_mode ? &point : NULL);
     }
+    if (st->used_labels[fi->quad_end])
+        fprintf(out, "L%d:;\n", fi->quad_end);
 
-    /* --- main() : uniquement les quadruplets hors de toute fonction --- */
+    if (profile_mode && kind == PROF_TIMED)
+        fprintf(out, "    ML_PROF_EXIT(%d);\n", f);
+    if (fi->is_function)
+    {
+        fprintf(out, "    /* filet de securite si aucun RETOURNER n'est atteint */\n");
+        fprintf(out, "    return (%s)0;\n", get_c_type(fi->return_type));
+    }
+    else
+    {
+        fprintf(out, "    return;\n");
+    }
+    fprintf(out, "}\n\n");
+
+    if (fi->memoize)
+    {
+        if (source_name && fi->decl_line > 0)
+            emit_line_directive(out, fi->decl_line);
+        emit_memo_wrapper(out, fi);
+    }
+    else if (kind == PROF_RECURSIVE || kind == PROF_SHORT)
+    {
+        if (source_name && fi->decl_line > 0)
+            emit_line_directive(out, fi->decl_line);
+        emit_profile_wrapper(out, fi, f, kind);
+    }
+}
+
+/* main() : uniquement les quadruplets hors de toute fonction */
+static void emit_main(FILE *out, CodegenState *st)
+{
+    TempMap *tmap = &st->tmap;
+    source_line = 0;
     fprintf(out, "int main(void) {\n    /* --- Temporaires / variables locales --- */\n");
-    for (int t = 0; t < tmap.count; t++)
+    /* Variables du programme que seul main utilise, a zero comme une globale */
+    SymbolTable *table = st->table;
+    for (int i = 0; table && i < table->capacity; i++)
+    {
+        for (SymbolEntry *e = table->slots[i].decls; e; e = e->next)
+        {
+            if ((e->category == SYMBOL_VARIABLE || e->category == SYMBOL_CONSTANT) &&
+                is_main_only(st, e->name))
+                fprintf(out, "    %s %s = %s;\n", get_c_type(e->type), e->name,
+                        e->type == TYPE_SIGMA ? "NULL" : "0");
+        }
+    }
+    for (int t = 0; t < tmap->count; t++)
     {
-        if (owner[tmap.entries[t].owner_quad] != -1)
+        if (st->owner[tmap->entries[t].owner_quad] != -1)
             continue;
-        fprintf(out, "    %s %s;\n", get_c_type(tmap.entries[t].type), tmap.entries[t].name);
+        fprintf(out, "    %s %s;\n", get_c_type(tmap->entries[t].type), tmap->entries[t].name);
     }
     fprintf(out, "\n");
+    if (profile_mode)
+    {
+        fprintf(out, "    clock_gettime(CLOCK_MONOTONIC, &ml_prof_start);\n");
+        fprintf(out, "    ml_prof_start_ticks = ml_prof_ticks();\n");
+        fprintf(out, "    atexit(ml_prof_report);\n\n");
+    }
 
-    for (int i = 0; i < list->count; i++)
+    ProfilePoint point = {-1, -1, NULL};
+    for (int i = 0; i < st->list->count; i++)
     {
-        if (owner[i] != -1)
+        if (st->owner[i] != -1)
             continue;
-        if (used_labels[i])
-            fprintf(out, "L%d:;\n", i);
-        translate_quad(out, &list->quads[i], table, &tmap, &pb,NULL);
+        emit_quad_prefix(out, &st->list->quads[i], i, st->used_labels[i]);
+        point.loop_site = st->loop_site ? st->loop_site[i] : -1;
+        translate_quad(out, &st->list->quads[i], st->table, tmap, &st->pb, NULL,
+                       profile_mode ? &point : NULL);
     }
-    if (used_labels[list->count])
-        fprintf(out, "L%d:;\n", list->count);
+    if (st->used_labels[st->list->count])
+        fprintf(out, "L%d:;\n", st->list->count);
     fprintf(out, "    return 0;\n}\n");
+}
+
+/* Le programme en un seul fichier */
+static void emit_program(FILE *out, CodegenState *st)
+{
+    FunctionInfo *functions = st->functions;
+    int function_count = st->function_count;
+    emit_prelude(out);
+
+    /* --- Variables globales MathLang (portee programme) : declarees a
+       l'echelle du fichier pour rester visibles depuis les fonctions ;
+       celles que seul main utilise sont des locales de main --- */
+    fprintf(out, "/* --- Variables globales declarees dans MathLang --- */\n");
+    emit_globals(out, st, NULL);
+    fprintf(out, "\n/* --- Prototypes --- */\n");
+    emit_prototypes(out, functions, function_count, NULL);
+    fprintf(out, "\n");
+    if (profile_mode)
+        emit_profile_data(out, st);
+
+    /* --- Corps de chaque fonction/procedure --- */
+    for (int f = 0; f < function_count; f++)
+        emit_function(out, st, f);
+    emit_main(out, st);
+}
+
+void generate_c_code(FILE *out, QuadList *list, SymbolTable *table,
+                     FunctionInfo *functions, int function_count)
+{
+    if (!out || !list)
+        return;
+
+    CodegenState st;
+    codegen_begin(&st, list, table, functions, function_count);
+    emit_program(out, &st);
+    codegen_end(&st);
+}
 
-    free(used_labels);
-    pb_free(&pb);
-    free(owner);
-    temp_map_free(&tmap);
-}
\ No newline at end of file
+/* ========================================================= */
+/*  UNITES SEPAREES (COMPILATION INCREMENTALE)                */
+/* ========================================================= */
+/*
+ * Le texte d'une unite ne doit changer que si la fonction change, ou
+ * la signature d'une fonction qu'elle appelle, ou le type d'une globale
+ * qu'elle lit. Or les temporaires (Tn) et les etiquettes (Ln, indices
+ * de quadruplets) sont numerotes sur tout le programme : modifier une
+ * fonction decale ceux de toutes les suivantes. Ils sont donc
+ * renumerotes dans l'ordre de leur premiere apparition dans l'unite.
+ * Les deux sont locaux a la fonction : le renommage ne change pas le
+ * code produit, seulement son texte.
+ */
+
+/* Renumerote les Tn declares dans l'unite de f (-1 : main) et les
+   etiquettes Ln ("goto Ln" et "Ln:;") */
+static char *canonicalize_locals(const char *text, const CodegenState *st, int f)
+{
+    int ntemps = 0;
+    for (int t = 0; t < st->tmap.count; t++)
+    {
+        const char *n = st->tmap.entries[t].name;
+        if (n[0] == 'T' && isdigit((unsigned char)n[1]) && atoi(n + 1) >= ntemps)
+            ntemps = atoi(n + 1) + 1;
+    }
+    int *temp_map = (int *)malloc(sizeof(int) * (ntemps + 1));
+    int *label_map = (int *)malloc(sizeof(int) * (st->list->count + 1));
+    for (int k = 0; k < ntemps; k++)
+        temp_map[k] = -2;          /* -2 : pas un temporaire de l'unite */
+    for (int t = 0; t < st->tmap.count; t++)
+    {
+        const char *n = st->tmap.entries[t].name;
+        if (st->owner[st->tmap.entries[t].owner_quad] == f && n[0] == 'T' &&
+            isdigit((unsigned char)n[1]))
+            temp_map[atoi(n + 1)] = -1;
+    }
+    for (int k = 0; k <= st->list->count; k++)
+        label_map[k] = -1;
+    int next_temp = 0, next_label = 0;
+
+    size_t len = strlen(text);
+    char *result = NULL;
+    size_t result_size = 0;
+    FILE *out = open_memstream(&result, &result_size);
+    for (size_t i = 0; i < len;)
+    {
+        char c = text[i];
+        if (c == '"' || c == '\'')
+        {
+            /* litteral : recopie tel quel */
+            size_t start = i++;
+            while (i < len && text[i] != c)
+                i += (text[i] == '\\' && i + 1 < len) ? 2 : 1;
+            if (i < len)
+                i++;
+            fwrite(text + start, 1, i - start, out);
+            continue;
+        }
+        if (!isalpha((unsigned char)c) && c != '_')
+        {
+            fputc(text[i++], out);
+            continue;
+        }
+        size_t start = i;
+        while (i < len && (isalnum((unsigned char)text[i]) || text[i] == '_'))
+            i++;
+        size_t n = i - start;
+        int digits = n > 1;
+        for (size_t k = start + 1; k < i && digits; k++)
+            digits = isdigit((unsigned char)text[k]) != 0;
+        int number = digits ? atoi(text + start + 1) : -1;
+
+        int renamed = -1;
+        if (digits && c == 'T' && number < ntemps && temp_map[number] != -2)
+        {
+            if (temp_map[number] == -1)
+                temp_map[number] = next_temp++;
+            renamed = temp_map[number];
+        }
+        else if (digits && c == 'L' && number <= st->list->count &&
+                 ((start >= 5 && strncmp(text + start - 5, "goto ", 5) == 0) ||
+                  ((start == 0 || text[start - 1] == '\n') && strncmp(text + i, ":;", 2) == 0)))
+        {
+            if (label_map[number] == -1)
+                label_map[number] = next_label++;
+            renamed = label_map[number];
+        }
+
+        if (renamed >= 0)
+            fprintf(out, "%c%d", c, renamed);
+        else
+            fwrite(text + start, 1, n, out);
+    }
+    fclose(out);
+    free(temp_map);
+    free(label_map);
+    return result;
+}
+
+/* Assemble une unite : prelude, globales et prototypes utilises, corps */
+static void add_unit(CUnit **units, int *count, const char *name, const CodegenState *st,
+                     const char *body, int define_globals)
+{
+    CUnit *u = &(*units)[(*count)++];
+    snprintf(u->name, sizeof(u->name), "%s", name);
+    FILE *out = open_memstream(&u->text, &u->size);
+    emit_prelude(out);
+    if (define_globals)
+        emit_globals(out, st, NULL);
+    else
+        emit_globals(out, st, body);
+    emit_prototypes(out, st->functions, st->function_count, body);
+    fprintf(out, "\n%s", body);
+    fclose(out);
+}
+
+int generate_c_units(FILE *out, QuadList *list, SymbolTable *table,
+                     FunctionInfo *functions, int function_count, CUnit **units)
+{
+    *units = NULL;
+    if (!list)
+        return 0;
+
+    /* les unites sont mises en cache d'une compilation a l'autre :
+       jamais instrumentees, et sans #line, qui changerait le texte de
+       toutes les fonctions situees apres une ligne ajoutee */
+    int saved_profile_mode = profile_mode;
+    profile_mode = 0;
+    CodegenState st;
+    codegen_begin(&st, list, table, functions, function_count);
+    if (out)
+        emit_program(out, &st);
+    const char *saved_source_name = source_name;
+    source_name = NULL;
+    *units = (CUnit *)calloc(function_count + 1, sizeof(CUnit));
+    int count = 0;
+
+    for (int f = 0; f <= function_count; f++)
+    {
+        char *raw = NULL;
+        size_t raw_size = 0;
+        FILE *part = open_memstream(&raw, &raw_size);
+        if (f < function_count)
+            emit_function(part, &st, f);
+        else
+            emit_main(part, &st);
+        fclose(part);
+
+        char *body = canonicalize_locals(raw, &st, f < function_count ? f : -1);
+        char c_name[160];
+        add_unit(units, &count,
+                 f < function_count ? c_function_name(functions[f].name, c_name, sizeof(c_name)) : "main",
+                 &st, body, f == function_count);
+        free(body);
+        free(raw);
+    }
+
+    codegen_end(&st);
+    profile_mode = saved_profile_mode;
+    source_name = saved_source_name;
+    return count;
+}
+
+void free_c_units(CUnit *units, int count)
+{
+    for (int u = 0; u < count; u++)
+        free(units[u].text);
+    free(units);
+}
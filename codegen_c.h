@@ -11,4 +11,35 @@
 /* ========================================================= */
 void generate_c_code(FILE *out, QuadList *list, SymbolTable *table,
                      FunctionInfo *functions, int function_count);
+
+/* Le meme programme en unites compilables separement : une par fonction
+   (globales lues en extern, prototypes des fonctions appelees), puis
+   main, qui definit les globales. Le texte d'une unite ne depend que de
+   sa fonction et de ces declarations (temporaires et etiquettes
+   renumerotes, pas de #line) : il sert de cle au cache de --incremental. "out" : si
+   non NULL, le programme complet y est aussi ecrit (une seule analyse
+   des types pour les deux). */
+typedef struct {
+    char name[160];     /* nom C de la fonction, "main" */
+    char *text;
+    size_t size;
+} CUnit;
+
+int generate_c_units(FILE *out, QuadList *list, SymbolTable *table,
+                     FunctionInfo *functions, int function_count, CUnit **units);
+void free_c_units(CUnit *units, int count);
+
+/* Nombre d'entrees du cache genere pour une fonction MEMOISER */
+#define MEMO_DEFAULT_CAPACITY 4096
+#define MEMO_MAX_CAPACITY (1 << 24)
+void set_memo_capacity(int capacity);
+
+/* --profile : C instrumente (appels et temps des fonctions, iterations
+   des boucles, rapport sur stderr a la sortie). Sans effet sur
+   generate_c_units. */
+void set_profile_mode(int enabled);
+
+/* Source des quadruplets : le C porte des directives #line vers ce
+   fichier (NULL : aucune) */
+void set_source_name(const char *path);
 #endif
\ No newline at end of file
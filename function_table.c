@@ -1,28 +1,109 @@
 #include "function_table.h"
+#include <stdio.h>
+#include <stdlib.h>
 #include <string.h>
 
-static FunctionInfo g_functions[FT_MAX_FUNCTIONS];
-static int g_function_count = 0;
+/* Table propre a chaque thread : compilations paralleles (libmathlang).
+   Les entrees sont contigues et agrandies a la demande ; g_index les
+   retrouve par nom (adressage ouvert, indices dans g_functions, -1 :
+   case libre). */
+static _Thread_local FunctionInfo* g_functions = NULL;
+static _Thread_local int g_function_count = 0;
+static _Thread_local int g_function_capacity = 0;
+
+static _Thread_local int* g_index = NULL;
+static _Thread_local int g_index_capacity = 0;     /* puissance de 2 */
 
 #define FT_STACK_SIZE 64
-static int g_stack[FT_STACK_SIZE];   /* indices dans g_functions */
-static int g_stack_top = -1;
+static _Thread_local int g_stack[FT_STACK_SIZE];   /* indices dans g_functions */
+static _Thread_local int g_stack_top = -1;
+
+static void* ft_alloc(void* ptr, size_t size) {
+    ptr = realloc(ptr, size);
+    if (!ptr) {
+        perror("realloc function_table");
+        exit(EXIT_FAILURE);
+    }
+    return ptr;
+}
+
+/* ========================================================= */
+/*  INDEX PAR NOM                                             */
+/* ========================================================= */
+
+static int* index_slot(const char* name) {
+    unsigned mask = (unsigned)g_index_capacity - 1;
+    for (unsigned k = hash_function(name) & mask;; k = (k + 1) & mask) {
+        int i = g_index[k];
+        if (i < 0 || strcmp(g_functions[i].name, name) == 0) return &g_index[k];
+    }
+}
+
+/* Un nom deja present garde sa premiere entree */
+static void index_add(int idx) {
+    int* slot = index_slot(g_functions[idx].name);
+    if (*slot < 0) *slot = idx;
+}
+
+static void index_reserve(int count) {
+    if (count * 2 <= g_index_capacity) return;
+    int capacity = g_index_capacity ? g_index_capacity : 64;
+    while (count * 2 > capacity) capacity *= 2;
+    g_index = (int*)ft_alloc(g_index, sizeof(int) * (size_t)capacity);
+    g_index_capacity = capacity;
+    memset(g_index, -1, sizeof(int) * (size_t)capacity);
+    for (int i = 0; i < g_function_count; i++) index_add(i);
+}
+
+/* Nouvelle entree (remise a zero), nommee "name" et indexee */
+static int new_entry(const char* name) {
+    if (g_function_count >= g_function_capacity) {
+        g_function_capacity = g_function_capacity ? g_function_capacity * 2 : 64;
+        g_functions = (FunctionInfo*)ft_alloc(g_functions,
+                                              sizeof(FunctionInfo) * (size_t)g_function_capacity);
+    }
+    index_reserve(g_function_count + 1);
+    int idx = g_function_count++;
+    FunctionInfo* fi = &g_functions[idx];
+    memset(fi, 0, sizeof(*fi));
+    fi->name = ft_alloc(NULL, strlen(name) + 1);
+    strcpy(fi->name, name);
+    index_add(idx);
+    return idx;
+}
+
+/* ========================================================= */
+/*  API                                                       */
+/* ========================================================= */
 
 void ft_reset(void) {
+    for (int i = 0; i < g_function_count; i++) {
+        free(g_functions[i].name);
+        free(g_functions[i].params);
+    }
     g_function_count = 0;
+    if (g_index) memset(g_index, -1, sizeof(int) * (size_t)g_index_capacity);
     g_stack_top = -1;
 }
 
-void ft_begin(const char* name, int is_function) {
-    if (g_function_count >= FT_MAX_FUNCTIONS) return;
+void ft_free(void) {
+    ft_reset();
+    free(g_functions);
+    g_functions = NULL;
+    g_function_capacity = 0;
+    free(g_index);
+    g_index = NULL;
+    g_index_capacity = 0;
+}
+
+void ft_begin(const char* name, int is_function, int line) {
     if (g_stack_top + 1 >= FT_STACK_SIZE) return;
 
-    int idx = g_function_count++;
+    int idx = new_entry(name);
     FunctionInfo* fi = &g_functions[idx];
-    memset(fi, 0, sizeof(*fi));
-    strncpy(fi->name, name, sizeof(fi->name) - 1);
     fi->is_function = is_function;
     fi->return_type = TYPE_VOID;
+    fi->decl_line = line;
 
     g_stack_top++;
     g_stack[g_stack_top] = idx;
@@ -33,12 +114,19 @@ static FunctionInfo* current(void) {
     return &g_functions[g_stack[g_stack_top]];
 }
 
-void ft_add_param(DataType type, const char* name) {
+int ft_add_param(DataType type, const char* name) {
     FunctionInfo* fi = current();
-    if (!fi || fi->param_count >= FT_MAX_PARAMS) return;
-    fi->params[fi->param_count].type = type;
-    strncpy(fi->params[fi->param_count].name, name, sizeof(fi->params[0].name) - 1);
-    fi->param_count++;
+    if (!fi) return 1;
+    if (fi->param_count >= FT_MAX_PARAMS) return 0;
+    if (fi->param_count >= fi->param_capacity) {
+        fi->param_capacity = fi->param_capacity ? fi->param_capacity * 2 : 4;
+        fi->params = (FTParam*)ft_alloc(fi->params, sizeof(FTParam) * (size_t)fi->param_capacity);
+    }
+    FTParam* p = &fi->params[fi->param_count++];
+    memset(p, 0, sizeof(*p));
+    p->type = type;
+    strncpy(p->name, name, sizeof(p->name) - 1);
+    return 1;
 }
 
 void ft_set_return_type(DataType type) {
@@ -51,6 +139,13 @@ void ft_set_quad_start(int quad_start) {
     if (fi) fi->quad_start = quad_start;
 }
 
+void ft_set_memoize(int line) {
+    FunctionInfo* fi = current();
+    if (!fi) return;
+    fi->memoize = 1;
+    fi->line = line;
+}
+
 void ft_end(int quad_end) {
     FunctionInfo* fi = current();
     if (fi) fi->quad_end = quad_end;
@@ -58,10 +153,9 @@ void ft_end(int quad_end) {
 }
 
 FunctionInfo* ft_find(const char* name) {
-    for (int i = 0; i < g_function_count; i++) {
-        if (strcmp(g_functions[i].name, name) == 0) return &g_functions[i];
-    }
-    return NULL;
+    if (!g_index || !name) return NULL;
+    int i = *index_slot(name);
+    return i >= 0 ? &g_functions[i] : NULL;
 }
 
 FunctionInfo* ft_current(void) { return current(); }
@@ -69,4 +163,22 @@ FunctionInfo* ft_current(void) { return current(); }
 FunctionInfo* ft_get_all(int* count) {
     if (count) *count = g_function_count;
     return g_functions;
-}
\ No newline at end of file
+}
+
+FunctionInfo* ft_clone(const FunctionInfo* src, const char* name) {
+    /* src peut etre deplace par l'agrandissement de la table */
+    FunctionInfo copy = *src;
+    int idx = new_entry(name);
+    FunctionInfo* fi = &g_functions[idx];
+    char* own_name = fi->name;
+    *fi = copy;
+    fi->name = own_name;
+    fi->params = NULL;
+    fi->param_capacity = copy.param_count;
+    if (copy.param_count > 0) {
+        fi->params = (FTParam*)ft_alloc(NULL, sizeof(FTParam) * (size_t)copy.param_count);
+        memcpy(fi->params, copy.params, sizeof(FTParam) * (size_t)copy.param_count);
+    }
+    fi->memoize = 0;
+    return fi;
+}
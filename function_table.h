@@ -3,7 +3,8 @@
 
 #include "symbol_table.h"   /* pour DataType */
 
-#define FT_MAX_FUNCTIONS 256
+/* Nombre de parametres retenus par fonction (tampons des passes
+   d'optimisation) ; le nombre de fonctions n'est pas borne */
 #define FT_MAX_PARAMS    32
 
 typedef struct {
@@ -12,30 +13,45 @@ typedef struct {
 } FTParam;
 
 typedef struct {
-    char name[128];
+    char* name;
     int is_function;        /* 1 = fonction (retourne une valeur), 0 = procedure */
     DataType return_type;   /* TYPE_VOID pour une procedure */
-    FTParam params[FT_MAX_PARAMS];
+    FTParam* params;        /* alloue, param_count entrees */
     int param_count;
+    int param_capacity;
     int quad_start;         /* indice du premier quadruplet du corps */
     int quad_end;           /* indice juste apres le dernier quadruplet (exclusif) */
+    int memoize;            /* annotation MEMOISER (remise a 0 si la fonction est impure) */
+    int is_pure;            /* calcule par opt_analyze_purity */
+    int line;               /* ligne de l'annotation MEMOISER */
+    int decl_line;          /* ligne de FONCTION / PROCEDURE */
 } FunctionInfo;
 
 void ft_reset(void);
 
-/* A appeler juste apres avoir vu "TOK_FONCTION/TOK_PROCEDURE TOK_ID (" */
-void ft_begin(const char* name, int is_function);
+/* Libere la table du thread (fin de compilation) */
+void ft_free(void);
 
-/* A appeler pour chaque parametre, dans l'ordre */
-void ft_add_param(DataType type, const char* name);
+/* A appeler juste apres avoir vu "TOK_FONCTION/TOK_PROCEDURE TOK_ID (",
+   "line" : ligne du mot-cle */
+void ft_begin(const char* name, int is_function, int line);
+
+/* A appeler pour chaque parametre, dans l'ordre ; 0 si la fonction a
+   deja FT_MAX_PARAMS parametres (le parametre n'est pas ajoute) */
+int ft_add_param(DataType type, const char* name);
 
 void ft_set_return_type(DataType type);
 void ft_set_quad_start(int quad_start);
 
+/* Annotation MEMOISER sur la fonction en cours de definition */
+void ft_set_memoize(int line);
+
 /* A appeler juste apres "bloc TOK_FIN" */
 void ft_end(int quad_end);
 
-/* Recherche par nom (pour la verification des appels) */
+/* Recherche par nom (pour la verification des appels), par hachage.
+   Les entrees sont contigues (ft_get_all) : un pointeur obtenu ici reste
+   valide jusqu'au prochain ft_begin ou ft_clone. */
 FunctionInfo* ft_find(const char* name);
 
 /* La fonction en cours de definition (pile, utile si un jour on imbrique) */
@@ -44,4 +60,8 @@ FunctionInfo* ft_current(void);
 /* Pour le generateur de code : tableau complet + nombre d'entrees */
 FunctionInfo* ft_get_all(int* count);
 
+/* Ajoute une copie de src nommee "name" (specialisation) ; src peut etre
+   une entree de la table */
+FunctionInfo* ft_clone(const FunctionInfo* src, const char* name);
+
 #endif
\ No newline at end of file
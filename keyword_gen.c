@@ -0,0 +1,227 @@
+/* ========================================================= */
+/*  GENERATEUR DE LA TABLE DES MOTS-CLES                      */
+/* ========================================================= */
+/*
+ * Outil de construction : lit keywords.def et ecrit sur la sortie
+ * standard keywords_hash.h, une table de hachage parfaite a la gperf :
+ *
+ *   h(s) = (len + asso[s[0]] + asso[s[1]] + asso[s[len-1]]) % TAILLE
+ *
+ * (s[1] seulement si len >= 2, s[len-1] si len >= 3). Chaque mot-cle a
+ * sa case ; un identificateur est un mot-cle si la case visee contient
+ * exactement le meme texte. Les valeurs asso sont cherchees caractere
+ * par caractere, du plus frequent au moins frequent, avec retour
+ * arriere : quand toutes les positions d'un mot-cle sont fixees, sa
+ * case doit etre libre. On part de TAILLE = nombre de mots-cles (table
+ * minimale) et on agrandit si la recherche echoue.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+typedef struct {
+    const char* text;
+    const char* token;
+} Keyword;
+
+#define KEYWORD(text, token) { text, #token },
+static const Keyword keywords[] = {
+#include "keywords.def"
+};
+#undef KEYWORD
+
+#define NKEYWORDS ((int)(sizeof(keywords) / sizeof(keywords[0])))
+#define MAX_STEPS 200000L      /* essais par taille de table */
+
+static int table_size;
+static int asso[256];
+static unsigned char chars[256];   /* caracteres a fixer, par frequence */
+static int nchars;
+static int* level_keys;            /* mots-cles completes a chaque niveau... */
+static int level_start[257];       /* ...level_keys[level_start[i] .. level_start[i+1]) */
+static char* used;                 /* cases occupees */
+static long steps;
+
+static int key_positions(const char* s, unsigned char* pos) {
+    int len = (int)strlen(s), n = 0;
+    pos[n++] = (unsigned char)s[0];
+    if (len >= 2) pos[n++] = (unsigned char)s[1];
+    if (len >= 3) pos[n++] = (unsigned char)s[len - 1];
+    return n;
+}
+
+static int hash(const char* s) {
+    unsigned char pos[3];
+    int n = key_positions(s, pos);
+    unsigned h = (unsigned)strlen(s);
+    for (int i = 0; i < n; i++) h += (unsigned)asso[pos[i]];
+    return (int)(h % (unsigned)table_size);
+}
+
+static int compare_keywords(const void* a, const void* b) {
+    return strcmp(keywords[*(const int*)a].text, keywords[*(const int*)b].text);
+}
+
+/* Fixe chars[i], chars[i+1]... ; 1 si toutes les cases sont distinctes */
+static int search(int i) {
+    if (i == nchars) return 1;
+    if (++steps > MAX_STEPS) return 0;
+    unsigned char c = chars[i];
+    int claimed[NKEYWORDS];
+    for (int v = 0; v < table_size; v++) {
+        asso[c] = v;
+        int n = 0, ok = 1;
+        /* Les mots-cles completes par c doivent tomber dans des cases libres */
+        for (int j = level_start[i]; j < level_start[i + 1] && ok; j++) {
+            int h = hash(keywords[level_keys[j]].text);
+            if (used[h]) {
+                ok = 0;
+            } else {
+                used[h] = 1;
+                claimed[n++] = h;
+            }
+        }
+        if (ok && search(i + 1)) return 1;
+        while (n > 0) used[claimed[--n]] = 0;
+    }
+    asso[c] = 0;
+    return 0;
+}
+
+static int build(int size) {
+    table_size = size;
+    memset(asso, 0, sizeof(asso));
+    memset(used, 0, (size_t)size);
+    steps = 0;
+    return search(0);
+}
+
+int main(void) {
+    /* Frequence des caracteres aux positions hachees ; a frequence egale,
+       ordre de premiere apparition dans les mots-cles tries, pour que le
+       resultat ne depende pas de l'ordre de keywords.def */
+    int sorted[NKEYWORDS];
+    for (int k = 0; k < NKEYWORDS; k++) sorted[k] = k;
+    qsort(sorted, NKEYWORDS, sizeof(int), compare_keywords);
+    int freq[256] = { 0 }, first[256];
+    int min_len = 1 << 30, max_len = 0;
+    for (int r = 0; r < NKEYWORDS; r++) {
+        int k = sorted[r];
+        unsigned char pos[3];
+        int n = key_positions(keywords[k].text, pos);
+        for (int i = 0; i < n; i++) {
+            if (freq[pos[i]]++ == 0) first[pos[i]] = 3 * r + i;
+        }
+        int len = (int)strlen(keywords[k].text);
+        if (len < min_len) min_len = len;
+        if (len > max_len) max_len = len;
+    }
+    nchars = 0;
+    for (int c = 0; c < 256; c++) {
+        if (freq[c]) chars[nchars++] = (unsigned char)c;
+    }
+    for (int a = 0; a < nchars; a++) {
+        for (int b = a + 1; b < nchars; b++) {
+            if (freq[chars[b]] > freq[chars[a]] ||
+                (freq[chars[b]] == freq[chars[a]] && first[chars[b]] < first[chars[a]])) {
+                unsigned char t = chars[a];
+                chars[a] = chars[b];
+                chars[b] = t;
+            }
+        }
+    }
+    int rank[256];
+    for (int i = 0; i < nchars; i++) rank[chars[i]] = i;
+
+    /* Chaque mot-cle est verifie au niveau de son caractere le plus tardif */
+    int last[NKEYWORDS];
+    for (int k = 0; k < NKEYWORDS; k++) {
+        unsigned char pos[3];
+        int n = key_positions(keywords[k].text, pos);
+        last[k] = 0;
+        for (int i = 0; i < n; i++) {
+            if (rank[pos[i]] > last[k]) last[k] = rank[pos[i]];
+        }
+    }
+    level_keys = (int*)malloc(sizeof(int) * NKEYWORDS);
+    int nk = 0;
+    for (int i = 0; i < nchars; i++) {
+        level_start[i] = nk;
+        for (int k = 0; k < NKEYWORDS; k++) {
+            if (last[k] == i) level_keys[nk++] = k;
+        }
+    }
+    level_start[nchars] = nk;
+
+    int size;
+    used = (char*)malloc((size_t)NKEYWORDS * 8);
+    for (size = NKEYWORDS; size <= NKEYWORDS * 8; size++) {
+        if (build(size)) break;
+    }
+    if (size > NKEYWORDS * 8) {
+        fprintf(stderr, "keyword_gen : aucune table parfaite trouvee\n");
+        return 1;
+    }
+
+    const char** slot = (const char**)calloc((size_t)size, sizeof(char*));
+    const char** token = (const char**)calloc((size_t)size, sizeof(char*));
+    for (int k = 0; k < NKEYWORDS; k++) {
+        int h = hash(keywords[k].text);
+        if (slot[h]) {
+            fprintf(stderr, "keyword_gen : collision entre '%s' et '%s'\n",
+                    slot[h], keywords[k].text);
+            return 1;
+        }
+        slot[h] = keywords[k].text;
+        token[h] = keywords[k].token;
+    }
+
+    printf("/* Genere par keyword_gen a partir de keywords.def : ne pas modifier. */\n");
+    printf("#ifndef KEYWORDS_HASH_H\n#define KEYWORDS_HASH_H\n\n");
+    printf("#include <string.h>\n\n");
+    printf("#define KW_COUNT %d\n", NKEYWORDS);
+    printf("#define KW_MIN_LEN %d\n", min_len);
+    printf("#define KW_MAX_LEN %d\n", max_len);
+    printf("#define KW_TABLE_SIZE %d\n\n", size);
+
+    /* Les valeurs asso sont < size : un octet tant que la table tient en
+       256 cases, 16 bits au-dela (size <= NKEYWORDS * 8) */
+    const char* asso_type = size <= 256 ? "unsigned char" : "unsigned short";
+    if (size > 65536) {
+        fprintf(stderr, "keyword_gen : table de %d cases, asso ne tient pas sur 16 bits\n", size);
+        return 1;
+    }
+    printf("static const %s kw_asso[256] = {", asso_type);
+    for (int c = 0; c < 256; c++) {
+        printf("%s%3d,", (c % 16 == 0) ? "\n    " : " ", asso[c]);
+    }
+    printf("\n};\n\n");
+
+    printf("static const struct {\n    const char* text;\n    unsigned char len;\n"
+           "    short token;\n} kw_table[KW_TABLE_SIZE] = {\n");
+    for (int h = 0; h < size; h++) {
+        if (slot[h])
+            printf("    { \"%s\", %d, %s },\n", slot[h], (int)strlen(slot[h]), token[h]);
+        else
+            printf("    { \"\", 0, 0 },\n");
+    }
+    printf("};\n\n");
+
+    printf("/* Token du mot-cle s[0..len), 0 si s n'est pas un mot-cle */\n");
+    printf("static inline int keyword_token(const char* s, size_t len) {\n");
+    printf("    if (len < KW_MIN_LEN || len > KW_MAX_LEN) return 0;\n");
+    printf("    unsigned h = (unsigned)len + kw_asso[(unsigned char)s[0]];\n");
+    printf("    if (len >= 2) h += kw_asso[(unsigned char)s[1]];\n");
+    printf("    if (len >= 3) h += kw_asso[(unsigned char)s[len - 1]];\n");
+    printf("    h %%= KW_TABLE_SIZE;\n");
+    printf("    return (kw_table[h].len == len && memcmp(kw_table[h].text, s, len) == 0)\n");
+    printf("               ? kw_table[h].token : 0;\n");
+    printf("}\n\n#endif\n");
+
+    free(slot);
+    free(token);
+    free(used);
+    free(level_keys);
+    return 0;
+}
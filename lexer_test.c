@@ -94,6 +94,8 @@ const char *token_name(int token)
         return "RETOURNER";
     case TOK_LAMBDA:
         return "LAMBDA";
+    case TOK_MEMOISER:
+        return "MEMOISER";
 
     /* Booléens */
     case TOK_TRUE:
@@ -0,0 +1,110 @@
+#include "loop_table.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+static _Thread_local LoopInfo g_loops[LT_MAX_LOOPS];
+static _Thread_local int g_loop_count = 0;
+
+#define LT_STACK_SIZE 64
+static _Thread_local LoopInfo g_pending[LT_STACK_SIZE];   /* boucles ouvertes (imbrication) */
+static _Thread_local int g_pending_top = -1;
+static _Thread_local int g_overflow = 0;     /* niveaux ouverts au-dela de la pile */
+
+static void free_loop(LoopInfo* li) {
+    free(li->var);
+    free(li->start);
+    free(li->end);
+    free(li->step);
+    memset(li, 0, sizeof(*li));
+}
+
+void lt_reset(void) {
+    for (int i = 0; i < g_loop_count; i++) free_loop(&g_loops[i]);
+    for (int i = 0; i <= g_pending_top; i++) free_loop(&g_pending[i]);
+    g_loop_count = 0;
+    g_pending_top = -1;
+    g_overflow = 0;
+}
+
+/* Copie entiere : un nom tronque ne designerait plus la variable */
+static char* copy_addr(const char* src) {
+    char* s = strdup(src ? src : "");
+    if (!s) {
+        perror("strdup");
+        exit(EXIT_FAILURE);
+    }
+    return s;
+}
+
+void lt_begin(const char* var, int line, int init_quad, int test_quad,
+              const char* start, const char* end) {
+    /* Trop profond : la boucle n'est pas suivie, mais son lt_end doit
+       la refermer elle, pas la boucle englobante */
+    if (g_pending_top + 1 >= LT_STACK_SIZE) {
+        g_overflow++;
+        return;
+    }
+
+    LoopInfo* li = &g_pending[++g_pending_top];
+    memset(li, 0, sizeof(*li));
+    li->var = copy_addr(var);
+    li->start = copy_addr(start);
+    li->end = copy_addr(end);
+    li->line = line;
+    li->init_quad = init_quad;
+    li->test_quad = test_quad;
+    li->trip_count = -1;
+}
+
+void lt_end(const char* step, int incr_quad, int back_quad, int exit_quad) {
+    if (g_overflow > 0) {
+        g_overflow--;
+        return;
+    }
+    if (g_pending_top < 0) return;
+    LoopInfo li = g_pending[g_pending_top--];
+    if (g_loop_count >= LT_MAX_LOOPS) {
+        free_loop(&li);
+        return;
+    }
+
+    li.step = copy_addr(step);
+    li.incr_quad = incr_quad;
+    li.back_quad = back_quad;
+    li.exit_quad = exit_quad;
+    g_loops[g_loop_count++] = li;
+}
+
+LoopInfo* lt_get_all(int* count) {
+    if (count) *count = g_loop_count;
+    return g_loops;
+}
+
+void lt_remap(const int* map) {
+    for (int i = 0; i < g_loop_count; i++) {
+        LoopInfo* li = &g_loops[i];
+        if (li->removed) continue;
+        li->init_quad = map[li->init_quad];
+        li->test_quad = map[li->test_quad];
+        li->incr_quad = map[li->incr_quad];
+        li->back_quad = map[li->back_quad];
+        li->exit_quad = map[li->exit_quad];
+    }
+}
+
+static void replace_addr(char** addr, const char* name, const char* value) {
+    if (strcmp(*addr, name) != 0) return;
+    free(*addr);
+    *addr = copy_addr(value);
+}
+
+void lt_replace_operand(int from, int to, const char* name, const char* value) {
+    for (int i = 0; i < g_loop_count; i++) {
+        LoopInfo* li = &g_loops[i];
+        if (li->removed || li->test_quad < from || li->test_quad >= to) continue;
+        replace_addr(&li->start, name, value);
+        replace_addr(&li->end, name, value);
+        replace_addr(&li->step, name, value);
+    }
+}
@@ -0,0 +1,56 @@
+#ifndef LOOP_TABLE_H
+#define LOOP_TABLE_H
+
+#define LT_MAX_LOOPS 1024
+
+/*
+ * Boucles POUR telles que generees par instruction_pour :
+ *
+ *   init_quad :  (:=  , debut, -   , i    )
+ *   test_quad :  (BG  , i    , fin , exit )
+ *                ... corps ...
+ *   incr_quad :  (+   , i    , pas , T    )
+ *                (:=  , T    , -   , i    )
+ *   back_quad :  (BR  , -    , -   , test )
+ *   exit_quad :  premier quadruplet apres la boucle
+ *
+ * Les indices sont tenus a jour par les passes d'optimisation qui
+ * reecrivent la liste de quadruplets (voir lt_remap).
+ */
+typedef struct {
+    char* var;                   /* variable de boucle */
+    char* start;                 /* adresse de la borne de depart */
+    char* end;                   /* adresse de la borne de fin */
+    char* step;                  /* adresse du pas ("1" sans PAR) */
+    int line;                    /* ligne du POUR dans le source */
+    int init_quad;
+    int test_quad;
+    int incr_quad;
+    int back_quad;
+    int exit_quad;
+    long trip_count;             /* nombre d'iterations, -1 si inconnu */
+    int removed;                 /* 1 si la boucle a disparu (deroulee...) */
+} LoopInfo;
+
+/* Vide la table et libere les noms copies */
+void lt_reset(void);
+
+/* A appeler juste apres la generation du BG de test */
+void lt_begin(const char* var, int line, int init_quad, int test_quad,
+              const char* start, const char* end);
+
+/* A appeler une fois le BR de retour genere et le BG complete */
+void lt_end(const char* step, int incr_quad, int back_quad, int exit_quad);
+
+/* Tableau complet + nombre d'entrees (ordre de fin de parsing :
+   les boucles internes precedent les boucles qui les contiennent) */
+LoopInfo* lt_get_all(int* count);
+
+/* Renumerotation apres reecriture : map[ancien] = nouvel indice */
+void lt_remap(const int* map);
+
+/* Une passe a remplace "name" par "value" dans [from, to) : les bornes
+   et le pas des boucles de cet intervalle suivent */
+void lt_replace_operand(int from, int to, const char* name, const char* value);
+
+#endif
@@ -0,0 +1,845 @@
+/* ========================================================= */
+/*  PILOTE EN LIGNE DE COMMANDE (parser)                      */
+/* ========================================================= */
+/*
+ * Analyse les options, ouvre les sorties demandees et appelle
+ * ml_compile_file (libmathlang.a). La compilation du C par gcc, la
+ * mesure du scanner (--bench-lex) et le mode lot (plusieurs sources,
+ * -j N processus) restent ici ; --server delegue a ml_server_run
+ * (server.c).
+ */
+
+#define _GNU_SOURCE
+#include <errno.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+#ifdef __GLIBC__
+#include <malloc.h>
+#endif
+#include <sys/resource.h>
+#include <sys/stat.h>
+#include <sys/wait.h>
+#include "mathlang.h"
+#include "server.h"
+
+/* Etapes du pipeline, dans l'ordre (--stop-after=<etape>) ; les quatre
+   premieres sont celles de MlStage, bin ajoute l'appel a gcc */
+enum { STAGE_LEX, STAGE_PARSE, STAGE_OPT, STAGE_C, STAGE_BIN };
+
+static const char* const stage_names[] = { "lex", "parse", "opt", "c", "bin" };
+
+/* Sorties demandees par --emit=<sortie>[:fichier],... Les vidages
+   (tokens, symboles, quadruplets, rapport des optimisations) vont sur
+   stdout sauf fichier donne ; c et bin sont des fichiers. */
+typedef enum {
+    EMIT_TOKENS, EMIT_SYMBOLS, EMIT_QUADS, EMIT_REPORT, EMIT_C, EMIT_BIN, EMIT_COUNT
+} EmitKind;
+
+static const char* const emit_names[EMIT_COUNT] = {
+    "tokens", "symbols", "quads", "report", "c", "bin"
+};
+
+typedef struct {
+    int requested;
+    const char* path;     /* NULL : stdout (vidages) ou nom par defaut */
+    FILE* stream;
+} EmitTarget;
+
+static EmitTarget emits[EMIT_COUNT];
+static char* emit_spec = NULL;     /* copie de l'argument, pointee par les path */
+
+static int parse_stage(const char* name) {
+    for (int s = STAGE_LEX; s <= STAGE_BIN; s++) {
+        if (strcmp(name, stage_names[s]) == 0) return s;
+    }
+    return -1;
+}
+
+/* Analyse "quads,tokens:toks.txt,bin" ; -1 si une sortie est inconnue */
+static int parse_emit_list(const char* list) {
+    free(emit_spec);
+    emit_spec = strdup(list);
+    for (char* item = strtok(emit_spec, ","); item; item = strtok(NULL, ",")) {
+        char* path = strchr(item, ':');
+        if (path) *path++ = '\0';
+        int kind = 0;
+        while (kind < EMIT_COUNT && strcmp(item, emit_names[kind]) != 0) kind++;
+        if (kind == EMIT_COUNT) {
+            fprintf(stderr, "Sortie inconnue pour --emit : %s\n", item);
+            return -1;
+        }
+        emits[kind].requested = 1;
+        emits[kind].path = (path && *path) ? path : NULL;
+    }
+    return 0;
+}
+
+/* Flux d'un vidage demande ; NULL si le vidage n'est pas demande ou si
+   le fichier ne peut etre cree */
+static FILE* emit_stream(EmitKind kind) {
+    EmitTarget* e = &emits[kind];
+    if (!e->requested) return NULL;
+    if (!e->stream) {
+        e->stream = e->path ? fopen(e->path, "w") : stdout;
+        if (!e->stream) {
+            fprintf(stderr, "Erreur : impossible d'ecrire %s\n", e->path);
+            e->requested = 0;
+        }
+    }
+    return e->stream;
+}
+
+static void emit_close_all(void) {
+    for (int k = 0; k < EMIT_COUNT; k++) {
+        if (emits[k].stream && emits[k].stream != stdout) fclose(emits[k].stream);
+        emits[k].stream = NULL;
+    }
+}
+
+/* --bench-lex : le scanner seul, sans analyse syntaxique */
+static int bench_lexer(MathLangContext* ctx, const char* path) {
+    struct timespec t0, t1;
+    ctx->options.stop_after = ML_STAGE_LEX;
+    clock_gettime(CLOCK_MONOTONIC, &t0);
+    int status = ml_compile_file(ctx, path);
+    clock_gettime(CLOCK_MONOTONIC, &t1);
+    if (status < 0) return 1;
+    double seconds = (t1.tv_sec - t0.tv_sec) + (t1.tv_nsec - t0.tv_nsec) / 1e9;
+    double mb = (double)ctx->source_bytes / 1e6;
+    printf("Analyse lexicale (%s) : %ld tokens, %.1f Mo en %.3f s, %.1f Mo/s\n",
+           ctx->input_mode, ctx->token_count, mb, seconds,
+           seconds > 0 ? mb / seconds : 0.0);
+    return 0;
+}
+
+/* ===================== */
+/* RAPPORT DE TEMPS      */
+/* ===================== */
+
+/*
+ * --time-report[=texte|json][:fichier] : temps reel et CPU de chaque phase
+ * (mesures par libmathlang, MlTimeReport), allocations et octets
+ * demandes pendant la phase (realloc : l'augmentation seulement),
+ * nombre de quadruplets, de temporaires et de symboles, puis temps de
+ * gcc (processus fils). Texte sur stderr par defaut, JSON pour les
+ * tableaux de bord.
+ */
+
+#ifdef __GLIBC__
+/* malloc, calloc et realloc de la glibc, comptes seulement quand le
+   rapport est demande : la glibc appelle aussi ces versions pour ses
+   propres allocations (strdup...). realloc compte un appel et
+   l'augmentation de la taille utilisable du bloc, pas sa taille totale. */
+extern void* __libc_malloc(size_t size);
+extern void* __libc_calloc(size_t count, size_t size);
+extern void* __libc_realloc(void* ptr, size_t size);
+
+static int alloc_counting = 0;          /* fixe avant toute compilation */
+static _Thread_local long alloc_count = 0;
+static _Thread_local long alloc_bytes = 0;
+
+void* malloc(size_t size) {
+    if (alloc_counting) {
+        alloc_count++;
+        alloc_bytes += (long)size;
+    }
+    return __libc_malloc(size);
+}
+
+void* calloc(size_t count, size_t size) {
+    if (alloc_counting) {
+        alloc_count++;
+        alloc_bytes += (long)(count * size);
+    }
+    return __libc_calloc(count, size);
+}
+
+void* realloc(void* ptr, size_t size) {
+    if (alloc_counting) {
+        size_t old = ptr ? malloc_usable_size(ptr) : 0;
+        alloc_count++;
+        if (size > old) alloc_bytes += (long)(size - old);
+    }
+    return __libc_realloc(ptr, size);
+}
+
+static void read_alloc_counters(long* allocations, long* bytes) {
+    *allocations = alloc_count;
+    *bytes = alloc_bytes;
+}
+#endif
+
+static int time_report_json = -1;       /* -1 : pas de rapport */
+static const char* time_report_path = NULL;
+static MlTimeReport time_report;
+
+/* Temps de gcc, lance par compile_one ou par build_incremental */
+static struct {
+    int measured;
+    double wall, cpu;
+} gcc_time;
+
+static double monotonic_seconds(void) {
+    struct timespec t;
+    clock_gettime(CLOCK_MONOTONIC, &t);
+    return t.tv_sec + t.tv_nsec / 1e9;
+}
+
+/* CPU (utilisateur + systeme) des processus fils termines */
+static double children_cpu_seconds(void) {
+    struct rusage usage;
+    getrusage(RUSAGE_CHILDREN, &usage);
+    return usage.ru_utime.tv_sec + usage.ru_utime.tv_usec / 1e6 +
+           usage.ru_stime.tv_sec + usage.ru_stime.tv_usec / 1e6;
+}
+
+/* "--time-report", "--time-report=json", "--time-report=json:f.json",
+   "--time-report=texte:f.txt" ; -1 si le format est inconnu */
+static int parse_time_report(const char* arg) {
+    time_report_json = 0;
+    time_report_path = NULL;
+    if (*arg == '\0') return 0;
+    if (*arg++ != '=') return -1;
+    if (strncmp(arg, "json", 4) == 0) {
+        time_report_json = 1;
+        arg += 4;
+    } else if (strncmp(arg, "texte", 5) == 0) {
+        arg += 5;
+    }
+    if (*arg == ':' && arg[1]) {
+        time_report_path = arg + 1;
+        return 0;
+    }
+    return *arg == '\0' ? 0 : -1;
+}
+
+static void print_phase_text(FILE* out, const char* name, const MlPhaseStats* p, int allocs) {
+    fprintf(out, "%-8s %10.3f %10.3f", name, p->wall * 1e3, p->cpu * 1e3);
+    if (allocs) {
+        fprintf(out, " %12ld %14ld\n", p->allocations, p->bytes);
+    } else {
+        fprintf(out, " %12s %14s\n", "-", "-");
+    }
+}
+
+static void print_phase_json(FILE* out, const char* name, const MlPhaseStats* p, int allocs) {
+    fprintf(out, "    \"%s\": ", name);
+    if (!p->measured) {
+        fprintf(out, "null");
+    } else if (allocs) {
+        fprintf(out, "{\"wall_s\": %.6f, \"cpu_s\": %.6f, \"allocations\": %ld, \"bytes\": %ld}",
+                p->wall, p->cpu, p->allocations, p->bytes);
+    } else {
+        fprintf(out, "{\"wall_s\": %.6f, \"cpu_s\": %.6f}", p->wall, p->cpu);
+    }
+}
+
+static void print_time_report(const char* source) {
+    if (time_report_json < 0) return;
+    FILE* out = time_report_path ? fopen(time_report_path, "w") : stderr;
+    if (!out) {
+        fprintf(stderr, "Erreur : impossible d'ecrire %s\n", time_report_path);
+        return;
+    }
+    const MlTimeReport* r = &time_report;
+    int allocs = r->alloc_counters != NULL;
+    MlPhaseStats gcc = { gcc_time.measured, gcc_time.wall, gcc_time.cpu, 0, 0 };
+    MlPhaseStats total = { 1, 0, 0, 0, 0 };
+    for (int s = ML_STAGE_LEX; s <= ML_STAGE_C; s++) {
+        total.wall += r->phases[s].wall;
+        total.cpu += r->phases[s].cpu;
+        total.allocations += r->phases[s].allocations;
+        total.bytes += r->phases[s].bytes;
+    }
+
+    if (time_report_json) {
+        fprintf(out, "{\n  \"source\": \"");
+        for (const char* c = source; *c; c++) {
+            if (*c == '"' || *c == '\\') fputc('\\', out);
+            fputc(*c, out);
+        }
+        fprintf(out, "\",\n  \"phases\": {\n");
+        for (int s = ML_STAGE_LEX; s <= ML_STAGE_C; s++) {
+            print_phase_json(out, stage_names[s], &r->phases[s], allocs);
+            fprintf(out, ",\n");
+        }
+        print_phase_json(out, "gcc", &gcc, 0);
+        fprintf(out, "\n  },\n  \"compiler_total\": {\"wall_s\": %.6f, \"cpu_s\": %.6f",
+                total.wall, total.cpu);
+        if (allocs) fprintf(out, ", \"allocations\": %ld, \"bytes\": %ld", total.allocations, total.bytes);
+        fprintf(out, "},\n  \"quads_parsed\": %d,\n  \"quads\": %d,\n"
+                     "  \"temps\": %d,\n  \"symbols\": %d\n}\n",
+                r->quads_parsed, r->quads, r->temps, r->symbols);
+    } else {
+        fprintf(out, "\n=== Rapport de temps : %s ===\n", source);
+        fprintf(out, "%-8s %10s %10s %12s %14s\n", "Phase", "Reel (ms)", "CPU (ms)", "Allocations", "Octets");
+        for (int s = ML_STAGE_LEX; s <= ML_STAGE_C; s++) {
+            if (r->phases[s].measured) print_phase_text(out, stage_names[s], &r->phases[s], allocs);
+        }
+        print_phase_text(out, "total", &total, allocs);
+        if (gcc.measured) print_phase_text(out, "gcc", &gcc, 0);
+        fprintf(out, "Quadruplets : %d apres l'analyse, %d apres optimisation\n",
+                r->quads_parsed, r->quads);
+        fprintf(out, "Temporaires : %d\nSymboles    : %d\n", r->temps, r->symbols);
+    }
+    if (out != stderr) fclose(out);
+}
+
+static int stop_after = STAGE_BIN;
+static int quiet = 0;      /* -q : aucun message d'etape sur stdout */
+static const char* incremental_dir = NULL;   /* --incremental : cache des objets */
+
+/* ===================== */
+/* COMPILATION INCREMENTALE */
+/* ===================== */
+
+/*
+ * Avec --incremental, le C est decoupe en unites (une par fonction,
+ * plus main) et chacune devient un objet du repertoire de cache, nomme
+ * par le hachage de son texte. Ce texte ne contient que la fonction, les
+ * signatures qu'elle appelle et les globales qu'elle lit : apres une
+ * modification, seules les unites touchees repassent par gcc -c, les
+ * autres reprennent leur objet, puis tout est relie.
+ */
+
+/* FNV-1a 64 bits */
+static unsigned long long hash_text(const char* text, size_t size) {
+    unsigned long long h = 14695981039346656037ULL;
+    for (size_t i = 0; i < size; i++) {
+        h ^= (unsigned char)text[i];
+        h *= 1099511628211ULL;
+    }
+    return h;
+}
+
+/* Lance "argv" et renvoie son pid (-1 si fork echoue) */
+static pid_t spawn(char* const argv[]) {
+    pid_t pid = fork();
+    if (pid == 0) {
+        execvp(argv[0], argv);
+        _exit(127);
+    }
+    return pid;
+}
+
+static int wait_ok(pid_t pid) {
+    int wstatus;
+    return pid > 0 && waitpid(pid, &wstatus, 0) == pid &&
+           WIFEXITED(wstatus) && WEXITSTATUS(wstatus) == 0;
+}
+
+static int build_incremental(MathLangContext* ctx, const char* bin_path) {
+    mkdir(incremental_dir, 0777);
+    int count = ctx->unit_count;
+    char** objects = (char**)calloc((size_t)count, sizeof(char*));
+    int* pending = (int*)malloc(sizeof(int) * (size_t)count);
+    int npending = 0, failed = 0;
+
+    /* Objets deja en cache ; les autres : C ecrit, a compiler */
+    for (int u = 0; u < count; u++) {
+        const CUnit* unit = &ctx->units[u];
+        if (asprintf(&objects[u], "%s/%s-%016llx.o", incremental_dir, unit->name,
+                     hash_text(unit->text, unit->size)) < 0) {
+            objects[u] = NULL;
+            failed = 1;
+            continue;
+        }
+        if (access(objects[u], R_OK) == 0) continue;
+        char* c_path = NULL;
+        if (asprintf(&c_path, "%.*s.c", (int)strlen(objects[u]) - 2, objects[u]) < 0) {
+            failed = 1;
+            continue;
+        }
+        FILE* f = fopen(c_path, "w");
+        if (!f || fwrite(unit->text, 1, unit->size, f) != unit->size) {
+            fprintf(stderr, "Erreur : impossible d'ecrire %s\n", c_path);
+            failed = 1;
+        } else {
+            pending[npending++] = u;
+        }
+        if (f) fclose(f);
+        free(c_path);
+    }
+
+    /* gcc -c sur les unites modifiees, un processus par processeur ; un
+       objet n'apparait sous son nom qu'une fois complet */
+    long ncpu = sysconf(_SC_NPROCESSORS_ONLN);
+    int slots = ncpu > 0 ? (int)ncpu : 1;
+    pid_t* pids = (pid_t*)malloc(sizeof(pid_t) * (size_t)(npending > 0 ? npending : 1));
+    char** temps = (char**)calloc((size_t)(npending > 0 ? npending : 1), sizeof(char*));
+    for (int k = 0; k < npending; k++) {
+        if (k >= slots && !wait_ok(pids[k - slots])) failed = 1;
+        const char* obj = objects[pending[k]];
+        char* c_path = NULL;
+        if (asprintf(&c_path, "%.*s.c", (int)strlen(obj) - 2, obj) < 0 ||
+            asprintf(&temps[k], "%s.%d.tmp", obj, (int)getpid()) < 0) {
+            free(c_path);
+            temps[k] = NULL;
+            pids[k] = -1;
+            continue;
+        }
+        char* argv[] = { "gcc", "-c", c_path, "-o", temps[k], NULL };
+        pids[k] = spawn(argv);
+        free(c_path);
+    }
+    for (int k = 0; k < npending; k++) {
+        if (k >= npending - slots && !wait_ok(pids[k])) failed = 1;
+    }
+    for (int k = 0; k < npending; k++) {
+        if (temps[k] && !failed && rename(temps[k], objects[pending[k]]) != 0) failed = 1;
+        if (temps[k]) remove(temps[k]);
+        free(temps[k]);
+    }
+
+    /* Edition de liens de tous les objets */
+    if (!failed) {
+        char** argv = (char**)malloc(sizeof(char*) * (size_t)(count + 5));
+        int n = 0;
+        argv[n++] = "gcc";
+        for (int u = 0; u < count; u++) argv[n++] = objects[u];
+        argv[n++] = "-lm";
+        argv[n++] = "-o";
+        argv[n++] = (char*)bin_path;
+        argv[n] = NULL;
+        if (!wait_ok(spawn(argv))) failed = 1;
+        free(argv);
+    }
+    if (failed) {
+        fprintf(stderr, "Erreur : la compilation incrementale dans %s a echoue\n", incremental_dir);
+    } else if (!quiet) {
+        printf("Incremental : %d unite(s), %d reprise(s) du cache, %d compilee(s)\n",
+               count, count - npending, npending);
+    }
+
+    for (int u = 0; u < count; u++) free(objects[u]);
+    free(objects);
+    free(pending);
+    free(pids);
+    free(temps);
+    ml_free_units(ctx);
+    return failed ? 1 : 0;
+}
+
+/* 1 si "output" designe le fichier "source" (meme chemin, ou meme
+   inode quand la sortie existe deja) : l'ecrire detruirait le source */
+static int same_file(const char* source, const char* output) {
+    struct stat a, b;
+    if (strcmp(source, output) == 0) return 1;
+    return stat(source, &a) == 0 && stat(output, &b) == 0 &&
+           a.st_dev == b.st_dev && a.st_ino == b.st_ino;
+}
+
+/* Compile une source avec les sorties demandees ; c_default et
+   bin_default nomment le C et l'executable sans chemin explicite.
+   Renvoie le code de sortie du processus. */
+static int compile_one(MathLangContext* ctx, const char* source_path,
+                       const char* c_default, const char* bin_default) {
+    MlOptions* o = &ctx->options;
+    o->stop_after = stop_after < STAGE_C ? (MlStage)stop_after : ML_STAGE_C;
+    o->tokens_out = emit_stream(EMIT_TOKENS);
+    o->symbols_out = emit_stream(EMIT_SYMBOLS);
+    o->quads_out = emit_stream(EMIT_QUADS);
+    o->opt.report = emit_stream(EMIT_REPORT);
+    o->c_out = NULL;
+    o->split_units = incremental_dir != NULL && emits[EMIT_BIN].requested;
+
+    /* Le C va dans son fichier, ou dans un fichier temporaire quand seul
+       l'executable est demande */
+    int want_c = emits[EMIT_C].requested, want_bin = emits[EMIT_BIN].requested;
+    char temp_c[] = "/tmp/mathlang_XXXXXX.c";
+    const char* c_path = emits[EMIT_C].path ? emits[EMIT_C].path : c_default;
+    const char* bin_path = emits[EMIT_BIN].path ? emits[EMIT_BIN].path : bin_default;
+    if ((want_c && same_file(source_path, c_path)) || (want_bin && same_file(source_path, bin_path))) {
+        fprintf(stderr, "Erreur : la sortie %s ecraserait le source\n",
+                want_c && same_file(source_path, c_path) ? c_path : bin_path);
+        emit_close_all();
+        return 1;
+    }
+    if (want_c) {
+        o->c_out = fopen(c_path, "w");
+    } else if (want_bin && !o->split_units) {
+        int fd = mkstemps(temp_c, 2);
+        c_path = temp_c;
+        if (fd >= 0) o->c_out = fdopen(fd, "w");
+    }
+    if ((want_c || (want_bin && !o->split_units)) && !o->c_out) {
+        fprintf(stderr, "Erreur : impossible d'ecrire %s\n", c_path);
+        emit_close_all();
+        return 1;
+    }
+
+    int status = ml_compile_file(ctx, source_path);
+    if (o->c_out) fclose(o->c_out);
+    if (status < 0) {
+        if (o->c_out) remove(c_path);
+        emit_close_all();
+        return 1;
+    }
+
+    if (stop_after >= STAGE_PARSE && !ctx->syntax_ok) {
+        fprintf(stderr, "Analyse syntaxique échouée. Génération C annulée.\n");
+        if (o->c_out) remove(c_path);
+        emit_close_all();
+        return 1;
+    }
+    if (ctx->syntax_ok && !quiet) printf("Analyse syntaxique réussie\n");
+
+    int exit_status = 0;
+    if (ctx->semantic_errors > 0) {
+        if (o->c_out) remove(c_path);
+        printf("\n%d erreur(s) semantique(s) detectee(s) : generation de code annulee.\n",
+               ctx->semantic_errors);
+        exit_status = 1;
+    } else if (ctx->c_generated) {
+        if (want_c && !quiet) printf("\nCode C genere avec succes : %s\n", c_path);
+        double gcc_wall = monotonic_seconds(), gcc_cpu = children_cpu_seconds();
+        if (want_bin && o->split_units) {
+            exit_status = build_incremental(ctx, bin_path);
+            if (exit_status == 0 && !quiet) printf("Executable genere : %s\n", bin_path);
+        } else if (want_bin) {
+            /* Sans shell : un chemin contenant " ou $ reste un chemin */
+            char* const argv[] = { "gcc", (char*)c_path, "-lm", "-o", (char*)bin_path, NULL };
+            if (!wait_ok(spawn(argv))) {
+                fprintf(stderr, "Erreur : la compilation de %s par gcc a echoue\n", c_path);
+                exit_status = 1;
+            } else if (!quiet) {
+                printf("Executable genere : %s\n", bin_path);
+            }
+        }
+        if (want_bin) {
+            gcc_time.measured = 1;
+            gcc_time.wall = monotonic_seconds() - gcc_wall;
+            gcc_time.cpu = children_cpu_seconds() - gcc_cpu;
+        }
+        if (!want_c && o->c_out) remove(temp_c);
+    }
+
+    emit_close_all();
+    return exit_status;
+}
+
+/* ===================== */
+/* MODE LOT              */
+/* ===================== */
+
+/* Sortie d'une source en mode lot : "dir/a.ml" donne "dir/a" + suffixe,
+   ou "out/a" + suffixe avec -o out (repertoire). Une source sans
+   extension garderait son propre nom pour l'executable : il prend
+   alors le suffixe ".out". */
+static char* batch_output(const char* source, const char* out_dir, const char* suffix) {
+    const char* base = strrchr(source, '/');
+    base = base ? base + 1 : source;
+    size_t stem = strlen(source);
+    const char* dot = strrchr(base, '.');
+    if (dot && dot != base) stem = (size_t)(dot - source);
+    else if (!*suffix) suffix = ".out";
+    size_t base_off = (size_t)(base - source);
+
+    size_t len = (out_dir ? strlen(out_dir) + 1 : 0) + stem + strlen(suffix) + 1;
+    char* path = (char*)malloc(len);
+    if (out_dir) {
+        snprintf(path, len, "%s/%.*s%s", out_dir, (int)(stem - base_off), base, suffix);
+    } else {
+        snprintf(path, len, "%.*s%s", (int)stem, source, suffix);
+    }
+    return path;
+}
+
+/* Avec -o dir, deux sources de meme nom (a/x.ml, b/x.ml) ecriraient
+   les memes fichiers : la premiere collision est signalee */
+static int batch_outputs_clash(const char** sources, int count, const char* out_dir) {
+    if (!out_dir) return 0;
+    char** paths = (char**)malloc(sizeof(char*) * (size_t)count);
+    int built = 0, clash = 0;
+    while (built < count && !clash) {
+        char* path = batch_output(sources[built], out_dir, "");
+        for (int j = 0; j < built && !clash; j++) {
+            if (strcmp(path, paths[j]) == 0) {
+                fprintf(stderr, "Erreur : %s et %s produiraient tous deux %s\n",
+                        sources[j], sources[built], path);
+                clash = 1;
+            }
+        }
+        paths[built++] = path;
+    }
+    for (int i = 0; i < built; i++) free(paths[i]);
+    free(paths);
+    return clash;
+}
+
+typedef struct {
+    const char* source;
+    int capture;        /* stdout + stderr du processus, fichier anonyme */
+    pid_t pid;
+    int status;
+    int done;
+} BatchJob;
+
+/* Processus fils : compile jobs[i], sorties redirigees vers sa capture */
+static void run_batch_job(MathLangContext* ctx, const BatchJob* job, const char* out_dir) {
+    dup2(job->capture, STDOUT_FILENO);
+    dup2(job->capture, STDERR_FILENO);
+    char* c_path = batch_output(job->source, out_dir, ".c");
+    char* bin_path = batch_output(job->source, out_dir, "");
+    int status = compile_one(ctx, job->source, c_path, bin_path);
+    print_time_report(job->source);
+    fflush(stdout);
+    fflush(stderr);
+    _exit(status);
+}
+
+static void print_capture(const BatchJob* job) {
+    char buffer[8192];
+    ssize_t n;
+    printf("=== %s ===\n", job->source);
+    fflush(stdout);
+    lseek(job->capture, 0, SEEK_SET);
+    while ((n = read(job->capture, buffer, sizeof(buffer))) > 0) {
+        fwrite(buffer, 1, (size_t)n, stdout);
+    }
+    fflush(stdout);
+    close(job->capture);
+}
+
+/* Compile les sources avec au plus "jobs" processus ; les sorties de
+   chaque source sont rendues dans l'ordre de la ligne de commande */
+static int run_batch(MathLangContext* ctx, const char** sources, int count,
+                     int jobs, const char* out_dir) {
+    struct timespec t0, t1;
+    clock_gettime(CLOCK_MONOTONIC, &t0);
+    BatchJob* batch = (BatchJob*)calloc((size_t)count, sizeof(BatchJob));
+    int next = 0, running = 0, printed = 0, failures = 0;
+
+    fflush(stdout);
+    fflush(stderr);
+    while (printed < count) {
+        while (running < jobs && next < count) {
+            BatchJob* job = &batch[next];
+            char capture_path[] = "/tmp/mathlang_lot_XXXXXX";
+            job->source = sources[next++];
+            job->capture = mkstemp(capture_path);
+            if (job->capture >= 0) unlink(capture_path);
+            job->pid = job->capture >= 0 ? fork() : -1;
+            if (job->pid == 0) run_batch_job(ctx, job, out_dir);
+            if (job->pid < 0) {
+                fprintf(stderr, "Erreur : impossible de lancer la compilation de %s\n", job->source);
+                job->status = 1;
+                job->done = 1;
+            } else {
+                running++;
+            }
+        }
+
+        /* Rend les resultats termines, dans l'ordre */
+        while (printed < next && batch[printed].done) {
+            BatchJob* job = &batch[printed++];
+            if (job->status != 0) failures++;
+            if (job->capture >= 0) print_capture(job);
+        }
+        if (running == 0) continue;
+
+        int wstatus;
+        pid_t pid = wait(&wstatus);
+        if (pid < 0 && errno == EINTR) continue;
+        if (pid < 0) {
+            /* Plus rien a attendre : les compilations en cours sont perdues */
+            perror("wait");
+            for (int i = 0; i < next; i++) {
+                if (!batch[i].done) {
+                    batch[i].status = 1;
+                    batch[i].done = 1;
+                }
+            }
+            running = 0;
+            continue;
+        }
+        for (int i = 0; i < next; i++) {
+            if (batch[i].pid == pid && !batch[i].done) {
+                batch[i].status = WIFEXITED(wstatus) ? WEXITSTATUS(wstatus) : 1;
+                batch[i].done = 1;
+                running--;
+                break;
+            }
+        }
+    }
+
+    clock_gettime(CLOCK_MONOTONIC, &t1);
+    double seconds = (t1.tv_sec - t0.tv_sec) + (t1.tv_nsec - t0.tv_nsec) / 1e9;
+    if (!quiet) {
+        printf("\nLot : %d source(s), %d echec(s), -j %d, %.3f s\n",
+               count, failures, jobs, seconds);
+    }
+    free(batch);
+    return failures > 0 ? 1 : 0;
+}
+
+int main(int argc, char **argv) {
+    MathLangContext ctx;
+    ml_context_init(&ctx);
+    MlOptions* o = &ctx.options;
+
+    /* Options : niveau d'optimisation, sorties, puis les fichiers source */
+    const char** sources = (const char**)malloc(sizeof(char*) * (size_t)argc);
+    int source_count = 0;
+    const char* output_path = NULL;   /* -o : executable, C sans bin, repertoire en lot */
+    int jobs = 0;          /* -j N : processus du mode lot */
+    int emit_given = 0;
+    int bench_lex = 0;     /* --bench-lex : debit du scanner, puis arret */
+    const char* server_path = NULL;   /* --server : socket du serveur de compilation */
+    int bad_option = 0;
+    for (int i = 1; i < argc && !bad_option; i++) {
+        int known = ml_parse_option(o, argv[i]);
+        if (known > 0) {
+            continue;
+        } else if (known < 0) {
+            fprintf(stderr, "Valeur invalide : %s (--unroll=0..%d, --memo-capacity=1..%d)\n",
+                    argv[i], OPT_MAX_UNROLL_FACTOR, MEMO_MAX_CAPACITY);
+            bad_option = 1;
+        } else if (strcmp(argv[i], "--bench-lex") == 0) {
+            bench_lex = 1;
+        } else if (strncmp(argv[i], "--emit=", 7) == 0) {
+            emit_given = 1;
+            if (parse_emit_list(argv[i] + 7) != 0) bad_option = 1;
+        } else if (strncmp(argv[i], "--stop-after=", 13) == 0) {
+            stop_after = parse_stage(argv[i] + 13);
+            if (stop_after < 0) {
+                fprintf(stderr, "Etape inconnue pour --stop-after : %s (lex, parse, opt, c, bin)\n",
+                        argv[i] + 13);
+                bad_option = 1;
+            }
+        } else if (strcmp(argv[i], "-o") == 0) {
+            if (i + 1 < argc) {
+                output_path = argv[++i];
+            } else {
+                fprintf(stderr, "Option -o : chemin manquant\n");
+                bad_option = 1;
+            }
+        } else if (strcmp(argv[i], "--server") == 0) {
+            if (i + 1 < argc) {
+                server_path = argv[++i];
+            } else {
+                fprintf(stderr, "Option --server : chemin de socket manquant\n");
+                bad_option = 1;
+            }
+        } else if (strcmp(argv[i], "--incremental") == 0) {
+            incremental_dir = ".mlcache";
+        } else if (strncmp(argv[i], "--incremental=", 14) == 0) {
+            incremental_dir = argv[i] + 14;
+        } else if (strncmp(argv[i], "--time-report", 13) == 0) {
+            if (parse_time_report(argv[i] + 13) != 0) {
+                fprintf(stderr, "Format inconnu pour --time-report : %s (texte, json)\n", argv[i] + 13);
+                bad_option = 1;
+            }
+        } else if (strcmp(argv[i], "-q") == 0) {
+            quiet = 1;
+        } else if (strncmp(argv[i], "-j", 2) == 0) {
+            const char* n = argv[i][2] ? argv[i] + 2 : (i + 1 < argc ? argv[++i] : "");
+            jobs = atoi(n);
+            if (jobs < 1) {
+                fprintf(stderr, "Option -j : nombre de processus attendu\n");
+                bad_option = 1;
+            }
+        } else if (argv[i][0] == '-') {
+            fprintf(stderr, "Option inconnue : %s\n", argv[i]);
+            bad_option = 1;
+        } else {
+            sources[source_count++] = argv[i];
+        }
+    }
+
+    if (server_path && !bad_option) {
+        free(sources);
+        free(emit_spec);
+        return ml_server_run(server_path, quiet);
+    }
+
+    if (source_count == 0 || bad_option) {
+        if (!bad_option) {
+            fprintf(stderr, "Usage : %s [-O0|-O1] [-fno-strength-reduce] [-fno-const-calls] [-fno-specialize] [-fno-tail-calls] [-fno-inline] [-fno-unroll] [--unroll=N] [--memo-capacity=N] [--emit=tokens|symbols|quads|report|c|bin[:fichier],...] [--stop-after=lex|parse|opt|c|bin] [-o chemin] [-q] [-j N] [--incremental[=rep]] [--no-mmap] [--no-line-directives] [--profile] [--bench-lex] [--time-report[=texte|json][:fichier]] <fichier>...\n"
+                            "       %s --server <socket> [-q]\n", argv[0], argv[0]);
+        }
+        free(sources);
+        free(emit_spec);
+        return 1;
+    }
+
+    if (ctx.options.profile && incremental_dir) {
+        fprintf(stderr, "--profile et --incremental sont incompatibles : les unites en cache ne sont pas instrumentees\n");
+        free(sources);
+        free(emit_spec);
+        return 1;
+    }
+
+    if (bench_lex) {
+        int status = bench_lexer(&ctx, sources[0]);
+        free(sources);
+        free(emit_spec);
+        return status;
+    }
+
+    /* Mode lot : plusieurs sources ou -j. Chaque source a ses propres
+       sorties (a.ml -> a.c, a) ; un vidage vers un fichier nomme serait
+       ecrase par chaque source. */
+    int batch = source_count > 1 || jobs > 0;
+    if (batch) {
+        if (time_report_path) {
+            fprintf(stderr, "--time-report=...:%s : un seul fichier pour plusieurs sources\n",
+                    time_report_path);
+            free(sources);
+            free(emit_spec);
+            return 1;
+        }
+        for (int k = 0; k < EMIT_COUNT; k++) {
+            if (emits[k].requested && emits[k].path) {
+                fprintf(stderr, "--emit=%s:%s : un seul fichier pour plusieurs sources\n",
+                        emit_names[k], emits[k].path);
+                free(sources);
+                free(emit_spec);
+                return 1;
+            }
+        }
+    }
+
+    /* Sans --emit : le C (output.c) et l'executable (output). Une sortie
+       situee apres --stop-after n'est pas produite. */
+    if (!emit_given) {
+        emits[EMIT_C].requested = 1;
+        emits[EMIT_BIN].requested = 1;
+    }
+    if (stop_after < STAGE_PARSE) {
+        emits[EMIT_SYMBOLS].requested = emits[EMIT_QUADS].requested = 0;
+    }
+    if (stop_after < STAGE_OPT) emits[EMIT_REPORT].requested = 0;
+    if (stop_after < STAGE_C) emits[EMIT_C].requested = 0;
+    if (stop_after < STAGE_BIN) emits[EMIT_BIN].requested = 0;
+    if (output_path && !batch) {
+        EmitKind target = emits[EMIT_BIN].requested ? EMIT_BIN : EMIT_C;
+        if (!emits[target].requested) {
+            fprintf(stderr, "Option -o ignoree : ni c ni bin n'est produit\n");
+        } else if (!emits[target].path) {
+            emits[target].path = output_path;
+        }
+    }
+    if (time_report_json >= 0) {
+#ifdef __GLIBC__
+        alloc_counting = 1;
+        time_report.alloc_counters = read_alloc_counters;
+#endif
+        o->time_report = &time_report;
+    }
+    int status;
+    if (batch && batch_outputs_clash(sources, source_count, output_path)) {
+        status = 1;
+    } else if (batch) {
+        status = run_batch(&ctx, sources, source_count, jobs > 0 ? jobs : 1, output_path);
+    } else {
+        status = compile_one(&ctx, sources[0], "output.c", "output");
+        print_time_report(sources[0]);
+    }
+    free(sources);
+    free(emit_spec);
+    return status;
+}
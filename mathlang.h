@@ -0,0 +1,95 @@
+#ifndef MATHLANG_H
+#define MATHLANG_H
+
+#include <stdio.h>
+#include <stddef.h>
+#include "optimizer.h"
+#include "codegen_c.h"
+
+/* ========================================================= */
+/*  BIBLIOTHEQUE DE COMPILATION (libmathlang.a)               */
+/* ========================================================= */
+/*
+ * Compile un programme MathLang jusqu'au C, dans le processus appelant.
+ * L'etat du compilateur (tables, compteurs, piles de controle, tampon
+ * de tokens) est local au thread, le parseur est pur et le scanner
+ * reentrant : plusieurs threads peuvent compiler en parallele, chacun
+ * avec son contexte. Un contexte ne sert qu'a une compilation a la fois.
+ */
+
+typedef enum {
+    ML_STAGE_LEX,       /* analyse lexicale seule */
+    ML_STAGE_PARSE,     /* + analyse syntaxique et semantique */
+    ML_STAGE_OPT,       /* + optimisations */
+    ML_STAGE_C          /* + generation du C */
+} MlStage;
+
+/* --time-report : mesures d'une phase (ML_STAGE_LEX .. ML_STAGE_C) */
+typedef struct {
+    int measured;           /* phase executee */
+    double wall;            /* secondes, horloge monotone */
+    double cpu;             /* secondes de CPU du thread */
+    long allocations;       /* malloc/calloc/realloc pendant la phase */
+    long bytes;             /* octets demandes */
+} MlPhaseStats;
+
+typedef struct {
+    MlPhaseStats phases[ML_STAGE_C + 1];
+    int quads_parsed;       /* quadruplets produits par l'analyse */
+    int quads;              /* apres optimisation */
+    int temps;              /* temporaires crees par newTemp */
+    int symbols;            /* declarations de la table des symboles */
+    /* Compteurs d'allocations du processus, fournis par l'appelant
+       (NULL : allocations non comptees) */
+    void (*alloc_counters)(long* allocations, long* bytes);
+} MlTimeReport;
+
+typedef struct {
+    OptOptions opt;         /* opt.report : rapport des optimisations */
+    MlStage stop_after;
+    int use_mmap;           /* ml_compile_file : source projete en memoire */
+    int memo_capacity;      /* entrees du cache des fonctions MEMOISER */
+    int profile;            /* C instrumente (--profile), hors split_units */
+    int line_directives;    /* ml_compile_file : #line vers le source dans
+                               le C (--no-line-directives : aucune) */
+    FILE* tokens_out;       /* vidages (NULL : aucun) */
+    FILE* symbols_out;
+    FILE* quads_out;
+    FILE* c_out;            /* C genere (NULL : pas de C) */
+    int split_units;        /* C aussi decoupe en unites (ctx->units) */
+    FILE* diagnostics;      /* erreurs et avertissements (NULL : stderr) */
+    MlTimeReport* time_report;  /* mesures par phase, remises a zero a
+                                   chaque compilation (NULL : aucune) */
+} MlOptions;
+
+typedef struct {
+    MlOptions options;
+
+    /* Resultat de la derniere compilation */
+    int syntax_ok;
+    int semantic_errors;
+    int c_generated;
+    long token_count;
+    long source_bytes;
+    const char* input_mode;     /* "mmap", "tampon", "stdio" ou "memoire" */
+    CUnit* units;               /* options.split_units : une unite par fonction, puis main */
+    int unit_count;
+} MathLangContext;
+
+/* Options par defaut : -O1, pas de vidage ni de C, arret apres le C */
+void ml_context_init(MathLangContext* ctx);
+
+/* Option de compilation de la ligne de commande (-O0, -fno-inline,
+   --unroll=N, --memo-capacity=N, --no-mmap...) : 1 si reconnue, 0 si
+   inconnue, -1 si sa valeur est invalide (N hors limites ou non entier) */
+int ml_parse_option(MlOptions* o, const char* arg);
+
+/* 0 : programme correct (C ecrit dans options.c_out s'il est demande),
+   1 : erreurs de syntaxe ou semantiques, -1 : source illisible */
+int ml_compile_file(MathLangContext* ctx, const char* path);
+int ml_compile_string(MathLangContext* ctx, const char* source, size_t size);
+
+/* Libere ctx->units (fait aussi par la compilation suivante) */
+void ml_free_units(MathLangContext* ctx);
+
+#endif
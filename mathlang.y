@@ -2,29 +2,34 @@
 #include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
+#include <errno.h>
+#include <time.h>
 #include "symbol_table.h"
 #include "quadruplet.h"
 #include "expr_info.h"
 #include "codegen_c.h"
 #include "function_table.h"
+#include "loop_table.h"
+#include "optimizer.h"
+#include "source_input.h"
+#include "mathlang.h"
 
-extern int yylex();
-extern int line_num;
-extern int col_num;
-extern FILE *yyin;
+extern _Thread_local int line_num;
+extern _Thread_local int col_num;
 
-void yyerror(const char *s);
 const char* token_name(int tok);
 
-/* Table des symboles globale */
-SymbolTable* global_symbol_table = NULL;
-QuadList* quadList = NULL;
+/* Etat de la compilation en cours. Comme les tables de fonctions et de
+   boucles, il est propre au thread : chaque thread peut compiler son
+   programme (ml_compile_file / ml_compile_string) sans verrou. */
+_Thread_local SymbolTable* global_symbol_table = NULL;
+_Thread_local QuadList* quadList = NULL;
 
 #define MAX_FUNCTION_CONTEXT 64
-static DataType function_return_stack[MAX_FUNCTION_CONTEXT];
-static int function_kind_stack[MAX_FUNCTION_CONTEXT];
-static int function_return_seen_stack[MAX_FUNCTION_CONTEXT];
-static int function_context_top = -1;
+static _Thread_local DataType function_return_stack[MAX_FUNCTION_CONTEXT];
+static _Thread_local int function_kind_stack[MAX_FUNCTION_CONTEXT];
+static _Thread_local int function_return_seen_stack[MAX_FUNCTION_CONTEXT];
+static _Thread_local int function_context_top = -1;
 
 static void push_function_context(int kind) {
     if (function_context_top + 1 >= MAX_FUNCTION_CONTEXT) return;
@@ -64,10 +69,20 @@ static void pop_function_context(void) {
     }
 }
 
+/* Annotation MEMOISER en attente : ligne du mot-cle, 0 si aucune */
+static _Thread_local int pending_memoize_line = 0;
+
+static void apply_pending_memoize(void) {
+    if (pending_memoize_line > 0) {
+        ft_set_memoize(pending_memoize_line);
+        pending_memoize_line = 0;
+    }
+}
+
 #define MAX_CALL_CONTEXT 64
-static FunctionInfo* call_context_stack[MAX_CALL_CONTEXT];
-static int call_arg_index_stack[MAX_CALL_CONTEXT];
-static int call_context_top = -1;
+static _Thread_local FunctionInfo* call_context_stack[MAX_CALL_CONTEXT];
+static _Thread_local int call_arg_index_stack[MAX_CALL_CONTEXT];
+static _Thread_local int call_context_top = -1;
 
 static void push_call_context(FunctionInfo* fi) {
     if (call_context_top + 1 >= MAX_CALL_CONTEXT) return;
@@ -88,6 +103,39 @@ static void pop_call_context(void) {
     if (call_context_top >= 0) call_context_top--;
 }
 
+/* Arguments des appels en cours d'analyse. Les PARAM d'un appel sont
+   emis juste avant son CALL, une fois tous ses arguments evalues : ceux
+   d'un appel en argument, f(a, g(b)), ne s'intercalent pas entre eux. */
+static _Thread_local char** pending_args = NULL;
+static _Thread_local int pending_arg_count = 0, pending_arg_capacity = 0;
+
+static void push_pending_arg(char* addr) {
+    if (pending_arg_count >= pending_arg_capacity) {
+        pending_arg_capacity = pending_arg_capacity ? pending_arg_capacity * 2 : 16;
+        pending_args = (char**)realloc(pending_args, sizeof(char*) * pending_arg_capacity);
+        if (!pending_args) {
+            perror("realloc pending_args");
+            exit(EXIT_FAILURE);
+        }
+    }
+    pending_args[pending_arg_count++] = addr;
+}
+
+static void emit_pending_params(int arg_count) {
+    int first = pending_arg_count - arg_count;
+    if (first < 0) first = 0;
+    for (int k = first; k < pending_arg_count; k++) {
+        createQuad(quadList, QUAD_PARAM, pending_args[k], NULL, NULL);
+        free(pending_args[k]);
+    }
+    pending_arg_count = first;
+}
+
+static void clear_pending_args(void) {
+    for (int k = 0; k < pending_arg_count; k++) free(pending_args[k]);
+    pending_arg_count = 0;
+}
+
 
 char* expr_to_addr(ExprInfo e) {
     // Si c'est une comparaison qui n'a pas encore généré son temporaire
@@ -109,7 +157,7 @@ char* expr_to_addr(ExprInfo e) {
     }
     
     if (!e.addr) {
-        fprintf(stderr, "Erreur: expr_to_addr appelé avec e.addr == NULL\n");
+        fprintf(diagnostic_stream(), "Erreur: expr_to_addr appelé avec e.addr == NULL\n");
         return strdup("0");  // Retourner une valeur par défaut au lieu de NULL
     }
     
@@ -120,7 +168,7 @@ char* expr_to_addr(ExprInfo e) {
 }
 
 /* Emet le(s) quadruplet(s) d'appel pour "name", une fois les arguments
- * empiles via QUAD_PARAM. Retourne l'adresse du resultat (temporaire, a
+ * empiles par push_pending_arg. Retourne l'adresse du resultat (temporaire, a
  * liberer par l'appelant) si c'est une fonction, NULL sinon (procedure,
  * ou erreur). *out_type recoit le type de retour (TYPE_ERROR si erreur).
  * *out_error vaut 1 si le symbole n'est pas une fonction/procedure connue.
@@ -130,6 +178,7 @@ static char* finish_call(const char* name, int arg_count, DataType* out_type, in
     SymbolEntry* fn = global_symbol_table ? find_symbol(global_symbol_table, name) : NULL;
     char argcount_str[16];
     sprintf(argcount_str, "%d", arg_count);
+    emit_pending_params(arg_count);
 
     *out_error = 0;
     if (out_type) *out_type = TYPE_ERROR;
@@ -169,15 +218,14 @@ int generate_inverse_branch(QuadList* list, ExprInfo cond) {
             case CMP_GEQ: branch_op = QUAD_BL; break;   // si <, sauter
             default: branch_op = QUAD_BZ; break;
         }
-        createQuad(list, branch_op, cond.cmp_left, cond.cmp_right, "");
-        return nextQuad(list) - 1;
+        return createBranch(list, branch_op, cond.cmp_left, cond.cmp_right, -1);
     } else {
         // Pas une comparaison simple : utiliser BZ classique
         char* addr = expr_to_addr(cond);
         // Standard layout: condition in arg1, arg2 unused
-        createQuad(list, QUAD_BZ, addr, NULL, "");
+        int index = createBranch(list, QUAD_BZ, addr, NULL, -1);
         free(addr);
-        return nextQuad(list) - 1;
+        return index;
     }
 }
 
@@ -190,6 +238,24 @@ typedef struct YYLTYPE {
 
 #define YYLTYPE_IS_DECLARED 1
 #define YYLTYPE_IS_TRIVIAL 1
+
+/* Position d'une regle (calcul par defaut de bison), donnee aussi aux
+   quadruplets que son action va creer : #line du C genere */
+#define YYLLOC_DEFAULT(Current, Rhs, N)                                   \
+    do {                                                                  \
+        if (N) {                                                          \
+            (Current).first_line = YYRHSLOC(Rhs, 1).first_line;           \
+            (Current).first_column = YYRHSLOC(Rhs, 1).first_column;       \
+            (Current).last_line = YYRHSLOC(Rhs, N).last_line;             \
+            (Current).last_column = YYRHSLOC(Rhs, N).last_column;         \
+        } else {                                                          \
+            (Current).first_line = (Current).last_line =                  \
+                YYRHSLOC(Rhs, 0).last_line;                               \
+            (Current).first_column = (Current).last_column =              \
+                YYRHSLOC(Rhs, 0).last_column;                             \
+        }                                                                 \
+        setSourcePosition((Current).first_line, (Current).first_column);  \
+    } while (0)
 %}
 
 /* ===================== */
@@ -206,8 +272,26 @@ typedef struct YYLTYPE {
 }
 
 %locations
+%define api.pure full
 %expect 1
 
+%code {
+/* Parseur pur : yylex et yyerror recoivent valeur et position du token */
+int yylex(YYSTYPE* lval, YYLTYPE* lloc);
+void yyerror(YYLTYPE* lloc, const char* s);
+
+/* Scanner reentrant (lex.yy.c, %option reentrant bison-bridge) */
+typedef void* yyscan_t;
+typedef struct yy_buffer_state* YY_BUFFER_STATE;
+int scan_token(YYSTYPE* lval, YYLTYPE* lloc, yyscan_t scanner);
+int yylex_init(yyscan_t* scanner);
+int yylex_destroy(yyscan_t scanner);
+void yyset_in(FILE* in, yyscan_t scanner);
+YY_BUFFER_STATE yy_scan_buffer(char* base, size_t size, yyscan_t scanner);
+YY_BUFFER_STATE yy_scan_bytes(const char* bytes, int len, yyscan_t scanner);
+void yy_delete_buffer(YY_BUFFER_STATE buffer, yyscan_t scanner);
+}
+
 /* ===================== */
 /* TOKENS AVEC VALEURS   */
 /* ===================== */
@@ -225,7 +309,7 @@ typedef struct YYLTYPE {
 %token TOK_POUR TOK_DE TOK_PAR TOK_A TOK_REPETER TOK_JUSQUA
 %token TOK_SORTIR TOK_CONTINUER
 %token TOK_AFFICHER TOK_AFFICHER_LIGNE TOK_LIRE
-%token TOK_FONCTION TOK_PROCEDURE TOK_RETOURNER TOK_LAMBDA
+%token TOK_FONCTION TOK_PROCEDURE TOK_RETOURNER TOK_LAMBDA TOK_MEMOISER
 
 /* ===================== */
 /* BOOLÉENS / LOGIQUE    */
@@ -317,6 +401,11 @@ declaration
     | declaration_type
     | declaration_fonction
     | declaration_procedure
+    | TOK_MEMOISER { pending_memoize_line = @1.first_line; } declaration_fonction
+    | TOK_MEMOISER declaration_procedure {
+        semantic_warning("MEMOISER ignore : une procedure ne retourne pas de valeur",
+                         @1.first_line, @1.first_column);
+    }
     | instruction
     ;
 
@@ -437,7 +526,8 @@ declaration_fonction
             enter_scope(global_symbol_table);
         }
         push_function_context(SYMBOL_FUNCTION);
-        ft_begin($2, 1);
+        ft_begin($2, 1, @1.first_line);
+        apply_pending_memoize();
     } TOK_RPAREN TOK_COLON type {
         set_function_return_type($7);
         ft_set_return_type($7);
@@ -458,7 +548,8 @@ declaration_fonction
             enter_scope(global_symbol_table);
         }
         push_function_context(SYMBOL_FUNCTION);
-        ft_begin($2, 1);
+        ft_begin($2, 1, @1.first_line);
+        apply_pending_memoize();
     } parametres TOK_RPAREN TOK_COLON type {
         set_function_return_type($8);
         ft_set_return_type($8);
@@ -482,7 +573,7 @@ declaration_procedure
             enter_scope(global_symbol_table);
         }
         push_function_context(SYMBOL_PROCEDURE);
-        ft_begin($2, 0);
+        ft_begin($2, 0, @1.first_line);
         ft_set_return_type(TYPE_VOID);
         ft_set_quad_start(nextQuad(quadList));
     } TOK_RPAREN bloc TOK_FIN {
@@ -498,7 +589,7 @@ declaration_procedure
             enter_scope(global_symbol_table);
         }
         push_function_context(SYMBOL_PROCEDURE);
-        ft_begin($2, 0);
+        ft_begin($2, 0, @1.first_line);
         ft_set_return_type(TYPE_VOID);
     } parametres TOK_RPAREN {
         ft_set_quad_start(nextQuad(quadList));
@@ -523,7 +614,11 @@ parametre
             SymbolEntry* entry = find_symbol(global_symbol_table, $1);
             if (entry) mark_symbol_initialized(entry);
         }
-        ft_add_param($3, $1);
+        if (!ft_add_param($3, $1)) {
+            char msg[96];
+            snprintf(msg, sizeof(msg), "Trop de parametres (au plus %d)", FT_MAX_PARAMS);
+            semantic_error(msg, @1.first_line, @1.first_column);
+        }
         if ($1) { free($1); }
     }
     ;
@@ -565,36 +660,26 @@ instruction
         if ($2.addr) { free($2.addr); $2.addr = NULL; }
     }
  | TOK_SORTIR {
-    createQuad(quadList, QUAD_BR, NULL, NULL, "");
-    int br_index = nextQuad(quadList) - 1;
-    if (!isIntStackEmpty(&whileStartStack)) {
-        pushInt(&whileBreakStack, br_index);
-    } else if (!isIntStackEmpty(&forStartStack)) {
-        pushInt(&forBreakStack, br_index);
-    } else if (!isIntStackEmpty(&repeatStartStack)) {
-        pushInt(&repeatBreakStack, br_index);
-    }
-
+        // SORTIR : saut vers la sortie de la boucle la plus interne
+        LoopContext* loop = currentLoop();
+        if (!loop) {
+            semantic_error("SORTIR hors boucle", @1.first_line, @1.first_column);
+        } else {
+            int br_index = createBranch(quadList, QUAD_BR, NULL, NULL, -1);
+            loop->break_list = mergeJumpLists(quadList, loop->break_list,
+                                              makeJumpList(quadList, br_index));
+        }
     }
     | TOK_CONTINUER {
-        // CONTINUE : revenir au début de la boucle
-        // Générer un BR vers le début de la boucle
-        if (!isIntStackEmpty(&whileStartStack)) {
-            // Dans une boucle WHILE
-            int start_index = peekInt(&whileStartStack);
-            char start_addr[16];
-            sprintf(start_addr, "%d", start_index);
-            createQuad(quadList, QUAD_BR, NULL, NULL, start_addr);
-        } else if (!isIntStackEmpty(&forStartStack)) {
-            // Dans une boucle FOR : empiler dans forContinueStack
-            createQuad(quadList, QUAD_BR, NULL, NULL, "");
-            pushInt(&forContinueStack, nextQuad(quadList) - 1);
-        } else if (!isIntStackEmpty(&repeatStartStack)) {
-            // Dans une boucle REPEAT
-            int start_index = peekInt(&repeatStartStack);
-            char start_addr[16];
-            sprintf(start_addr, "%d", start_index);
-            createQuad(quadList, QUAD_BR, NULL, NULL, start_addr);
+        // CONTINUER : début de la boucle (TANT QUE, REPETER) ou
+        // incrémentation (POUR), complétée à la fin du corps
+        LoopContext* loop = currentLoop();
+        if (!loop) {
+            semantic_error("CONTINUER hors boucle", @1.first_line, @1.first_column);
+        } else {
+            int br_index = createBranch(quadList, QUAD_BR, NULL, NULL, -1);
+            loop->continue_list = mergeJumpLists(quadList, loop->continue_list,
+                                                 makeJumpList(quadList, br_index));
         }
     }
 
@@ -664,31 +749,33 @@ instruction_si
         // Libérer les adresses de comparaison si nécessaire
         if ($2.cmp_left) free($2.cmp_left);
         if ($2.cmp_right) free($2.cmp_right);
-        // Empiler l'indice pour le compléter plus tard
-        pushInt(&ifStack, branch_index);
-    } TOK_ALORS bloc partie_sinon_opt TOK_FIN
+        // Le saut "condition fausse" sera complété par partie_sinon_opt
+        pushIf(makeJumpList(quadList, branch_index));
+    } TOK_ALORS bloc partie_sinon_opt TOK_FIN {
+        // Les BR de fin de chaque branche pointent après le FIN
+        backpatch(quadList, currentIf()->end_list, nextQuad(quadList));
+        popIf();
+    }
     ;
 
 partie_sinon_opt
     : /* vide */ {
-        // Pas de ELSE : compléter le BZ pour pointer ici (après le bloc THEN)
-        int bz_index = popInt(&ifStack);
-        char next_addr[16];
-        sprintf(next_addr, "%d", nextQuad(quadList));
-        updateQuad(quadList, bz_index, next_addr);
+        // Pas de ELSE : la condition fausse saute ici (après le bloc THEN)
+        IfContext* ctx = currentIf();
+        backpatch(quadList, ctx->false_list, nextQuad(quadList));
+        ctx->false_list = -1;
     }
     | TOK_SINON TOK_SI {
         // SINON SI : chaînage d'alternatives (else-if)
         // Générer BR pour sauter la fin depuis le THEN précédent
-        createQuad(quadList, QUAD_BR, NULL, NULL, "");
-        int br_index = nextQuad(quadList) - 1;
-        pushInt(&ifBrStack, br_index);
+        IfContext* ctx = currentIf();
+        int br_index = createBranch(quadList, QUAD_BR, NULL, NULL, -1);
+        ctx->end_list = mergeJumpLists(quadList, ctx->end_list,
+                                       makeJumpList(quadList, br_index));
         
-        // Compléter le BZ précédent : il pointe vers ce nouveau SI
-        int bz_index = popInt(&ifStack);
-        char else_addr[16];
-        sprintf(else_addr, "%d", nextQuad(quadList));
-        updateQuad(quadList, bz_index, else_addr);
+        // La condition précédente fausse saute vers ce nouveau SI
+        backpatch(quadList, ctx->false_list, nextQuad(quadList));
+        ctx->false_list = -1;
     } expression {
         // Vérification de type pour la nouvelle condition
         if ($4.type != TYPE_B) {
@@ -698,46 +785,25 @@ partie_sinon_opt
         int branch_index = generate_inverse_branch(quadList, $4);
         if ($4.cmp_left) free($4.cmp_left);
         if ($4.cmp_right) free($4.cmp_right);
-        // Empiler ce nouveau BZ
-        pushInt(&ifStack, branch_index);
-    } TOK_ALORS bloc partie_sinon_opt {
-        // Compléter tous les BR de la chaîne else-if
-        // partie_sinon_opt recursive a déjà complété son propre BZ
-        // On doit maintenant compléter notre BR (celui qu'on a généré au début)
-        if (!isIntStackEmpty(&ifBrStack)) {
-            int br_index = popInt(&ifBrStack);
-            char end_addr[16];
-            sprintf(end_addr, "%d", nextQuad(quadList));
-            updateQuad(quadList, br_index, end_addr);
-        }
-    }
+        currentIf()->false_list = makeJumpList(quadList, branch_index);
+    } TOK_ALORS bloc partie_sinon_opt
     | TOK_SINON {
         // SINON simple (dernier cas, pas de condition)
-        createQuad(quadList, QUAD_BR, NULL, NULL, "");
-        int br_index = nextQuad(quadList) - 1;
-        
-        // Compléter le BZ du IF : il pointe vers le début du ELSE
-        int bz_index = popInt(&ifStack);
-        char else_addr[16];
-        sprintf(else_addr, "%d", nextQuad(quadList));
-        updateQuad(quadList, bz_index, else_addr);
+        IfContext* ctx = currentIf();
+        int br_index = createBranch(quadList, QUAD_BR, NULL, NULL, -1);
+        ctx->end_list = mergeJumpLists(quadList, ctx->end_list,
+                                       makeJumpList(quadList, br_index));
         
-        pushInt(&ifBrStack, br_index);
-    } bloc {
-        // Compléter le BR : il pointe vers ici (après le bloc ELSE)
-        if (!isIntStackEmpty(&ifBrStack)) {
-            int br_index = popInt(&ifBrStack);
-            char end_addr[16];
-            sprintf(end_addr, "%d", nextQuad(quadList));
-            updateQuad(quadList, br_index, end_addr);
-        }
-    }
+        // La condition fausse saute au début du ELSE
+        backpatch(quadList, ctx->false_list, nextQuad(quadList));
+        ctx->false_list = -1;
+    } bloc
     ;
 
 instruction_tant_que
     : TOK_TANT TOK_QUE {
         // Mémoriser l'indice de début de boucle (pour y revenir)
-        pushInt(&whileStartStack, nextQuad(quadList));
+        pushLoop(nextQuad(quadList));
     } expression {
         // Vérification de type
         if ($4.type != TYPE_B) {
@@ -748,24 +814,20 @@ instruction_tant_que
         // Libérer les adresses de comparaison si nécessaire
         if ($4.cmp_left) free($4.cmp_left);
         if ($4.cmp_right) free($4.cmp_right);
-        // Empiler l'indice pour le compléter plus tard
-        pushInt(&whileExitStack, branch_index);
+        // Le test de sortie rejoint les SORTIR du corps
+        LoopContext* loop = currentLoop();
+        loop->break_list = mergeJumpLists(quadList, loop->break_list,
+                                          makeJumpList(quadList, branch_index));
     } TOK_FAIRE bloc TOK_FIN {
-        // Fin du corps de la boucle : générer BR pour revenir au début
-        int start_index = popInt(&whileStartStack);
-        char start_addr[16];
-        sprintf(start_addr, "%d", start_index);
-        createQuad(quadList, QUAD_BR, NULL, NULL, start_addr);
+        // Fin du corps de la boucle : BR et CONTINUER reviennent au début
+        LoopContext* loop = currentLoop();
+        backpatch(quadList, loop->continue_list, loop->start);
+        int back_index = createBranch(quadList, QUAD_BR, NULL, NULL, loop->start);
+        setQuadLocation(quadList, back_index, @1.first_line, @1.first_column);
         
-        // Compléter le BZ de sortie : il pointe vers ici (après la boucle)
-        int bz_index = popInt(&whileExitStack);
-        char exit_addr[16];
-        sprintf(exit_addr, "%d", nextQuad(quadList));
-        updateQuad(quadList, bz_index, exit_addr);
-         while (!isIntStackEmpty(&whileBreakStack)) {
-        int br_index = popInt(&whileBreakStack);
-        updateQuad(quadList, br_index, exit_addr);
-    }
+        // Test de sortie et SORTIR : ils pointent ici (après la boucle)
+        backpatch(quadList, loop->break_list, nextQuad(quadList));
+        popLoop();
     }
     ;
 
@@ -781,50 +843,38 @@ instruction_pour
         
         // Initialiser la variable de boucle
         char* start_addr = expr_to_addr($4);
-        createQuad(quadList, QUAD_ASSIGN, start_addr, NULL, $2);
-        free(start_addr);
+        int init_index = createQuad(quadList, QUAD_ASSIGN, start_addr, NULL, $2);
         
         // Mémoriser le début de la boucle (test de condition)
-        pushInt(&forStartStack, nextQuad(quadList));
+        LoopContext* loop = pushLoop(nextQuad(quadList));
         
         // Générer le branchement : BG i, fin, sortie (si i > fin, sortir)
         char* end_addr = expr_to_addr($6);
-        createQuad(quadList, QUAD_BG, $2, end_addr, "");
+        int exit_index = createBranch(quadList, QUAD_BG, $2, end_addr, -1);
+        loop->break_list = makeJumpList(quadList, exit_index);
+
+        // Bornes de la boucle pour les passes d'optimisation
+        lt_begin($2, @1.first_line, init_index, nextQuad(quadList) - 1, start_addr, end_addr);
+        free(start_addr);
         free(end_addr);
-        pushInt(&forExitStack, nextQuad(quadList) - 1);
     } bloc {
-        // Incrémentation : variable = variable + 1
-        int continue_target = nextQuad(quadList);  // Calculer AVANT l'incrémentation
+        // Incrémentation : variable = variable + 1 ; CONTINUER y saute.
+        // Elle et le retour sont à la position du POUR, pas du bloc.
+        setSourcePosition(@1.first_line, @1.first_column);
+        LoopContext* loop = currentLoop();
+        backpatch(quadList, loop->continue_list, nextQuad(quadList));
         char* temp_incr = newTemp();
-        createQuad(quadList, QUAD_ADD, $2, "1", temp_incr);
+        int incr_index = createQuad(quadList, QUAD_ADD, $2, "1", temp_incr);
         createQuad(quadList, QUAD_ASSIGN, temp_incr, NULL, $2);
         free(temp_incr);
         
-        // Compléter les BR de CONTINUER (ils pointent vers l'incrémentation)
-        while (!isIntStackEmpty(&forContinueStack)) {
-            int br_index = popInt(&forContinueStack);
-            char target_addr[16];
-            sprintf(target_addr, "%d", continue_target);
-            updateQuad(quadList, br_index, target_addr);
-        }
-        
         // Retour au début de la boucle (test)
-        int start_index = popInt(&forStartStack);
-        char start_addr[16];
-        sprintf(start_addr, "%d", start_index);
-        createQuad(quadList, QUAD_BR, NULL, NULL, start_addr);
+        int back_index = createBranch(quadList, QUAD_BR, NULL, NULL, loop->start);
         
-        // Compléter le BZ de sortie : il pointe vers APRÈS cette boucle
-        int bz_index = popInt(&forExitStack);
-        char exit_addr[16];
-        sprintf(exit_addr, "%d", nextQuad(quadList));
-        updateQuad(quadList, bz_index, exit_addr);
-
-        // Compléter les BR de SORTIR (ils pointent vers la fin de la boucle)
-        while (!isIntStackEmpty(&forBreakStack)) {
-            int br_index = popInt(&forBreakStack);
-            updateQuad(quadList, br_index, exit_addr);
-        }
+        // Test de sortie et SORTIR : ils pointent APRÈS cette boucle
+        backpatch(quadList, loop->break_list, nextQuad(quadList));
+        popLoop();
+        lt_end("1", incr_index, back_index, nextQuad(quadList));
         
         if (global_symbol_table) exit_scope(global_symbol_table);
         free($2);
@@ -840,54 +890,40 @@ instruction_pour
         
         // Initialiser la variable de boucle
         char* start_addr = expr_to_addr($4);
-        createQuad(quadList, QUAD_ASSIGN, start_addr, NULL, $2);
-        free(start_addr);
+        int init_index = createQuad(quadList, QUAD_ASSIGN, start_addr, NULL, $2);
         
         // Mémoriser le début de la boucle (test de condition)
-        pushInt(&forStartStack, nextQuad(quadList));
+        LoopContext* loop = pushLoop(nextQuad(quadList));
         
         // Générer le branchement : BG i, fin, sortie (si i > fin, sortir)
         char* end_addr = expr_to_addr($6);
-        createQuad(quadList, QUAD_BG, $2, end_addr, "");
+        int exit_index = createBranch(quadList, QUAD_BG, $2, end_addr, -1);
+        loop->break_list = makeJumpList(quadList, exit_index);
+
+        // Bornes de la boucle pour les passes d'optimisation
+        lt_begin($2, @1.first_line, init_index, nextQuad(quadList) - 1, start_addr, end_addr);
+        free(start_addr);
         free(end_addr);
-        pushInt(&forExitStack, nextQuad(quadList) - 1);
     } bloc {
-        // Incrémentation : variable = variable + pas
+        // Incrémentation : variable = variable + pas ; CONTINUER y saute.
+        // Elle et le retour sont à la position du POUR, pas du bloc.
+        setSourcePosition(@1.first_line, @1.first_column);
+        LoopContext* loop = currentLoop();
+        backpatch(quadList, loop->continue_list, nextQuad(quadList));
         char* step_addr = expr_to_addr($8);
         char* temp_incr = newTemp();
-        createQuad(quadList, QUAD_ADD, $2, step_addr, temp_incr);
+        int incr_index = createQuad(quadList, QUAD_ADD, $2, step_addr, temp_incr);
         createQuad(quadList, QUAD_ASSIGN, temp_incr, NULL, $2);
-        free(step_addr);
         free(temp_incr);
         
-        // Compléter les BR de SORTIR (ils pointent vers la fin de la boucle)
-        while (!isIntStackEmpty(&forBreakStack)) {
-            int br_index = popInt(&forBreakStack);
-            char exit_addr[16];
-            sprintf(exit_addr, "%d", nextQuad(quadList));
-            updateQuad(quadList, br_index, exit_addr);
-        }
-        
-        // Compléter les BR de CONTINUER (ils pointent vers le retour au début)
-        int continue_target = nextQuad(quadList);
-        while (!isIntStackEmpty(&forContinueStack)) {
-            int br_index = popInt(&forContinueStack);
-            char target_addr[16];
-            sprintf(target_addr, "%d", continue_target);
-            updateQuad(quadList, br_index, target_addr);
-        }
-        
         // Retour au début de la boucle (test)
-        int start_index = popInt(&forStartStack);
-        char start_addr[16];
-        sprintf(start_addr, "%d", start_index);
-        createQuad(quadList, QUAD_BR, NULL, NULL, start_addr);
+        int back_index = createBranch(quadList, QUAD_BR, NULL, NULL, loop->start);
         
-        // Compléter le BZ de sortie
-        int bz_index = popInt(&forExitStack);
-        char exit_addr[16];
-        sprintf(exit_addr, "%d", nextQuad(quadList));
-        updateQuad(quadList, bz_index, exit_addr);
+        // Test de sortie et SORTIR : ils pointent APRÈS cette boucle
+        backpatch(quadList, loop->break_list, nextQuad(quadList));
+        popLoop();
+        lt_end(step_addr, incr_index, back_index, nextQuad(quadList));
+        free(step_addr);
         
         if (global_symbol_table) exit_scope(global_symbol_table);
         free($2);
@@ -911,34 +947,26 @@ instruction_pour
 instruction_repeter
     : TOK_REPETER {
         // Mémoriser l'indice de début de boucle
-        pushInt(&repeatStartStack, nextQuad(quadList));
+        pushLoop(nextQuad(quadList));
     } bloc TOK_JUSQUA expression {
         // Vérification de type de la condition
         if ($5.type != TYPE_B) {
             semantic_error("La condition doit être de type B (booléen)", @5.first_line, @5.first_column);
         }
         
-        // Récupérer l'adresse du début
-        int start_index = popInt(&repeatStartStack);
-        char start_addr[16];
-        sprintf(start_addr, "%d", start_index);
-        
-        // REPEAT...UNTIL continue tant que la condition est FAUSSE
-        // Générer branchement inversé (saute au début si faux)
-        // On met à jour le quadruplet pour pointer vers le début
+        // REPEAT...UNTIL continue tant que la condition est FAUSSE :
+        // branchement inversé vers le début, comme CONTINUER
+        LoopContext* loop = currentLoop();
         int branch_index = generate_inverse_branch(quadList, $5);
         if ($5.cmp_left) free($5.cmp_left);
         if ($5.cmp_right) free($5.cmp_right);
-        
-        // Compléter le branchement pour pointer vers le début de la boucle
-        updateQuad(quadList, branch_index, start_addr);
+        setQuadTarget(quadList, branch_index, loop->start);
+        setQuadLocation(quadList, branch_index, @1.first_line, @1.first_column);
+        backpatch(quadList, loop->continue_list, loop->start);
 
-        char exit_addr[16];
-    sprintf(exit_addr, "%d", nextQuad(quadList));
-    while (!isIntStackEmpty(&repeatBreakStack)) {
-        int br_index = popInt(&repeatBreakStack);
-        updateQuad(quadList, br_index, exit_addr);
-    }
+        // SORTIR : après la boucle
+        backpatch(quadList, loop->break_list, nextQuad(quadList));
+        popLoop();
     }
     ;
 
@@ -999,9 +1027,7 @@ liste_args
             }
         }
         advance_call_arg();
-        char* addr = expr_to_addr($1);
-        createQuad(quadList, QUAD_PARAM, addr, NULL, NULL);
-        free(addr);
+        push_pending_arg(expr_to_addr($1));
         if ($1.addr) { free($1.addr); $1.addr = NULL; }
         $$ = 1;
     }
@@ -1014,9 +1040,7 @@ liste_args
             }
         }
         advance_call_arg();
-        char* addr = expr_to_addr($3);
-        createQuad(quadList, QUAD_PARAM, addr, NULL, NULL);
-        free(addr);
+        push_pending_arg(expr_to_addr($3));
         if ($3.addr) { free($3.addr); $3.addr = NULL; }
         $$ = $1 + 1;
     }
@@ -1638,8 +1662,9 @@ primaire
 
 %%
 
-void yyerror(const char *s) {
-    fprintf(stderr,
+void yyerror(YYLTYPE* lloc, const char *s) {
+    (void)lloc;    /* line_num/col_num : position apres le token fautif */
+    fprintf(diagnostic_stream(),
         "Erreur syntaxique ligne %d colonne %d : %s\n",
         line_num, col_num, s);
 }
@@ -1740,6 +1765,7 @@ const char* token_name(int tok) {
 
         case TOK_FONCTION: return "TOK_FONCTION";
         case TOK_PROCEDURE: return "TOK_PROCEDURE";
+        case TOK_MEMOISER: return "TOK_MEMOISER";
 
         /* Fonctions chaînes */
         case TOK_MAJUSCULES: return "TOK_MAJUSCULES";
@@ -1760,125 +1786,438 @@ const char* token_name(int tok) {
 /* MAIN                  */
 /* ===================== */
 
-int main(int argc, char **argv) {
-    extern FILE *yyin;
+/* ===================== */
+/* TAMPON DE TOKENS      */
+/* ===================== */
+
+/* Le source n'est lu qu'une fois : la passe lexicale enregistre chaque
+   token avec sa valeur et sa position (et les affiche avec
+   --emit=tokens), puis yyparse les relit dans ce tableau. */
+typedef struct {
     int tok;
+    int line;          /* line_num apres le token */
+    int first_col;
+    int last_col;      /* col_num apres le token = last_col + 1 */
+    union {
+        int intval;
+        double floatval;
+        char charval;
+        char* strval;
+    } val;
+} TokenRecord;
+
+static _Thread_local TokenRecord* token_buffer = NULL;
+static _Thread_local int token_count = 0;
+static _Thread_local int token_capacity = 0;
+static _Thread_local int token_next = 0;
+
+/* Enregistre le token qui vient d'etre lu (tok = 0 : fin du fichier) */
+static void token_buffer_push(int tok, const YYSTYPE* lval, const YYLTYPE* lloc) {
+    if (token_count == token_capacity) {
+        token_capacity = token_capacity ? token_capacity * 2 : 4096;
+        token_buffer = realloc(token_buffer, sizeof(TokenRecord) * token_capacity);
+        if (!token_buffer) {
+            perror("realloc token_buffer");
+            exit(EXIT_FAILURE);
+        }
+    }
+    TokenRecord* t = &token_buffer[token_count++];
+    t->tok = tok;
+    t->line = line_num;
+    t->first_col = tok ? lloc->first_column : col_num;
+    t->last_col = col_num - 1;
+    switch (tok) {
+        case TOK_ID:
+        case TOK_STRING:
+        case TOK_COMPLEX:
+            t->val.strval = lval->strval;
+            break;
+        case TOK_INT:
+            t->val.intval = lval->intval;
+            break;
+        case TOK_FLOAT:
+            t->val.floatval = lval->floatval;
+            break;
+        case TOK_CHAR:
+            t->val.charval = lval->charval;
+            break;
+        default:
+            t->val.strval = NULL;
+    }
+}
 
-    /* Initialiser la table des symboles */
-   global_symbol_table = init_symbol_table();
-   
-   quadList = initQuadList();
-   initControlStacks();
-   ft_reset();
+/* yylex de yyparse : rejoue le tampon, positions comprises */
+int yylex(YYSTYPE* lval, YYLTYPE* lloc) {
+    if (token_next >= token_count) return 0;
+    const TokenRecord* t = &token_buffer[token_next++];
+    line_num = t->line;
+    col_num = t->last_col + 1;
+    if (t->tok == 0) return 0;
+
+    lloc->first_line = lloc->last_line = t->line;
+    lloc->first_column = t->first_col;
+    lloc->last_column = t->last_col;
+    switch (t->tok) {
+        case TOK_ID:
+        case TOK_STRING:
+        case TOK_COMPLEX:
+            lval->strval = t->val.strval;
+            break;
+        case TOK_INT:
+            lval->intval = t->val.intval;
+            break;
+        case TOK_FLOAT:
+            lval->floatval = t->val.floatval;
+            break;
+        case TOK_CHAR:
+            lval->charval = t->val.charval;
+            break;
+    }
+    return t->tok;
+}
 
-    set_semantic_error_mode(SEMANTIC_NON_FATAL);
+/* Libere le tampon ; les chaines des tokens que yyparse n'a pas relus
+   (arret apres l'analyse lexicale, erreur de syntaxe) avec lui */
+static void token_buffer_free(void) {
+    for (int i = token_next; i < token_count; i++) {
+        int tok = token_buffer[i].tok;
+        if (tok == TOK_ID || tok == TOK_STRING || tok == TOK_COMPLEX)
+            free(token_buffer[i].val.strval);
+    }
+    free(token_buffer);
+    token_buffer = NULL;
+    token_count = token_capacity = token_next = 0;
+}
 
-    if (argc < 2) {
-        fprintf(stderr, "Usage : %s <fichier>\n", argv[0]);
-        free_symbol_table(global_symbol_table);
-        return 1;
-    }
+/* ===================== */
+/* COMPILATION           */
+/* ===================== */
 
-    /* ===================== */
-    /* ANALYSE LEXICALE      */
-    /* ===================== */
-    yyin = fopen(argv[1], "r");
-    if (!yyin) {
-        fprintf(stderr, "Erreur : impossible d'ouvrir %s\n", argv[1]);
-        free_symbol_table(global_symbol_table);
-        return 1;
+void ml_context_init(MathLangContext* ctx) {
+    memset(ctx, 0, sizeof(*ctx));
+    opt_default_options(&ctx->options.opt);
+    ctx->options.opt.report = NULL;
+    ctx->options.stop_after = ML_STAGE_C;
+    ctx->options.use_mmap = 1;
+    ctx->options.memo_capacity = MEMO_DEFAULT_CAPACITY;
+    ctx->options.line_directives = 1;
+}
+
+/* Entier decimal dans [min, max], sans rien d'autre : 0, sinon -1 */
+static int parse_int_value(const char* text, long min, long max, int* value) {
+    char* end;
+    errno = 0;
+    long v = strtol(text, &end, 10);
+    if (end == text || *end != '\0' || errno == ERANGE || v < min || v > max) return -1;
+    *value = (int)v;
+    return 0;
+}
+
+int ml_parse_option(MlOptions* o, const char* arg) {
+    if (strcmp(arg, "-O0") == 0) {
+        o->opt.level = 0;
+    } else if (strcmp(arg, "-O1") == 0) {
+        o->opt.level = 1;
+    } else if (strcmp(arg, "-fno-strength-reduce") == 0) {
+        o->opt.strength_reduction = 0;
+    } else if (strcmp(arg, "-fno-const-calls") == 0) {
+        o->opt.const_calls = 0;
+    } else if (strcmp(arg, "-fno-specialize") == 0) {
+        o->opt.specialize = 0;
+    } else if (strcmp(arg, "-fno-tail-calls") == 0) {
+        o->opt.tail_calls = 0;
+    } else if (strcmp(arg, "-fno-inline") == 0) {
+        o->opt.inlining = 0;
+    } else if (strcmp(arg, "-fno-unroll") == 0) {
+        o->opt.unroll = 0;
+    } else if (strncmp(arg, "--unroll=", 9) == 0) {
+        return parse_int_value(arg + 9, 0, OPT_MAX_UNROLL_FACTOR, &o->opt.unroll_factor) == 0 ? 1 : -1;
+    } else if (strncmp(arg, "--memo-capacity=", 16) == 0) {
+        return parse_int_value(arg + 16, 1, MEMO_MAX_CAPACITY, &o->memo_capacity) == 0 ? 1 : -1;
+    } else if (strcmp(arg, "--no-mmap") == 0) {
+        o->use_mmap = 0;
+    } else if (strcmp(arg, "--profile") == 0) {
+        o->profile = 1;
+    } else if (strcmp(arg, "--no-line-directives") == 0) {
+        o->line_directives = 0;
+    } else {
+        return 0;
     }
+    return 1;
+}
 
-    /* Réinitialiser les positions avant la première passe */
+/* Etat du thread remis a neuf avant chaque compilation */
+static void compiler_reset(const MathLangContext* ctx) {
+    global_symbol_table = init_symbol_table();
+    quadList = initQuadList();
+    initControlStacks();
+    resetTempCounter();
+    resetLabelCounter();
+    ft_reset();
+    lt_reset();
+    function_context_top = -1;
+    call_context_top = -1;
+    clear_pending_args();
+    pending_memoize_line = 0;
     line_num = 1;
     col_num = 1;
+    set_diagnostic_stream(ctx->options.diagnostics);
+    set_semantic_error_mode(SEMANTIC_NON_FATAL);
+    reset_semantic_error_count();
+    set_memo_capacity(ctx->options.memo_capacity);
+    set_profile_mode(ctx->options.profile);
+    set_source_name(NULL);
+    setSourcePosition(0, 0);
+}
 
-    printf("=== ANALYSE LEXICALE ===\n\n");
-    printf("%-6s %-6s %-22s %s\n",
-           "Ligne", "Col", "Token", "Valeur");
-    printf("------------------------------------------------------------\n");
-
-    while ((tok = yylex()) != 0) {
-        printf("%-6d %-6d %-22s ",
-               line_num, col_num, token_name(tok));
+static void compiler_release(void) {
+    free_symbol_table(global_symbol_table);
+    global_symbol_table = NULL;
+    freeQuadList(quadList);
+    quadList = NULL;
+    clear_pending_args();
+    free(pending_args);
+    pending_args = NULL;
+    pending_arg_capacity = 0;
+    ft_free();
+    lt_reset();
+    freeControlStacks();
+    set_diagnostic_stream(NULL);
+}
 
-        switch (tok) {
-            case TOK_ID:
-            case TOK_STRING:
-            case TOK_COMPLEX:
-                printf("%s", yylval.strval);
-                break;
+static void print_token(FILE* out, int tok, const YYSTYPE* lval) {
+    fprintf(out, "%-6d %-6d %-22s ", line_num, col_num, token_name(tok));
+    switch (tok) {
+        case TOK_ID:
+        case TOK_STRING:
+        case TOK_COMPLEX:
+            fprintf(out, "%s", lval->strval);
+            break;
 
-            case TOK_INT:
-                printf("%d", yylval.intval);
-                break;
+        case TOK_INT:
+            fprintf(out, "%d", lval->intval);
+            break;
 
-            case TOK_FLOAT:
-                printf("%f", yylval.floatval);
-                break;
+        case TOK_FLOAT:
+            fprintf(out, "%f", lval->floatval);
+            break;
 
-            case TOK_CHAR:
-                printf("'%c'", yylval.charval);
-                break;
+        case TOK_CHAR:
+            fprintf(out, "'%c'", lval->charval);
+            break;
 
-            default:
-                printf("-");
-        }
-        printf("\n");
+        default:
+            fprintf(out, "-");
     }
+    fprintf(out, "\n");
+}
+
+/* --time-report : etat au debut d'une phase */
+typedef struct {
+    struct timespec wall, cpu;
+    long allocations, bytes;
+} PhaseMark;
 
-    fclose(yyin);
+static double seconds_between(struct timespec a, struct timespec b) {
+    return (b.tv_sec - a.tv_sec) + (b.tv_nsec - a.tv_nsec) / 1e9;
+}
 
-    /* ===================== */
-    /* ANALYSE SYNTAXIQUE    */
-    /* ===================== */
-    yyin = fopen(argv[1], "r");
-    if (!yyin) {
-        fprintf(stderr, "Erreur : impossible de rouvrir %s\n", argv[1]);
-        free_symbol_table(global_symbol_table);
-        return 1;
+static void phase_start(const MlTimeReport* r, PhaseMark* m) {
+    if (!r) return;
+    m->allocations = m->bytes = 0;
+    if (r->alloc_counters) r->alloc_counters(&m->allocations, &m->bytes);
+    clock_gettime(CLOCK_MONOTONIC, &m->wall);
+    clock_gettime(CLOCK_THREAD_CPUTIME_ID, &m->cpu);
+}
+
+static void phase_stop(MlTimeReport* r, MlStage stage, const PhaseMark* m) {
+    if (!r) return;
+    struct timespec wall, cpu;
+    clock_gettime(CLOCK_MONOTONIC, &wall);
+    clock_gettime(CLOCK_THREAD_CPUTIME_ID, &cpu);
+    MlPhaseStats* p = &r->phases[stage];
+    p->measured = 1;
+    p->wall = seconds_between(m->wall, wall);
+    p->cpu = seconds_between(m->cpu, cpu);
+    if (r->alloc_counters) {
+        long allocations, bytes;
+        r->alloc_counters(&allocations, &bytes);
+        p->allocations = allocations - m->allocations;
+        p->bytes = bytes - m->bytes;
     }
+}
 
-    /* Réinitialiser les positions avant la seconde passe (syntaxe) */
-    line_num = 1;
-    col_num = 1;
+/* Analyse lexicale : tout le source passe dans le tampon de tokens */
+static void scan_source(MathLangContext* ctx, yyscan_t scanner) {
+    FILE* out = ctx->options.tokens_out;
+    if (out) {
+        fprintf(out, "=== ANALYSE LEXICALE ===\n\n");
+        fprintf(out, "%-6s %-6s %-22s %s\n",
+                "Ligne", "Col", "Token", "Valeur");
+        fprintf(out, "------------------------------------------------------------\n");
+    }
 
-    printf("\n=== ANALYSE SYNTAXIQUE ===\n\n");
+    YYSTYPE lval;
+    YYLTYPE lloc = { 1, 1, 1, 1 };
+    int tok;
+    memset(&lval, 0, sizeof(lval));
+    while ((tok = scan_token(&lval, &lloc, scanner)) != 0) {
+        token_buffer_push(tok, &lval, &lloc);
+        if (out) print_token(out, tok, &lval);
+    }
+    token_buffer_push(0, &lval, &lloc);
+    ctx->token_count = token_count - 1;
+}
 
-    if (yyparse() == 0) {
-    printf("Analyse syntaxique réussie\n");
-} else {
-    fprintf(stderr, "Analyse syntaxique échouée. Génération C annulée.\n");
-    free_symbol_table(global_symbol_table);
-    return 1; // On s'arrête ici si la syntaxe est fausse !
+/* Analyse syntaxique et etapes suivantes sur le tampon de tokens */
+static int compile_tokens(MathLangContext* ctx) {
+    const MlOptions* o = &ctx->options;
+    MlTimeReport* report = o->time_report;
+    PhaseMark mark;
+    if (o->stop_after == ML_STAGE_LEX) {
+        token_buffer_free();
+        return 0;
+    }
+
+    /* yyparse relit les tokens deja enregistres : pas de seconde lecture */
+    phase_start(report, &mark);
+    int parse_status = yyparse();
+    setSourcePosition(0, 0);    /* quadruplets de l'optimiseur : sans position */
+    token_buffer_free();
+    phase_stop(report, ML_STAGE_PARSE, &mark);
+    if (report) {
+        report->quads_parsed = report->quads = quadList->count;
+        report->symbols = global_symbol_table->count;
+    }
+    ctx->syntax_ok = (parse_status == 0);
+    if (!ctx->syntax_ok) return 1;
+
+    if (o->symbols_out) fprint_symbol_table(o->symbols_out, global_symbol_table);
+
+    /* Optimisations sur les quadruplets (programme sans erreur) */
+    ctx->semantic_errors = get_semantic_error_count();
+    if (o->stop_after >= ML_STAGE_OPT && ctx->semantic_errors == 0) {
+        phase_start(report, &mark);
+        optimize_quads(quadList, global_symbol_table, &o->opt);
+        phase_stop(report, ML_STAGE_OPT, &mark);
+        if (report) report->quads = quadList->count;
+    }
+    if (report) report->temps = getTempCount();
+
+    if (o->quads_out) fprintQuadruplets(o->quads_out, quadList);
+
+    if (ctx->semantic_errors > 0) return 1;
+    if (o->stop_after >= ML_STAGE_C && (o->c_out || o->split_units)) {
+        int fcount;
+        FunctionInfo* funcs = ft_get_all(&fcount);
+        phase_start(report, &mark);
+        if (o->split_units) {
+            ctx->unit_count = generate_c_units(o->c_out, quadList, global_symbol_table,
+                                               funcs, fcount, &ctx->units);
+        } else {
+            generate_c_code(o->c_out, quadList, global_symbol_table, funcs, fcount);
+        }
+        phase_stop(report, ML_STAGE_C, &mark);
+        ctx->c_generated = 1;
+    }
+    return 0;
 }
 
-    fclose(yyin);
+void ml_free_units(MathLangContext* ctx) {
+    free_c_units(ctx->units, ctx->unit_count);
+    ctx->units = NULL;
+    ctx->unit_count = 0;
+}
 
-    /* Afficher la table des symboles finale */
-    print_symbol_table(global_symbol_table);
+static void clear_results(MathLangContext* ctx) {
+    ml_free_units(ctx);
+    ctx->syntax_ok = 0;
+    ctx->semantic_errors = 0;
+    ctx->c_generated = 0;
+    ctx->token_count = 0;
+    ctx->source_bytes = 0;
+    ctx->input_mode = NULL;
+    MlTimeReport* report = ctx->options.time_report;
+    if (report) {
+        void (*counters)(long*, long*) = report->alloc_counters;
+        memset(report, 0, sizeof(*report));
+        report->alloc_counters = counters;
+    }
+}
 
-     /* AFFICHER LES QUADRUPLETS */
-    printQuadruplets(quadList);
+int ml_compile_file(MathLangContext* ctx, const char* path) {
+    clear_results(ctx);
+    compiler_reset(ctx);
+    if (ctx->options.line_directives) set_source_name(path);
+    PhaseMark mark;
+    phase_start(ctx->options.time_report, &mark);
+
+    yyscan_t scanner;
+    if (yylex_init(&scanner) != 0) {
+        compiler_release();
+        return -1;
+    }
+
+    /* Source projete en memoire et lu par flex sans copie ; stdio sinon */
+    SourceInput source;
+    YY_BUFFER_STATE scan_buffer = NULL;
+    FILE* in = NULL;
+    if (ctx->options.use_mmap && source_load(path, &source) == 0) {
+        scan_buffer = yy_scan_buffer(source.data, source.size + 2, scanner);
+        if (!scan_buffer) source_release(&source);
+    }
+    if (!scan_buffer) {
+        in = fopen(path, "r");
+        if (!in) {
+            fprintf(diagnostic_stream(), "Erreur : impossible d'ouvrir %s\n", path);
+            yylex_destroy(scanner);
+            compiler_release();
+            return -1;
+        }
+        yyset_in(in, scanner);
+    }
 
-    if (get_semantic_error_count() == 0) {
-        
-    FILE* out = fopen("output.c", "w");
-    int fcount;
-    FunctionInfo* funcs = ft_get_all(&fcount);
-    generate_c_code(out, quadList, global_symbol_table, funcs, fcount);
-    fclose(out);
-    system("gcc output.c -lm -o output");
-    printf("\nCode C genere avec succes : output.c\n");  
+    scan_source(ctx, scanner);
 
+    /* Les valeurs des tokens sont des copies : le source peut partir */
+    if (scan_buffer) {
+        ctx->source_bytes = (long)source.size;
+        ctx->input_mode = source.map_size ? "mmap" : "tampon";
+        yy_delete_buffer(scan_buffer, scanner);
+        source_release(&source);
     } else {
-        printf("\n%d erreur(s) semantique(s) detectee(s) : generation de code annulee.\n",
-               get_semantic_error_count());
+        ctx->source_bytes = ftell(in);
+        ctx->input_mode = "stdio";
+        fclose(in);
     }
+    yylex_destroy(scanner);
+    phase_stop(ctx->options.time_report, ML_STAGE_LEX, &mark);
 
-    /* Libérer la mémoire */
-    free_symbol_table(global_symbol_table);
-     freeQuadList(quadList); 
-    return 0;
+    int status = compile_tokens(ctx);
+    compiler_release();
+    return status;
 }
 
+int ml_compile_string(MathLangContext* ctx, const char* source, size_t size) {
+    clear_results(ctx);
+    compiler_reset(ctx);
+    PhaseMark mark;
+    phase_start(ctx->options.time_report, &mark);
+
+    yyscan_t scanner;
+    if (yylex_init(&scanner) != 0) {
+        compiler_release();
+        return -1;
+    }
+    YY_BUFFER_STATE scan_buffer = yy_scan_bytes(source, (int)size, scanner);
+    scan_source(ctx, scanner);
+    ctx->source_bytes = (long)size;
+    ctx->input_mode = "memoire";
+    yy_delete_buffer(scan_buffer, scanner);
+    yylex_destroy(scanner);
+    phase_stop(ctx->options.time_report, ML_STAGE_LEX, &mark);
+
+    int status = compile_tokens(ctx);
+    compiler_release();
+    return status;
+}
@@ -0,0 +1,522 @@
+#include "optimizer.h"
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+
+/* ========================================================= */
+/*  EVALUATION DES APPELS A LA COMPILATION                    */
+/* ========================================================= */
+/*
+ * Un appel a une fonction pure dont tous les arguments sont constants
+ * est execute par un petit interpreteur de quadruplets, puis remplace
+ * par son resultat :  T <- CALL f  devient  T <- litteral.
+ *
+ * L'interpreteur reproduit le C genere par codegen_c.c, et non une
+ * semantique "ideale" :
+ *   - Z est un long : + - * et la negation bouclent modulo 2^64 ;
+ *   - les operations melant Z et R se font en double, comme en C ;
+ *   - chaque affectation convertit la valeur vers le type C de la
+ *     variable (troncature d'un double affecte a un long, etc.) ;
+ *   - div, mod, sin, sqrt... suivent les memes expressions que
+ *     translate_quad et la meme libm.
+ * Tout ce qui sortirait de ce cadre (division entiere par zero,
+ * conversion hors limites, chaines, complexes, budget epuise) fait
+ * simplement abandonner l'evaluation : l'appel reste a l'execution.
+ */
+
+#define EVAL_MAX_STEPS 200000    /* quadruplets executes par appel evalue */
+#define EVAL_MAX_DEPTH 256       /* profondeur de recursion */
+#define EVAL_MAX_VARS 256        /* variables par activation */
+
+typedef struct {
+    DataType type;   /* Z, R, B ou TYPE_CHAR (B et Char dans z) */
+    long z;
+    double r;
+} EvalValue;
+
+typedef struct {
+    const char* name;
+    DataType declared;
+    EvalValue v;
+} EvalVar;
+
+typedef struct {
+    EvalVar vars[EVAL_MAX_VARS];
+    int count;
+} EvalFrame;
+
+typedef struct {
+    const OptContext* ctx;
+    const OptDefIndex* defs;  /* definitions de toute la liste */
+    int call_site;       /* indice du CALL evalue (programme principal) */
+    char** literals;     /* resultats des appels deja evalues, par indice */
+    long steps;
+    int depth;
+} Evaluator;
+
+/* ---------- valeurs ---------- */
+
+static EvalValue make_z(long z) {
+    EvalValue v = { TYPE_Z, z, 0.0 };
+    return v;
+}
+
+static EvalValue make_r(double r) {
+    EvalValue v = { TYPE_R, 0, r };
+    return v;
+}
+
+static EvalValue make_b(int b) {
+    EvalValue v = { TYPE_B, b ? 1 : 0, 0.0 };
+    return v;
+}
+
+static double as_double(EvalValue v) {
+    return v.type == TYPE_R ? v.r : (double)v.z;
+}
+
+static int is_truthy(EvalValue v) {
+    return v.type == TYPE_R ? v.r != 0.0 : v.z != 0;
+}
+
+/* Conversion d'un double vers long : definie seulement dans les limites */
+static int double_to_long(double d, long* out) {
+    if (!(d > -9223372036854775808.0 && d < 9223372036854775808.0)) return 0;
+    *out = (long)d;
+    return 1;
+}
+
+/* Affectation C : valeur convertie vers le type de la destination */
+static int convert_to(EvalValue in, DataType to, EvalValue* out) {
+    switch (to) {
+        case TYPE_Z:
+            if (in.type == TYPE_R) {
+                long z;
+                if (!double_to_long(in.r, &z)) return 0;
+                *out = make_z(z);
+            } else {
+                *out = make_z(in.z);
+            }
+            return 1;
+        case TYPE_R:
+            *out = make_r(as_double(in));
+            return 1;
+        case TYPE_B:      /* int en C */
+            if (in.type == TYPE_R) return 0;
+            *out = in;
+            out->type = TYPE_B;
+            out->z = (int)in.z;
+            return 1;
+        case TYPE_CHAR:
+            if (in.type == TYPE_R) return 0;
+            *out = in;
+            out->type = TYPE_CHAR;
+            out->z = (char)in.z;
+            return 1;
+        default:
+            return 0;
+    }
+}
+
+static int parse_literal(const char* s, EvalValue* v) {
+    long z;
+    if (!s || !*s) return 0;
+    if (opt_int_literal(s, &z)) {
+        *v = make_z(z);
+        return 1;
+    }
+    if (strcmp(s, "true") == 0 || strcmp(s, "false") == 0) {
+        *v = make_b(s[0] == 't');
+        return 1;
+    }
+    if (s[0] == '\'' && s[1] && s[2] == '\'' && !s[3]) {
+        v->type = TYPE_CHAR;
+        v->z = s[1];
+        v->r = 0.0;
+        return 1;
+    }
+    /* Reel : chiffres, un point, signe (forme produite par le lexer) */
+    const char* p = (*s == '-') ? s + 1 : s;
+    if (*p < '0' || *p > '9') return 0;
+    for (; *p; p++) {
+        if ((*p < '0' || *p > '9') && *p != '.') return 0;
+    }
+    *v = make_r(strtod(s, NULL));
+    return 1;
+}
+
+/* ---------- activations ---------- */
+
+static EvalVar* frame_find(EvalFrame* fr, const char* name) {
+    for (int k = 0; k < fr->count; k++) {
+        if (strcmp(fr->vars[k].name, name) == 0) return &fr->vars[k];
+    }
+    return NULL;
+}
+
+/* Type C declare d'une variable de fn (parametre, temporaire, boucle) */
+static DataType declared_type(const Evaluator* ev, FunctionInfo* fn, const char* name) {
+    return opt_value_type(ev->ctx, name, fn);
+}
+
+static int frame_store(const Evaluator* ev, EvalFrame* fr, FunctionInfo* fn,
+                       const char* name, EvalValue v) {
+    EvalVar* var = frame_find(fr, name);
+    if (!var) {
+        if (fr->count >= EVAL_MAX_VARS) return 0;
+        DataType t = declared_type(ev, fn, name);
+        if (t != TYPE_Z && t != TYPE_R && t != TYPE_B && t != TYPE_CHAR) return 0;
+        var = &fr->vars[fr->count++];
+        var->name = name;
+        var->declared = t;
+    }
+    return convert_to(v, var->declared, &var->v);
+}
+
+/* Constante globale : son unique affectation doit preceder l'appel,
+   dans le programme principal */
+static int global_constant(const Evaluator* ev, const char* name, EvalValue* v) {
+    const OptContext* ctx = ev->ctx;
+    SymbolEntry* e = ctx->table ? find_symbol(ctx->table, name) : NULL;
+    if (!e || (e->category != SYMBOL_CONSTANT && !e->is_const)) return 0;
+    if (ev->call_site < 0 || opt_owner_function(ev->call_site)) return 0;
+
+    const OptDefEntry* d = opt_defs_find(ev->defs, name);
+    if (!d || d->count != 1) return 0;
+    int def = d->first;
+    if (def >= ev->call_site || opt_owner_function(def)) return 0;
+    const Quadruplet* q = &ctx->list->quads[def];
+    EvalValue lit;
+    if (q->op != QUAD_ASSIGN || !parse_literal(q->arg1, &lit)) return 0;
+    return convert_to(lit, e->type, v);
+}
+
+static int read_operand(const Evaluator* ev, EvalFrame* fr, const char* name, EvalValue* v) {
+    if (!name) return 0;
+    if (parse_literal(name, v)) return 1;
+    EvalVar* var = frame_find(fr, name);
+    if (var) {
+        *v = var->v;
+        return 1;
+    }
+    return global_constant(ev, name, v);
+}
+
+/* ---------- operations ---------- */
+
+static int eval_binary(QuadOp op, EvalValue a, EvalValue b, EvalValue* out) {
+    int real = (a.type == TYPE_R || b.type == TYPE_R);
+    long x, y;
+
+    switch (op) {
+        case QUAD_ADD:
+        case QUAD_SUB:
+        case QUAD_MUL:
+            if (real) {
+                double da = as_double(a), db = as_double(b);
+                *out = make_r(op == QUAD_ADD ? da + db : op == QUAD_SUB ? da - db : da * db);
+            } else {
+                unsigned long ua = (unsigned long)a.z, ub = (unsigned long)b.z;
+                unsigned long r = (op == QUAD_ADD) ? ua + ub : (op == QUAD_SUB) ? ua - ub : ua * ub;
+                *out = make_z((long)r);
+            }
+            return 1;
+        case QUAD_DIV:
+            *out = make_r(as_double(a) / as_double(b));
+            return 1;
+        case QUAD_DIV_INT:
+        case QUAD_MOD:
+            /* (long)(a) / (long)(b) */
+            if (a.type == TYPE_R ? !double_to_long(a.r, &x) : ((x = a.z), 0)) return 0;
+            if (b.type == TYPE_R ? !double_to_long(b.r, &y) : ((y = b.z), 0)) return 0;
+            if (y == 0 || (x == (-9223372036854775807L - 1) && y == -1)) return 0;
+            *out = make_z(op == QUAD_DIV_INT ? x / y : x % y);
+            return 1;
+        case QUAD_POW:
+            *out = make_r(pow(as_double(a), as_double(b)));
+            return 1;
+        case QUAD_EQ:  *out = make_b(real ? as_double(a) == as_double(b) : a.z == b.z); return 1;
+        case QUAD_NEQ: *out = make_b(real ? as_double(a) != as_double(b) : a.z != b.z); return 1;
+        case QUAD_LT:  *out = make_b(real ? as_double(a) <  as_double(b) : a.z <  b.z); return 1;
+        case QUAD_GT:  *out = make_b(real ? as_double(a) >  as_double(b) : a.z >  b.z); return 1;
+        case QUAD_LEQ: *out = make_b(real ? as_double(a) <= as_double(b) : a.z <= b.z); return 1;
+        case QUAD_GEQ: *out = make_b(real ? as_double(a) >= as_double(b) : a.z >= b.z); return 1;
+        case QUAD_AND: *out = make_b(is_truthy(a) && is_truthy(b)); return 1;
+        case QUAD_OR:  *out = make_b(is_truthy(a) || is_truthy(b)); return 1;
+        case QUAD_XOR: *out = make_b(is_truthy(a) != is_truthy(b)); return 1;
+        default:
+            return 0;
+    }
+}
+
+static int eval_unary(QuadOp op, EvalValue a, EvalValue* out) {
+    double d = as_double(a);
+    switch (op) {
+        case QUAD_NEG:
+            if (a.type == TYPE_R) *out = make_r(-a.r);
+            else *out = make_z((long)(0UL - (unsigned long)a.z));
+            return 1;
+        case QUAD_NOT:   *out = make_b(!is_truthy(a)); return 1;
+        case QUAD_SIN:   *out = make_r(sin(d)); return 1;
+        case QUAD_COS:   *out = make_r(cos(d)); return 1;
+        case QUAD_EXP:   *out = make_r(exp(d)); return 1;
+        case QUAD_LOG:   *out = make_r(log(d)); return 1;
+        case QUAD_SQRT:  *out = make_r(sqrt(d)); return 1;
+        case QUAD_ABS:   *out = make_r(fabs(d)); return 1;
+        case QUAD_FLOOR: *out = make_r(floor(d)); return 1;
+        case QUAD_CEIL:  *out = make_r(ceil(d)); return 1;
+        case QUAD_ROUND: *out = make_r(round(d)); return 1;
+        default:
+            return 0;
+    }
+}
+
+/* Condition d'un branchement conditionnel, comme "(a) > (b)" en C */
+static int eval_branch(QuadOp op, EvalValue a, EvalValue b, int* taken) {
+    EvalValue r;
+    switch (op) {
+        case QUAD_BZ:  *taken = !is_truthy(a); return 1;
+        case QUAD_BNZ: *taken = is_truthy(a); return 1;
+        case QUAD_BG:  if (!eval_binary(QUAD_GT, a, b, &r)) return 0; break;
+        case QUAD_BGE: if (!eval_binary(QUAD_GEQ, a, b, &r)) return 0; break;
+        case QUAD_BL:  if (!eval_binary(QUAD_LT, a, b, &r)) return 0; break;
+        case QUAD_BLE: if (!eval_binary(QUAD_LEQ, a, b, &r)) return 0; break;
+        case QUAD_BE:  if (!eval_binary(QUAD_EQ, a, b, &r)) return 0; break;
+        case QUAD_BNE: if (!eval_binary(QUAD_NEQ, a, b, &r)) return 0; break;
+        default: return 0;
+    }
+    *taken = (int)r.z;
+    return 1;
+}
+
+/* ---------- interpreteur ---------- */
+
+static int eval_function(Evaluator* ev, FunctionInfo* fn, const EvalValue* args, int nargs,
+                         EvalValue* result);
+
+static int eval_body(Evaluator* ev, FunctionInfo* fn, EvalFrame* fr, EvalValue* result) {
+    const QuadList* list = ev->ctx->list;
+    EvalValue pending[FT_MAX_PARAMS];
+    int npending = 0;
+    int pc = fn->quad_start;
+
+    while (pc < fn->quad_end) {
+        if (++ev->steps > EVAL_MAX_STEPS) return 0;
+        const Quadruplet* q = &list->quads[pc];
+        EvalValue a, b, r;
+        int next = pc + 1;
+
+        switch (q->op) {
+            case QUAD_ASSIGN:
+                if (!read_operand(ev, fr, q->arg1, &a)) return 0;
+                if (!frame_store(ev, fr, fn, q->result, a)) return 0;
+                break;
+            case QUAD_ADD: case QUAD_SUB: case QUAD_MUL: case QUAD_DIV:
+            case QUAD_DIV_INT: case QUAD_MOD: case QUAD_POW:
+            case QUAD_EQ: case QUAD_NEQ: case QUAD_LT: case QUAD_GT:
+            case QUAD_LEQ: case QUAD_GEQ: case QUAD_AND: case QUAD_OR: case QUAD_XOR:
+                if (!read_operand(ev, fr, q->arg1, &a) || !read_operand(ev, fr, q->arg2, &b))
+                    return 0;
+                if (!eval_binary(q->op, a, b, &r)) return 0;
+                if (!frame_store(ev, fr, fn, q->result, r)) return 0;
+                break;
+            case QUAD_NEG: case QUAD_NOT: case QUAD_SIN: case QUAD_COS: case QUAD_EXP:
+            case QUAD_LOG: case QUAD_SQRT: case QUAD_ABS: case QUAD_FLOOR:
+            case QUAD_CEIL: case QUAD_ROUND:
+                if (!read_operand(ev, fr, q->arg1, &a)) return 0;
+                if (!eval_unary(q->op, a, &r)) return 0;
+                if (!frame_store(ev, fr, fn, q->result, r)) return 0;
+                break;
+            case QUAD_BR:
+                next = getQuadTarget(q);
+                break;
+            case QUAD_BZ: case QUAD_BNZ: case QUAD_BG: case QUAD_BGE:
+            case QUAD_BL: case QUAD_BLE: case QUAD_BE: case QUAD_BNE: {
+                int taken;
+                if (!read_operand(ev, fr, q->arg1, &a)) return 0;
+                if (q->op != QUAD_BZ && q->op != QUAD_BNZ && !read_operand(ev, fr, q->arg2, &b))
+                    return 0;
+                if (!eval_branch(q->op, a, b, &taken)) return 0;
+                if (taken) next = getQuadTarget(q);
+                break;
+            }
+            case QUAD_PARAM:
+                if (npending >= FT_MAX_PARAMS || !read_operand(ev, fr, q->arg1, &pending[npending]))
+                    return 0;
+                npending++;
+                break;
+            case QUAD_CALL: {
+                FunctionInfo* callee = q->arg1 ? ft_find(q->arg1) : NULL;
+                if (!callee || !eval_function(ev, callee, pending, npending, &r)) return 0;
+                npending = 0;
+                if (q->result && !frame_store(ev, fr, fn, q->result, r)) return 0;
+                break;
+            }
+            case QUAD_RETURN:
+                if (!read_operand(ev, fr, q->arg1, &a)) return 0;
+                return convert_to(a, fn->return_type, result);
+            case QUAD_LABEL:
+            case QUAD_NOP:
+                break;
+            default:
+                return 0;   /* chaines, complexes, entrees/sorties */
+        }
+        if (next < fn->quad_start || next > fn->quad_end) return 0;
+        pc = next;
+    }
+    /* Fin du corps sans RETOURNER : le filet de securite renvoie 0 */
+    return convert_to(make_z(0), fn->return_type, result);
+}
+
+static int eval_function(Evaluator* ev, FunctionInfo* fn, const EvalValue* args, int nargs,
+                         EvalValue* result) {
+    if (!fn->is_function || !fn->is_pure || nargs != fn->param_count) return 0;
+    if (ev->depth >= EVAL_MAX_DEPTH) return 0;
+
+    EvalFrame* fr = (EvalFrame*)malloc(sizeof(EvalFrame));
+    if (!fr) return 0;
+    fr->count = 0;
+    int ok = 1;
+    for (int p = 0; p < nargs && ok; p++) {
+        EvalVar* var = &fr->vars[fr->count++];
+        var->name = fn->params[p].name;
+        var->declared = fn->params[p].type;
+        ok = convert_to(args[p], var->declared, &var->v);
+    }
+
+    ev->depth++;
+    ok = ok && eval_body(ev, fn, fr, result);
+    ev->depth--;
+    free(fr);
+    return ok;
+}
+
+/* ---------- litteraux ---------- */
+
+/* Texte d'un litteral que codegen_c.c type exactement comme le resultat
+   de l'appel ; 0 si la valeur n'a pas de forme litterale sure */
+static int format_literal(EvalValue v, DataType type, char* buf, size_t size) {
+    switch (type) {
+        case TYPE_Z:
+            /* -9223372036854775808 n'est pas un litteral C de type long */
+            if (v.z == (-9223372036854775807L - 1)) return 0;
+            snprintf(buf, size, "%ld", v.z);
+            return 1;
+        case TYPE_R: {
+            if (!isfinite(v.r)) return 0;
+            snprintf(buf, size, "%.17g", v.r);
+            /* Le typage des litteraux ne connait pas les exposants */
+            if (strchr(buf, 'e') || strchr(buf, 'n') || strchr(buf, 'i')) return 0;
+            if (!strchr(buf, '.')) strncat(buf, ".0", size - strlen(buf) - 1);
+            return 1;
+        }
+        case TYPE_B:
+            snprintf(buf, size, "%s", v.z ? "true" : "false");
+            return 1;
+        case TYPE_CHAR:
+            if (v.z < 32 || v.z > 126 || v.z == '\'' || v.z == '\\') return 0;
+            snprintf(buf, size, "'%c'", (char)v.z);
+            return 1;
+        default:
+            return 0;
+    }
+}
+
+/* Valeur d'un argument : litteral, constante globale, ou temporaire
+   defini une seule fois par un litteral ou par un appel deja evalue.
+   Une variable de l'utilisateur definie une seule fois peut l'etre dans
+   une branche non prise : elle n'est jamais une constante. */
+static int constant_argument(const Evaluator* ev, FunctionInfo* caller, const char* addr,
+                             EvalValue* v) {
+    const QuadList* list = ev->ctx->list;
+    if (parse_literal(addr, v)) return 1;
+    if (global_constant(ev, addr, v)) return 1;
+    if (!opt_is_temp(ev->ctx, addr)) return 0;
+
+    const OptDefEntry* d = opt_defs_find(ev->defs, addr);
+    if (!d || d->count != 1) return 0;
+    int def = d->first;
+    if (def >= ev->call_site || opt_owner_function(def) != caller) return 0;
+    const Quadruplet* q = &list->quads[def];
+    const char* text = (q->op == QUAD_CALL) ? ev->literals[def]
+                     : (q->op == QUAD_ASSIGN) ? q->arg1 : NULL;
+    EvalValue lit;
+    if (!parse_literal(text, &lit)) return 0;
+    DataType t = opt_value_type(ev->ctx, addr, caller);
+    return convert_to(lit, t, v);
+}
+
+int opt_fold_constant_calls(OptContext* ctx) {
+    QuadList* list = ctx->list;
+    int fcount;
+    FunctionInfo* functions = ft_get_all(&fcount);
+    int* folded = (int*)calloc(fcount > 0 ? fcount : 1, sizeof(int));
+    char* drop = (char*)calloc(list->count > 0 ? list->count : 1, 1);
+    char** literals = (char**)calloc(list->count > 0 ? list->count : 1, sizeof(char*));
+    int total = 0;
+    int params[FT_MAX_PARAMS];
+    OptDefIndex defs;
+    opt_defs_build(&defs, list, 0, list->count);
+
+    for (int i = 0; i < list->count; i++) {
+        Quadruplet* q = &list->quads[i];
+        if (q->op != QUAD_CALL || !q->arg1 || !q->result) continue;
+        FunctionInfo* callee = ft_find(q->arg1);
+        if (!callee || !callee->is_function || !callee->is_pure) continue;
+
+        int n = opt_call_params(list, i, params, FT_MAX_PARAMS);
+        if (n != callee->param_count) continue;
+
+        Evaluator ev = { ctx, &defs, i, literals, 0, 0 };
+        FunctionInfo* caller = opt_owner_function(i);
+        EvalValue args[FT_MAX_PARAMS];
+        int ok = 1;
+        for (int k = 0; k < n && ok; k++) {
+            ok = constant_argument(&ev, caller, list->quads[params[k]].arg1, &args[k]);
+        }
+        EvalValue result;
+        char literal[64];
+        if (!ok || !eval_function(&ev, callee, args, n, &result)) continue;
+        if (!format_literal(result, callee->return_type, literal, sizeof(literal))) continue;
+
+        literals[i] = stringDuplicate(literal);
+        for (int k = 0; k < n; k++) drop[params[k]] = 1;
+        folded[callee - functions]++;
+        total++;
+    }
+
+    opt_defs_free(&defs);
+
+    /* Remplacement apres le parcours : opt_call_params reconnait les
+       PARAM d'un appel grace au CALL qui precede */
+    if (total > 0) {
+        for (int i = 0; i < list->count; i++) {
+            if (!literals[i]) continue;
+            Quadruplet* q = &list->quads[i];
+            free(q->arg1);
+            free(q->arg2);
+            q->op = QUAD_ASSIGN;     /* T <- CALL f  devient  T <- litteral */
+            q->arg1 = literals[i];
+            q->arg2 = NULL;
+        }
+        QuadRewrite rw;
+        rw_begin(&rw, list);
+        for (int i = 0; i < list->count; i++) {
+            if (drop[i]) rw_mark(&rw, i);
+            else rw_copy(&rw, i);
+        }
+        rw_commit(&rw);
+    }
+
+    if (ctx->opts->report) {
+        for (int f = 0; f < fcount; f++) {
+            if (folded[f] > 0)
+                fprintf(ctx->opts->report, "  fonction '%s' : %d appel(s) evalue(s) a la compilation\n",
+                        functions[f].name, folded[f]);
+        }
+    }
+    free(folded);
+    free(drop);
+    free(literals);
+    return total;
+}
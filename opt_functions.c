@@ -0,0 +1,1183 @@
+#include "optimizer.h"
+#include <stdlib.h>
+#include <string.h>
+
+/* ========================================================= */
+/*  PURETE DES FONCTIONS                                      */
+/* ========================================================= */
+/*
+ * Une fonction est pure si son resultat ne depend que de ses
+ * parametres et si son execution n'a aucun effet observable :
+ *   - aucune ecriture d'une variable globale,
+ *   - aucune lecture d'une variable globale modifiable,
+ *   - aucune entree/sortie (LIRE, AFFICHER, AFFICHER_LIGNE),
+ *   - uniquement des appels a d'autres fonctions pures.
+ *
+ * La derniere condition est recursive : on part de l'hypothese que
+ * toutes les fonctions sont pures et on retire celles qui violent une
+ * regle, jusqu'a stabilite (point fixe). Les fonctions recursives, y
+ * compris mutuellement, restent pures si rien d'autre ne les en empeche.
+ */
+
+static int is_param_of(const FunctionInfo* fn, const char* name) {
+    for (int p = 0; p < fn->param_count; p++) {
+        if (strcmp(fn->params[p].name, name) == 0) return 1;
+    }
+    return 0;
+}
+
+/* Variable globale (hors parametre de fn) ; *is_const indique une constante */
+static int is_global_var(const OptContext* ctx, const FunctionInfo* fn,
+                         const char* name, int* is_const) {
+    if (!name || !ctx->table || is_param_of(fn, name)) return 0;
+    SymbolEntry* e = find_symbol(ctx->table, name);
+    if (!e) return 0;
+    if (e->category != SYMBOL_VARIABLE && e->category != SYMBOL_CONSTANT) return 0;
+    if (is_const) *is_const = (e->category == SYMBOL_CONSTANT || e->is_const);
+    return 1;
+}
+
+/* 1 si fn respecte les regles (sachant la purete actuelle des autres),
+   sinon 0 et la raison dans reason */
+static int check_function_purity(const OptContext* ctx, const FunctionInfo* fn,
+                                 char* reason, size_t reason_size) {
+    const QuadList* list = ctx->list;
+    for (int i = fn->quad_start; i < fn->quad_end && i < list->count; i++) {
+        const Quadruplet* q = &list->quads[i];
+        int is_const = 0;
+
+        switch (q->op) {
+            case QUAD_READ:
+            case QUAD_WRITE:
+            case QUAD_WRITELN:
+                snprintf(reason, reason_size, "entree/sortie (%s)", quadOpToString(q->op));
+                return 0;
+            case QUAD_CALL: {
+                FunctionInfo* callee = ft_find(q->arg1);
+                if (!callee || !callee->is_pure) {
+                    snprintf(reason, reason_size, "appelle '%s' qui n'est pas pure",
+                             q->arg1 ? q->arg1 : "?");
+                    return 0;
+                }
+                break;
+            }
+            default:
+                break;
+        }
+
+        if (q->result && isAssigningOp(q->op) && is_global_var(ctx, fn, q->result, NULL)) {
+            snprintf(reason, reason_size, "ecrit la variable globale '%s'", q->result);
+            return 0;
+        }
+        const char* args[2] = { q->arg1, q->arg2 };
+        for (int a = 0; a < 2; a++) {
+            if (q->op == QUAD_CALL && a == 0) continue;   /* nom de la fonction */
+            if (is_global_var(ctx, fn, args[a], &is_const) && !is_const) {
+                snprintf(reason, reason_size, "lit la variable globale '%s'", args[a]);
+                return 0;
+            }
+        }
+    }
+    return 1;
+}
+
+/* Types de parametres utilisables comme cle du cache MEMOISER */
+static int memo_key_supported(const FunctionInfo* fn, char* reason, size_t reason_size) {
+    for (int p = 0; p < fn->param_count; p++) {
+        DataType t = fn->params[p].type;
+        if (t != TYPE_Z && t != TYPE_R && t != TYPE_CHAR && t != TYPE_B) {
+            snprintf(reason, reason_size, "le parametre '%s' n'est ni Z, ni R, ni Car, ni B",
+                     fn->params[p].name);
+            return 0;
+        }
+    }
+    return 1;
+}
+
+int opt_analyze_purity(OptContext* ctx) {
+    int count;
+    FunctionInfo* functions = ft_get_all(&count);
+    char reason[160];
+
+    for (int f = 0; f < count; f++) functions[f].is_pure = 1;
+
+    int changed = 1;
+    while (changed) {
+        changed = 0;
+        for (int f = 0; f < count; f++) {
+            if (!functions[f].is_pure) continue;
+            if (!check_function_purity(ctx, &functions[f], reason, sizeof(reason))) {
+                functions[f].is_pure = 0;
+                changed = 1;
+            }
+        }
+    }
+
+    /* MEMOISER n'a de sens que sur une fonction pure a cle supportee */
+    int pure = 0;
+    for (int f = 0; f < count; f++) {
+        FunctionInfo* fn = &functions[f];
+        if (fn->is_pure) pure++;
+        if (!fn->memoize) continue;
+
+        char msg[320];
+        if (!fn->is_pure) {
+            check_function_purity(ctx, fn, reason, sizeof(reason));
+            snprintf(msg, sizeof(msg), "MEMOISER ignore : '%s' n'est pas pure (%s)",
+                     fn->name, reason);
+            semantic_warning(msg, fn->line, 1);
+            fn->memoize = 0;
+        } else if (!memo_key_supported(fn, reason, sizeof(reason))) {
+            snprintf(msg, sizeof(msg), "MEMOISER ignore sur '%s' : %s", fn->name, reason);
+            semantic_warning(msg, fn->line, 1);
+            fn->memoize = 0;
+        }
+    }
+    return pure;
+}
+
+/* ========================================================= */
+/*  APPELS RECURSIFS TERMINAUX                                */
+/* ========================================================= */
+/*
+ * Dans le corps de f, un appel a f dont le resultat est immediatement
+ * retourne :
+ *
+ *     PARAM x1 ... PARAM xk ; T <- CALL f ; RETURN T
+ *
+ * devient une reaffectation des parametres puis un saut en tete :
+ *
+ *     p1 <- x1 ... pk <- xk ; BR tete
+ *
+ * Pour une fonction a valeur dans Z, la forme  RETURN m * f(...)
+ * (ou m + f(...)) est aussi traitee grace a un accumulateur a,
+ * initialise a l'element neutre en entree de fonction :
+ *
+ *     a <- a * m ; p1 <- x1 ... ; BR tete
+ *
+ * et chaque RETURN x restant devient RETURN a * x. L'arithmetique
+ * entiere etant associative et commutative (modulo 2^64), le resultat
+ * est exactement celui de la recursion.
+ *
+ * La tete est un LABEL que seuls ces sauts visent : codegen_c.c ne
+ * compte pas dans le profil ces boucles, absentes du source.
+ */
+
+static int function_calls(const QuadList* list, const FunctionInfo* g, const char* name) {
+    for (int i = g->quad_start; i < g->quad_end; i++) {
+        const Quadruplet* q = &list->quads[i];
+        if (q->op == QUAD_CALL && q->arg1 && strcmp(q->arg1, name) == 0) return 1;
+    }
+    return 0;
+}
+
+typedef enum { TAIL_NONE, TAIL_PLAIN, TAIL_ACC } TailKind;
+
+typedef struct {
+    int call;          /* indice du CALL */
+    int first_param;   /* premier PARAM de l'appel */
+    int skip_to;       /* premier quadruplet apres la sequence remplacee */
+    TailKind kind;
+    QuadOp op;         /* TAIL_ACC : QUAD_MUL ou QUAD_ADD */
+    const char* m;     /* TAIL_ACC : l'autre operande */
+} TailCall;
+
+#define MAX_TAIL_CALLS 64
+
+/* Operande de l'accumulateur : sa valeur ne doit pas dependre de l'appel */
+static int acc_operand_ok(const OptContext* ctx, const FunctionInfo* fn, const char* m) {
+    int is_const = 0;
+    if (!m) return 0;
+    if (is_global_var(ctx, fn, m, &is_const)) return is_const;
+    return opt_addr_type(ctx, m, (FunctionInfo*)fn) == TYPE_Z ||
+           opt_value_type(ctx, m, (FunctionInfo*)fn) == TYPE_Z;
+}
+
+static TailKind classify_tail_call(const OptContext* ctx, const FunctionInfo* fn,
+                                   const char* is_target, TailCall* tc) {
+    const QuadList* list = ctx->list;
+    const Quadruplet* call = &list->quads[tc->call];
+    int next = tc->call + 1;
+    const Quadruplet* q1 = (next < fn->quad_end) ? &list->quads[next] : NULL;
+
+    if (!fn->is_function) {
+        /* Procedure : l'appel est suivi de la fin du corps */
+        if (!q1) {
+            tc->skip_to = next;
+            return TAIL_PLAIN;
+        }
+        if (is_target[next]) return TAIL_NONE;
+        if ((q1->op == QUAD_BR && getQuadTarget(q1) == fn->quad_end) ||
+            (q1->op == QUAD_RETURN && !q1->arg1)) {
+            tc->skip_to = next + 1;
+            return TAIL_PLAIN;
+        }
+        return TAIL_NONE;
+    }
+
+    if (!q1 || !call->result || is_target[next]) return TAIL_NONE;
+    if (q1->op == QUAD_RETURN && q1->arg1 && strcmp(q1->arg1, call->result) == 0) {
+        tc->skip_to = next + 1;
+        return TAIL_PLAIN;
+    }
+
+    /* RETURN m op f(...) : Z uniquement */
+    if (fn->return_type != TYPE_Z) return TAIL_NONE;
+    if (q1->op != QUAD_MUL && q1->op != QUAD_ADD) return TAIL_NONE;
+    if (next + 1 >= fn->quad_end || is_target[next + 1]) return TAIL_NONE;
+    const Quadruplet* q2 = &list->quads[next + 1];
+    if (q2->op != QUAD_RETURN || !q2->arg1 || !q1->result || strcmp(q2->arg1, q1->result) != 0)
+        return TAIL_NONE;
+
+    const char* m;
+    if (q1->arg1 && strcmp(q1->arg1, call->result) == 0) m = q1->arg2;
+    else if (q1->arg2 && strcmp(q1->arg2, call->result) == 0) m = q1->arg1;
+    else return TAIL_NONE;
+    if (!m || strcmp(m, call->result) == 0 || !acc_operand_ok(ctx, fn, m)) return TAIL_NONE;
+
+    tc->op = q1->op;
+    tc->m = m;
+    tc->skip_to = next + 2;
+    return TAIL_ACC;
+}
+
+/* Appels terminaux d'une fonction, prevus avant la reecriture */
+typedef struct {
+    FunctionInfo* fn;
+    TailCall calls[MAX_TAIL_CALLS];
+    int ncalls;
+    QuadOp acc_op;     /* QUAD_NOP : pas d'accumulateur */
+    char* acc;
+} TailPlan;
+
+static int find_tail_calls(const OptContext* ctx, const char* is_target, TailPlan* plan) {
+    const QuadList* list = ctx->list;
+    FunctionInfo* fn = plan->fn;
+    int params[FT_MAX_PARAMS];
+    plan->ncalls = 0;
+    plan->acc_op = QUAD_NOP;
+
+    for (int i = fn->quad_start; i < fn->quad_end && plan->ncalls < MAX_TAIL_CALLS; i++) {
+        const Quadruplet* q = &list->quads[i];
+        if (q->op != QUAD_CALL || !q->arg1 || strcmp(q->arg1, fn->name) != 0) continue;
+
+        int n = opt_call_params(list, i, params, FT_MAX_PARAMS);
+        if (n != fn->param_count || (q->arg2 && atoi(q->arg2) != n)) continue;
+
+        TailCall tc;
+        memset(&tc, 0, sizeof(tc));
+        tc.call = i;
+        tc.first_param = (n > 0) ? params[0] : i;
+        tc.kind = classify_tail_call(ctx, fn, is_target, &tc);
+        if (tc.kind == TAIL_NONE) continue;
+        if (tc.kind == TAIL_ACC) {
+            if (plan->acc_op != QUAD_NOP && plan->acc_op != tc.op) continue;
+            plan->acc_op = tc.op;
+        }
+        plan->calls[plan->ncalls++] = tc;
+    }
+    return plan->ncalls;
+}
+
+/* Emet dans rw le corps de la fonction, ses appels terminaux devenus
+   des sauts vers la tete */
+static void emit_tail_calls(const OptContext* ctx, QuadRewrite* rw, TailPlan* plan) {
+    const QuadList* list = ctx->list;
+    FunctionInfo* fn = plan->fn;
+    int params[FT_MAX_PARAMS];
+
+    /* Vue de l'exterieur (bornes, sauts), la fonction commence a
+       l'initialisation de l'accumulateur ; ses propres sauts vers son
+       debut visent le corps, apres la tete */
+    rw_mark(rw, fn->quad_start);
+    if (plan->acc_op != QUAD_NOP) {
+        plan->acc = newTemp();
+        rw_emit(rw, QUAD_ASSIGN, plan->acc_op == QUAD_MUL ? "1" : "0", NULL, plan->acc);
+    }
+    int head = rw_emit(rw, QUAD_LABEL, NULL, NULL, NULL);
+    int body = rw_position(rw);
+
+    int c = 0;
+    for (int i = fn->quad_start; i < fn->quad_end; i++) {
+        const Quadruplet* q = &list->quads[i];
+        TailCall* tc = (c < plan->ncalls) ? &plan->calls[c] : NULL;
+
+        /* PARAM d'un appel elimine : les arguments sont lus au CALL */
+        if (tc && i >= tc->first_param && i < tc->call && q->op == QUAD_PARAM) {
+            rw_mark(rw, i);
+            continue;
+        }
+
+        if (tc && i == tc->call) {
+            int n = opt_call_params(list, i, params, FT_MAX_PARAMS);
+            char* saved[FT_MAX_PARAMS];
+
+            rw_mark(rw, i);
+            if (tc->kind == TAIL_ACC) rw_emit(rw, tc->op, plan->acc, tc->m, plan->acc);
+
+            /* Copie parallele : un argument qui est un autre parametre
+               est sauve avant toute reaffectation */
+            for (int k = 0; k < n; k++) {
+                const char* x = list->quads[params[k]].arg1;
+                saved[k] = NULL;
+                if (is_param_of(fn, x) && strcmp(x, fn->params[k].name) != 0) {
+                    saved[k] = newTemp();
+                    rw_emit(rw, QUAD_ASSIGN, x, NULL, saved[k]);
+                }
+            }
+            for (int k = 0; k < n; k++) {
+                const char* x = saved[k] ? saved[k] : list->quads[params[k]].arg1;
+                if (strcmp(x, fn->params[k].name) != 0)
+                    rw_emit(rw, QUAD_ASSIGN, x, NULL, fn->params[k].name);
+                free(saved[k]);
+            }
+            int br = rw_emit(rw, QUAD_BR, NULL, NULL, NULL);
+            rw_set_target(rw, br, head, 0);
+            setQuadLocation(rw->out, br, q->line, q->column);
+
+            for (int j = i + 1; j < tc->skip_to; j++) rw_mark(rw, j);
+            i = tc->skip_to - 1;
+            c++;
+            continue;
+        }
+
+        if (plan->acc && q->op == QUAD_RETURN && q->arg1) {
+            char* t = newTemp();
+            rw_mark(rw, i);
+            rw_emit(rw, plan->acc_op, plan->acc, q->arg1, t);
+            rw_emit(rw, QUAD_RETURN, t, NULL, NULL);
+            free(t);
+            continue;
+        }
+        int idx = rw_copy(rw, i);
+        if (getQuadTarget(q) == fn->quad_start) rw_set_target(rw, idx, body, 0);
+    }
+}
+
+static int compare_plan_start(const void* a, const void* b) {
+    return ((const TailPlan*)a)->fn->quad_start - ((const TailPlan*)b)->fn->quad_start;
+}
+
+/* Toutes les fonctions en une seule reecriture. Les cibles de saut sont
+   calculees une fois, et seulement si une fonction s'appelle elle-meme. */
+int opt_tail_calls(OptContext* ctx) {
+    QuadList* list = ctx->list;
+    int count;
+    FunctionInfo* functions = ft_get_all(&count);
+    TailPlan* plans = NULL;
+    char* is_target = NULL;
+    int nplans = 0;
+
+    for (int f = 0; f < count; f++) {
+        FunctionInfo* fn = &functions[f];
+        /* MEMOISER : les appels doivent passer par le cache */
+        if (fn->memoize || !function_calls(list, fn, fn->name)) continue;
+        if (!is_target) {
+            is_target = (char*)calloc(list->count + 1, 1);
+            plans = (TailPlan*)malloc(sizeof(TailPlan) * count);
+            for (int i = 0; i < list->count; i++) {
+                int target = getQuadTarget(&list->quads[i]);
+                if (target >= 0 && target <= list->count) is_target[target] = 1;
+            }
+        }
+        TailPlan* plan = &plans[nplans];
+        memset(plan, 0, sizeof(*plan));
+        plan->fn = fn;
+        if (find_tail_calls(ctx, is_target, plan) > 0) nplans++;
+    }
+    free(is_target);
+    if (nplans == 0) {
+        free(plans);
+        return 0;
+    }
+
+    qsort(plans, nplans, sizeof(TailPlan), compare_plan_start);
+    QuadRewrite rw;
+    rw_begin(&rw, list);
+    int cursor = 0;
+    for (int p = 0; p < nplans; p++) {
+        rw_copy_range(&rw, cursor, plans[p].fn->quad_start);
+        emit_tail_calls(ctx, &rw, &plans[p]);
+        cursor = plans[p].fn->quad_end;
+    }
+    rw_copy_range(&rw, cursor, list->count);
+    rw_commit(&rw);
+
+    int total = 0;
+    for (int p = 0; p < nplans; p++) {
+        TailPlan* plan = &plans[p];
+        if (ctx->opts->report) {
+            fprintf(ctx->opts->report, "  fonction '%s' : %d appel(s) terminal(aux) elimine(s)",
+                    plan->fn->name, plan->ncalls);
+            if (plan->acc)
+                fprintf(ctx->opts->report, ", accumulateur (%s)", quadOpToString(plan->acc_op));
+            fprintf(ctx->opts->report, "\n");
+        }
+        total += plan->ncalls;
+        free(plan->acc);
+    }
+    free(plans);
+    return total;
+}
+
+/* ========================================================= */
+/*  INTEGRATION (INLINING) DES PETITES FONCTIONS              */
+/* ========================================================= */
+/*
+ * Un appel  PARAM x1 ... PARAM xk ; T <- CALL g  est remplace par une
+ * copie du corps de g ou :
+ *   - chaque parametre pi devient un temporaire frais pi' <- xi,
+ *   - les temporaires et variables locales de g sont renommes,
+ *   - RETURN x devient  T <- x ; BR fin.
+ * Les variables globales gardent leur nom : un site dont l'appelant a
+ * un parametre du meme nom qu'une globale de g n'est pas integre (la
+ * propagation ou le clonage ulterieurs de l'appelant la confondraient
+ * aussi avec ce parametre). Seules les fonctions courtes et non
+ * recursives sont integrees, dans la limite d'un budget de croissance
+ * du code.
+ */
+
+#define INLINE_MAX_QUADS 24          /* taille max du corps integre */
+#define INLINE_MAX_GROWTH 2000       /* quadruplets ajoutes au maximum */
+#define INLINE_MAX_NAMES 128
+
+typedef struct {
+    const char* from[INLINE_MAX_NAMES];
+    char* to[INLINE_MAX_NAMES];
+    int count;
+} RenameMap;
+
+static int is_identifier(const char* s) {
+    return s && (((*s >= 'a' && *s <= 'z') || (*s >= 'A' && *s <= 'Z') || *s == '_')) &&
+           strcmp(s, "true") != 0 && strcmp(s, "false") != 0;
+}
+
+/* Nom a renommer : tout identificateur qui n'est pas une globale de g */
+static const char* rename_operand(const OptContext* ctx, const FunctionInfo* g,
+                                  RenameMap* rm, const char* name) {
+    if (!is_identifier(name) || is_global_var(ctx, g, name, NULL)) return name;
+    for (int k = 0; k < rm->count; k++) {
+        if (strcmp(rm->from[k], name) == 0) return rm->to[k];
+    }
+    if (rm->count >= INLINE_MAX_NAMES) return NULL;
+    rm->from[rm->count] = name;
+    rm->to[rm->count] = newTemp();
+    return rm->to[rm->count++];
+}
+
+static void free_rename_map(RenameMap* rm) {
+    for (int k = 0; k < rm->count; k++) free(rm->to[k]);
+    rm->count = 0;
+}
+
+/* Conversion d'une valeur vers le type attendu (parametre ou retour) :
+   0 = impossible, 1 = affectation directe, 2 = via "* 1.0" (vers R) */
+static int conversion_kind(DataType expected, DataType actual) {
+    if (expected == TYPE_C || actual == TYPE_UNKNOWN) return 0;
+    if (expected == actual) return 1;
+    if (expected == TYPE_R && (actual == TYPE_Z || actual == TYPE_CHAR)) return 2;
+    return 0;
+}
+
+/* g est-elle integrable (independamment du site d'appel) ? */
+static int inline_candidate(const OptContext* ctx, FunctionInfo* g) {
+    if (g->memoize) return 0;
+    if (g->quad_end - g->quad_start > INLINE_MAX_QUADS) return 0;
+    if (function_calls(ctx->list, g, g->name)) return 0;
+    for (int p = 0; p < g->param_count; p++) {
+        if (g->params[p].type == TYPE_C) return 0;
+    }
+    /* Chaque valeur retournee doit avoir un type connu et compatible */
+    for (int i = g->quad_start; i < g->quad_end; i++) {
+        const Quadruplet* q = &ctx->list->quads[i];
+        if (q->op != QUAD_RETURN || !q->arg1) continue;
+        if (!conversion_kind(g->return_type, opt_value_type(ctx, q->arg1, g))) return 0;
+    }
+    return 1;
+}
+
+/* Une globale lue ou ecrite par g est-elle masquee par un parametre de
+   l'appelant ? Integre tel quel, son nom designerait ce parametre. */
+static int shadows_global(const OptContext* ctx, const FunctionInfo* caller,
+                          const FunctionInfo* g) {
+    if (!caller) return 0;
+    for (int i = g->quad_start; i < g->quad_end; i++) {
+        const Quadruplet* q = &ctx->list->quads[i];
+        const char* names[3] = { q->op == QUAD_CALL ? NULL : q->arg1,
+                                 q->op == QUAD_CALL ? NULL : q->arg2,
+                                 getQuadTarget(q) >= 0 ? NULL : q->result };
+        for (int a = 0; a < 3; a++) {
+            const char* s = names[a];
+            if (is_identifier(s) && is_param_of(caller, s) && is_global_var(ctx, g, s, NULL))
+                return 1;
+        }
+    }
+    return 0;
+}
+
+/* Verifie le site d'appel : PARAM en nombre et de types compatibles */
+static int inline_site_ok(const OptContext* ctx, FunctionInfo* caller, FunctionInfo* g,
+                          int call, int* params, int* nparams) {
+    const QuadList* list = ctx->list;
+    if (caller == g || shadows_global(ctx, caller, g)) return 0;
+
+    int n = opt_call_params(list, call, params, FT_MAX_PARAMS);
+    const Quadruplet* q = &list->quads[call];
+    if (n != g->param_count || (q->arg2 && atoi(q->arg2) != n)) return 0;
+    for (int k = 0; k < n; k++) {
+        DataType t = opt_value_type(ctx, list->quads[params[k]].arg1, caller);
+        if (!conversion_kind(g->params[k].type, t)) return 0;
+    }
+    *nparams = n;
+    return 1;
+}
+
+/* Emet  dst <- src  avec conversion eventuelle vers R */
+static void emit_converted(QuadRewrite* rw, const char* src, const char* dst, int kind) {
+    if (kind == 2) rw_emit(rw, QUAD_MUL, src, "1.0", dst);
+    else rw_emit(rw, QUAD_ASSIGN, src, NULL, dst);
+}
+
+static void inline_body(const OptContext* ctx, QuadRewrite* rw, FunctionInfo* caller,
+                        FunctionInfo* g, int call, const int* params, int n) {
+    const QuadList* list = ctx->list;
+    const char* result = list->quads[call].result;
+    RenameMap rm;
+    rm.count = 0;
+
+    /* Parametres : lus au moment de l'appel, comme le ferait le C */
+    for (int k = 0; k < n; k++) {
+        const char* x = list->quads[params[k]].arg1;
+        const char* p = rename_operand(ctx, g, &rm, g->params[k].name);
+        emit_converted(rw, x, p,
+                       conversion_kind(g->params[k].type, opt_value_type(ctx, x, caller)));
+    }
+
+    int size = g->quad_end - g->quad_start;
+    int* local = (int*)malloc(sizeof(int) * (size + 1));
+    int* branches = (int*)malloc(sizeof(int) * (2 * size + 1));
+    int* targets = (int*)malloc(sizeof(int) * (2 * size + 1));
+    int nbranches = 0;
+
+    for (int i = g->quad_start; i < g->quad_end; i++) {
+        const Quadruplet* q = &list->quads[i];
+        local[i - g->quad_start] = rw_position(rw);
+
+        if (q->op == QUAD_RETURN) {
+            if (q->arg1 && result) {
+                const char* x = rename_operand(ctx, g, &rm, q->arg1);
+                emit_converted(rw, x, result,
+                               conversion_kind(g->return_type, opt_value_type(ctx, q->arg1, g)));
+            }
+            if (i + 1 < g->quad_end) {
+                branches[nbranches] = rw_emit(rw, QUAD_BR, NULL, NULL, NULL);
+                targets[nbranches++] = g->quad_end;
+            }
+            continue;
+        }
+
+        /* CALL : arg1 est le nom de la fonction, arg2 le nombre d'arguments */
+        const char* a1 = q->arg1;
+        const char* a2 = q->arg2;
+        const char* res = q->result;
+        if (q->op != QUAD_CALL) {
+            a1 = rename_operand(ctx, g, &rm, a1);
+            a2 = rename_operand(ctx, g, &rm, a2);
+        }
+        int target = getQuadTarget(q);
+        if (target < 0 && res) res = rename_operand(ctx, g, &rm, res);
+
+        int idx = rw_emit(rw, q->op, a1, a2, target >= 0 ? NULL : res);
+        setQuadLocation(rw->out, idx, q->line, q->column);
+        if (target >= 0) {
+            branches[nbranches] = idx;
+            targets[nbranches++] = target;
+        }
+    }
+    local[size] = rw_position(rw);
+
+    /* Cibles : dans le corps de g (nouvelle copie) ou hors de g (impossible
+       en pratique : on les renvoie a la fin de la copie) */
+    for (int b = 0; b < nbranches; b++) {
+        int t = targets[b];
+        int new_target = (t >= g->quad_start && t <= g->quad_end)
+                             ? local[t - g->quad_start] : local[size];
+        rw_set_target(rw, branches[b], new_target, 0);
+    }
+
+    free(local);
+    free(branches);
+    free(targets);
+    free_rename_map(&rm);
+}
+
+int opt_inline_calls(OptContext* ctx) {
+    QuadList* list = ctx->list;
+    int fcount;
+    FunctionInfo* functions = ft_get_all(&fcount);
+    if (fcount == 0) return 0;
+
+    int* candidate = (int*)calloc(fcount, sizeof(int));
+    int* inlined = (int*)calloc(fcount, sizeof(int));
+    int any = 0;
+    for (int f = 0; f < fcount; f++) {
+        candidate[f] = inline_candidate(ctx, &functions[f]);
+        any |= candidate[f];
+    }
+    if (!any) {
+        free(candidate);
+        free(inlined);
+        return 0;
+    }
+
+    /* Sites retenus : indice du CALL -> fonction integree */
+    int n = list->count;
+    int* site = (int*)malloc(sizeof(int) * (n > 0 ? n : 1));
+    char* is_param = (char*)calloc(n > 0 ? n : 1, 1);
+    int params[FT_MAX_PARAMS];
+    int growth = 0, total = 0;
+
+    for (int i = 0; i < n; i++) {
+        site[i] = -1;
+        const Quadruplet* q = &list->quads[i];
+        if (q->op != QUAD_CALL || !q->arg1) continue;
+        FunctionInfo* g = ft_find(q->arg1);
+        if (!g) continue;
+        int gi = (int)(g - functions);
+        if (!candidate[gi]) continue;
+
+        int np;
+        if (!inline_site_ok(ctx, opt_owner_function(i), g, i, params, &np)) continue;
+        int cost = (g->quad_end - g->quad_start) * 2 + np;
+        if (growth + cost > INLINE_MAX_GROWTH) continue;
+
+        growth += cost;
+        site[i] = gi;
+        for (int k = 0; k < np; k++) is_param[params[k]] = 1;
+        inlined[gi]++;
+        total++;
+    }
+
+    if (total > 0) {
+        QuadRewrite rw;
+        rw_begin(&rw, list);
+        for (int i = 0; i < n; i++) {
+            if (is_param[i]) {
+                rw_mark(&rw, i);
+                continue;
+            }
+            if (site[i] < 0) {
+                rw_copy(&rw, i);
+                continue;
+            }
+            FunctionInfo* caller = opt_owner_function(i);
+            FunctionInfo* g = &functions[site[i]];
+            int np;
+            inline_site_ok(ctx, caller, g, i, params, &np);
+            rw_mark(&rw, i);
+            inline_body(ctx, &rw, caller, g, i, params, np);
+        }
+        rw_commit(&rw);
+    }
+
+    if (ctx->opts->report) {
+        for (int f = 0; f < fcount; f++) {
+            if (inlined[f] > 0)
+                fprintf(ctx->opts->report, "  fonction '%s' : %d appel(s) integre(s)\n",
+                        functions[f].name, inlined[f]);
+        }
+    }
+
+    free(site);
+    free(is_param);
+    free(candidate);
+    free(inlined);
+    return total;
+}
+
+/* ========================================================= */
+/*  PROPAGATION INTERPROCEDURALE ET SPECIALISATION            */
+/* ========================================================= */
+/*
+ * On examine tous les sites d'appel (PARAM ... CALL) de chaque fonction :
+ *   - un parametre qui recoit la meme constante a tous les sites (un
+ *     appel recursif qui le transmet tel quel compte aussi) est remplace
+ *     par cette constante dans le corps : propagation ;
+ *   - sinon, les sites qui passent des constantes sont regroupes par jeu
+ *     de constantes, et chaque groupe appelle un clone specialise "f#1",
+ *     "f#2"... prive de ces parametres (codegen_c.c l'emet sous le nom
+ *     f__spec1). Les appels recursifs du clone qui transmettent les
+ *     memes constantes restent dans le clone.
+ * Une constante est un litteral, un temporaire defini une seule fois par
+ * un litteral avant l'appel, ou (dans le programme principal) une
+ * constante globale deja initialisee. Les clones sont places apres le
+ * programme principal, dans la limite d'un budget de taille du code.
+ */
+
+#define SPEC_MAX_QUADS 64        /* taille max d'une fonction clonee */
+#define SPEC_MAX_CLONES 4        /* clones par fonction */
+#define SPEC_MAX_GROWTH 512      /* quadruplets ajoutes au maximum */
+
+typedef struct {
+    FunctionInfo* callee;
+    int call;                        /* indice du CALL */
+    int params[FT_MAX_PARAMS];       /* indices des PARAM */
+    char* constant[FT_MAX_PARAMS];   /* litteral au type du parametre, ou NULL */
+    int internal;                    /* appel depuis la fonction elle-meme */
+    int clone;                       /* clone appele (-1 : la fonction d'origine) */
+} SpecSite;
+
+typedef struct {
+    FunctionInfo* origin;
+    char name[128];
+    char* key[FT_MAX_PARAMS];        /* constantes du clone (NULL : parametre garde) */
+    int calls;
+    int start, end;                  /* corps dans la nouvelle liste */
+} SpecClone;
+
+static int is_value_literal(const OptContext* ctx, const char* s) {
+    if (!s || !*s || s[0] == '"') return 0;
+    if (is_identifier(s) && strcmp(s, "true") != 0 && strcmp(s, "false") != 0) return 0;
+    DataType t = opt_value_type(ctx, s, NULL);
+    return t == TYPE_Z || t == TYPE_R || t == TYPE_B || t == TYPE_CHAR;
+}
+
+/* Unique definition de name dans l'index (-1 : aucune ou plusieurs) */
+static int single_def(const OptDefIndex* defs, const char* name) {
+    const OptDefEntry* d = opt_defs_find(defs, name);
+    return (d && d->count == 1) ? d->first : -1;
+}
+
+/* Litteral passe par "addr" au CALL "call", converti au type du
+   parametre (Z -> R par ".0") ; NULL si ce n'est pas une constante */
+static char* site_constant(const OptContext* ctx, const OptDefIndex* defs, const char* addr,
+                           int call, DataType type) {
+    const char* lit = NULL;
+    if (is_value_literal(ctx, addr)) {
+        lit = addr;
+    } else if (is_identifier(addr)) {
+        FunctionInfo* owner = opt_owner_function(call);
+        int def = single_def(defs, addr);
+        if (def < 0 || def >= call || opt_owner_function(def) != owner) return NULL;
+        /* Un temporaire, ou une constante globale depuis le programme
+           principal. Un parametre ou une variable affectes une seule fois
+           peuvent l'etre dans une branche non prise. */
+        if (!opt_is_temp(ctx, addr)) {
+            SymbolEntry* e = ctx->table ? find_symbol(ctx->table, addr) : NULL;
+            if (!e || owner || (e->category != SYMBOL_CONSTANT && !e->is_const)) return NULL;
+        }
+        const Quadruplet* q = &ctx->list->quads[def];
+        if (q->op != QUAD_ASSIGN || !is_value_literal(ctx, q->arg1)) return NULL;
+        if (opt_value_type(ctx, addr, owner) != opt_value_type(ctx, q->arg1, NULL)) return NULL;
+        lit = q->arg1;
+    }
+    if (!lit) return NULL;
+
+    DataType t = opt_value_type(ctx, lit, NULL);
+    if (t == type) return stringDuplicate(lit);
+    if (type == TYPE_R && t == TYPE_Z) {
+        char* r = (char*)malloc(strlen(lit) + 3);
+        sprintf(r, "%s.0", lit);
+        return r;
+    }
+    return NULL;
+}
+
+/* Sites d'appel de toutes les fonctions ; *count = leur nombre */
+static SpecSite* collect_sites(const OptContext* ctx, int* count) {
+    const QuadList* list = ctx->list;
+    SpecSite* sites = NULL;
+    int n = 0, capacity = 0;
+    OptDefIndex defs;
+    opt_defs_build(&defs, list, 0, list->count);
+
+    for (int i = 0; i < list->count; i++) {
+        const Quadruplet* q = &list->quads[i];
+        if (q->op != QUAD_CALL || !q->arg1) continue;
+        FunctionInfo* g = ft_find(q->arg1);
+        if (!g) continue;
+        if (n == capacity) {
+            capacity = capacity ? capacity * 2 : 16;
+            sites = (SpecSite*)realloc(sites, sizeof(SpecSite) * capacity);
+        }
+        SpecSite* s = &sites[n++];
+        memset(s, 0, sizeof(*s));
+        s->callee = g;
+        s->call = i;
+        s->internal = (opt_owner_function(i) == g);
+        s->clone = -1;
+        int np = opt_call_params(list, i, s->params, FT_MAX_PARAMS);
+        if (np != g->param_count) {
+            s->callee = NULL;   /* site illisible : la fonction ne sera pas touchee */
+            continue;
+        }
+        for (int k = 0; k < np; k++) {
+            s->constant[k] = site_constant(ctx, &defs, list->quads[s->params[k]].arg1, i,
+                                           g->params[k].type);
+        }
+    }
+    opt_defs_free(&defs);
+    *count = n;
+    return sites;
+}
+
+static void free_sites(SpecSite* sites, int count) {
+    for (int s = 0; s < count; s++) {
+        for (int k = 0; k < FT_MAX_PARAMS; k++) free(sites[s].constant[k]);
+    }
+    free(sites);
+}
+
+/* Un site illisible (nombre de PARAM inattendu) interdit toute
+   transformation de la fonction */
+static int all_sites_readable(const QuadList* list, const SpecSite* sites, int count,
+                              const FunctionInfo* g) {
+    for (int s = 0; s < count; s++) {
+        if (!sites[s].callee && strcmp(list->quads[sites[s].call].arg1, g->name) == 0) return 0;
+    }
+    return 1;
+}
+
+static int same_constant(const char* a, const char* b) {
+    return (!a && !b) || (a && b && strcmp(a, b) == 0);
+}
+
+/* Le site transmet-il la constante c au parametre k de g ? */
+static int site_passes(const QuadList* list, const SpecSite* s, const FunctionInfo* g,
+                       int k, const char* c) {
+    if (s->constant[k] && strcmp(s->constant[k], c) == 0) return 1;
+    return s->internal && strcmp(list->quads[s->params[k]].arg1, g->params[k].name) == 0;
+}
+
+/* Remplace dans le corps de g les lectures du parametre k par c */
+static void propagate_param(QuadList* list, FunctionInfo* g, int k, const char* c) {
+    const char* p = g->params[k].name;
+    for (int i = g->quad_start; i < g->quad_end; i++) {
+        Quadruplet* q = &list->quads[i];
+        if (q->op == QUAD_CALL) continue;
+        if (q->arg1 && strcmp(q->arg1, p) == 0) {
+            free(q->arg1);
+            q->arg1 = stringDuplicate(c);
+        }
+        if (q->arg2 && strcmp(q->arg2, p) == 0) {
+            free(q->arg2);
+            q->arg2 = stringDuplicate(c);
+        }
+    }
+    lt_replace_operand(g->quad_start, g->quad_end, p, c);
+}
+
+static int propagate_constants(OptContext* ctx, FunctionInfo* g, SpecSite* sites, int count) {
+    QuadList* list = ctx->list;
+    int propagated = 0;
+    for (int k = 0; k < g->param_count; k++) {
+        /* Candidat : la constante du premier site externe */
+        const char* c = NULL;
+        for (int s = 0; s < count; s++) {
+            if (sites[s].callee == g && !sites[s].internal) {
+                c = sites[s].constant[k];
+                break;
+            }
+        }
+        if (!c || opt_count_defs(list, g->params[k].name, g->quad_start, g->quad_end) > 0)
+            continue;
+        int ok = 1;
+        for (int s = 0; s < count && ok; s++) {
+            if (sites[s].callee == g) ok = site_passes(list, &sites[s], g, k, c);
+        }
+        if (!ok) continue;
+
+        if (ctx->opts->report)
+            fprintf(ctx->opts->report, "  fonction '%s' : parametre '%s' = %s propage\n",
+                    g->name, g->params[k].name, c);
+        propagate_param(list, g, k, c);
+        propagated++;
+    }
+    return propagated;
+}
+
+/* Le corps de g lit-il son parametre k ? */
+static int param_is_read(const QuadList* list, const FunctionInfo* g, int k) {
+    const char* p = g->params[k].name;
+    for (int i = g->quad_start; i < g->quad_end; i++) {
+        const Quadruplet* q = &list->quads[i];
+        if (q->op == QUAD_CALL) continue;
+        if ((q->arg1 && strcmp(q->arg1, p) == 0) || (q->arg2 && strcmp(q->arg2, p) == 0))
+            return 1;
+    }
+    return 0;
+}
+
+/* Identificateurs a renommer dans le corps de g (borne de RenameMap) */
+static int count_local_names(const OptContext* ctx, const FunctionInfo* g) {
+    const char* seen[INLINE_MAX_NAMES + 1];
+    int n = 0;
+    for (int i = g->quad_start; i < g->quad_end; i++) {
+        const Quadruplet* q = &ctx->list->quads[i];
+        const char* names[3] = { q->op == QUAD_CALL ? NULL : q->arg1,
+                                 q->op == QUAD_CALL ? NULL : q->arg2,
+                                 getQuadTarget(q) >= 0 ? NULL : q->result };
+        for (int a = 0; a < 3; a++) {
+            const char* s = names[a];
+            if (!is_identifier(s) || is_global_var(ctx, g, s, NULL)) continue;
+            int known = 0;
+            for (int j = 0; j < n && !known; j++) known = (strcmp(seen[j], s) == 0);
+            if (known) continue;
+            if (n >= INLINE_MAX_NAMES) return n + 1;
+            seen[n++] = s;
+        }
+    }
+    return n + g->param_count;
+}
+
+static int spec_candidate(const OptContext* ctx, const FunctionInfo* g) {
+    if (g->memoize || g->quad_end - g->quad_start > SPEC_MAX_QUADS) return 0;
+    return count_local_names(ctx, g) <= INLINE_MAX_NAMES;
+}
+
+/* Clone de g correspondant aux constantes du site (cree si besoin) */
+static int clone_for_site(const OptContext* ctx, FunctionInfo* g, const SpecSite* s,
+                          SpecClone* clones, int* nclones, int* growth) {
+    const QuadList* list = ctx->list;
+    char* key[FT_MAX_PARAMS];
+    int any = 0;
+    for (int k = 0; k < g->param_count; k++) {
+        key[k] = s->constant[k];
+        if (key[k] && (!param_is_read(list, g, k) ||
+                       opt_count_defs(list, g->params[k].name, g->quad_start, g->quad_end) > 0))
+            key[k] = NULL;
+        any |= (key[k] != NULL);
+    }
+    if (!any) return -1;
+
+    int per_function = 0;
+    for (int c = 0; c < *nclones; c++) {
+        if (clones[c].origin != g) continue;
+        per_function++;
+        int same = 1;
+        for (int k = 0; k < g->param_count && same; k++)
+            same = same_constant(clones[c].key[k], key[k]);
+        if (same) return c;
+    }
+
+    int size = g->quad_end - g->quad_start;
+    if (per_function >= SPEC_MAX_CLONES || *growth + size > SPEC_MAX_GROWTH) return -1;
+
+    SpecClone* cl = &clones[(*nclones)++];
+    memset(cl, 0, sizeof(*cl));
+    cl->origin = g;
+    snprintf(cl->name, sizeof(cl->name), "%s#%d", g->name, per_function + 1);
+    for (int k = 0; k < g->param_count; k++) cl->key[k] = key[k] ? stringDuplicate(key[k]) : NULL;
+    *growth += size;
+    return *nclones - 1;
+}
+
+/* Appel interne au corps de g qui peut rester dans le clone */
+static int stays_in_clone(const QuadList* list, const SpecSite* s, const SpecClone* cl) {
+    const FunctionInfo* g = cl->origin;
+    for (int k = 0; k < g->param_count; k++) {
+        if (cl->key[k] && !site_passes(list, s, g, k, cl->key[k])) return 0;
+    }
+    return 1;
+}
+
+static void redirect_call(QuadRewrite* rw, int idx, const SpecClone* cl) {
+    Quadruplet* q = &rw->out->quads[idx];
+    int kept = 0;
+    for (int k = 0; k < cl->origin->param_count; k++) kept += (cl->key[k] == NULL);
+    free(q->arg1);
+    q->arg1 = stringDuplicate(cl->name);
+    if (q->arg2) {
+        char buf[16];
+        snprintf(buf, sizeof(buf), "%d", kept);
+        free(q->arg2);
+        q->arg2 = stringDuplicate(buf);
+    }
+}
+
+/* Emet le corps du clone ; ses parametres gardes sont renommes dans "names" */
+static void emit_clone(const OptContext* ctx, QuadRewrite* rw, SpecClone* cl,
+                       const SpecSite* sites, int count, char names[][64]) {
+    const QuadList* list = ctx->list;
+    FunctionInfo* g = cl->origin;
+    int size = g->quad_end - g->quad_start;
+    RenameMap rm;
+    rm.count = 0;
+
+    for (int k = 0; k < g->param_count; k++) {
+        if (cl->key[k]) {
+            rm.from[rm.count] = g->params[k].name;
+            rm.to[rm.count++] = stringDuplicate(cl->key[k]);
+        } else {
+            strncpy(names[k], rename_operand(ctx, g, &rm, g->params[k].name), 63);
+            names[k][63] = '\0';
+        }
+    }
+
+    /* Appels recursifs qui restent dans le clone : leurs PARAM specialises disparaissent */
+    char* skip = (char*)calloc(size + 1, 1);
+    char* inside = (char*)calloc(size + 1, 1);
+    for (int s = 0; s < count; s++) {
+        if (sites[s].callee != g || !sites[s].internal) continue;
+        if (!stays_in_clone(list, &sites[s], cl)) continue;
+        inside[sites[s].call - g->quad_start] = 1;
+        for (int k = 0; k < g->param_count; k++) {
+            if (cl->key[k]) skip[sites[s].params[k] - g->quad_start] = 1;
+        }
+    }
+
+    int* local = (int*)malloc(sizeof(int) * (size + 1));
+    int* branches = (int*)malloc(sizeof(int) * (size + 1));
+    int* targets = (int*)malloc(sizeof(int) * (size + 1));
+    int nbranches = 0;
+    cl->start = rw_position(rw);
+    for (int i = g->quad_start; i < g->quad_end; i++) {
+        const Quadruplet* q = &list->quads[i];
+        local[i - g->quad_start] = rw_position(rw);
+        if (skip[i - g->quad_start]) continue;
+
+        const char* a1 = q->arg1;
+        const char* a2 = q->arg2;
+        const char* res = q->result;
+        if (q->op != QUAD_CALL) {
+            a1 = rename_operand(ctx, g, &rm, a1);
+            a2 = rename_operand(ctx, g, &rm, a2);
+        }
+        int target = getQuadTarget(q);
+        if (target < 0 && res) res = rename_operand(ctx, g, &rm, res);
+
+        int idx = rw_emit(rw, q->op, a1, a2, target >= 0 ? NULL : res);
+        setQuadLocation(rw->out, idx, q->line, q->column);
+        if (target >= 0) {
+            branches[nbranches] = idx;
+            targets[nbranches++] = target;
+        }
+        if (inside[i - g->quad_start]) redirect_call(rw, idx, cl);
+    }
+    local[size] = rw_position(rw);
+    cl->end = local[size];
+
+    for (int b = 0; b < nbranches; b++) {
+        int t = targets[b];
+        int new_target = (t >= g->quad_start && t <= g->quad_end)
+                             ? local[t - g->quad_start] : local[size];
+        rw_set_target(rw, branches[b], new_target, 0);
+    }
+
+    free(skip);
+    free(inside);
+    free(local);
+    free(branches);
+    free(targets);
+    free_rename_map(&rm);
+}
+
+int opt_specialize(OptContext* ctx, int* cloned) {
+    QuadList* list = ctx->list;
+    int fcount;
+    FunctionInfo* functions = ft_get_all(&fcount);
+    *cloned = 0;
+    if (fcount == 0) return 0;
+
+    /* 1. Propagation : parametres constants a tous les sites */
+    int count;
+    SpecSite* sites = collect_sites(ctx, &count);
+    int propagated = 0;
+    for (int f = 0; f < fcount; f++) {
+        FunctionInfo* g = &functions[f];
+        if (g->memoize || !all_sites_readable(list, sites, count, g)) continue;
+        propagated += propagate_constants(ctx, g, sites, count);
+    }
+    free_sites(sites, count);
+
+    /* 2. Clones pour les sites externes restant constants (les corps ont
+       pu changer : on relit les sites) */
+    sites = collect_sites(ctx, &count);
+    SpecClone* clones = (SpecClone*)calloc(fcount * SPEC_MAX_CLONES, sizeof(SpecClone));
+    char* drop = (char*)calloc(list->count > 0 ? list->count : 1, 1);
+    int nclones = 0, growth = 0;
+    for (int f = 0; f < fcount; f++) {
+        FunctionInfo* g = &functions[f];
+        if (!spec_candidate(ctx, g) || !all_sites_readable(list, sites, count, g)) continue;
+        for (int s = 0; s < count; s++) {
+            SpecSite* site = &sites[s];
+            if (site->callee != g || site->internal) continue;
+            site->clone = clone_for_site(ctx, g, site, clones, &nclones, &growth);
+            if (site->clone < 0) continue;
+            clones[site->clone].calls++;
+            for (int k = 0; k < g->param_count; k++) {
+                if (clones[site->clone].key[k]) drop[site->params[k]] = 1;
+            }
+        }
+    }
+
+    if (nclones > 0) {
+        int* clone_at = (int*)malloc(sizeof(int) * (list->count > 0 ? list->count : 1));
+        for (int i = 0; i < list->count; i++) clone_at[i] = -1;
+        for (int s = 0; s < count; s++) {
+            if (sites[s].clone >= 0) clone_at[sites[s].call] = sites[s].clone;
+        }
+
+        QuadRewrite rw;
+        rw_begin(&rw, list);
+        for (int i = 0; i < list->count; i++) {
+            if (drop[i]) {
+                rw_mark(&rw, i);
+                continue;
+            }
+            int idx = rw_copy(&rw, i);
+            if (clone_at[i] >= 0) redirect_call(&rw, idx, &clones[clone_at[i]]);
+        }
+        /* Fin du programme principal : les sauts vers la fin y restent */
+        rw_mark(&rw, list->count);
+        rw_emit(&rw, QUAD_NOP, NULL, NULL, NULL);
+
+        char (*names)[FT_MAX_PARAMS][64] = calloc(nclones, sizeof(*names));
+        for (int c = 0; c < nclones; c++) emit_clone(ctx, &rw, &clones[c], sites, count, names[c]);
+        rw_commit(&rw);
+
+        /* ft_clone peut deplacer les entrees : origines par indice */
+        int* origin = (int*)malloc(sizeof(int) * nclones);
+        for (int c = 0; c < nclones; c++) origin[c] = (int)(clones[c].origin - functions);
+        for (int c = 0; c < nclones; c++) {
+            SpecClone* cl = &clones[c];
+            FunctionInfo* fi = ft_clone(&functions[origin[c]], cl->name);
+            functions = ft_get_all(NULL);
+            const FunctionInfo* g = &functions[origin[c]];
+            fi->param_count = 0;
+            for (int k = 0; k < g->param_count; k++) {
+                if (cl->key[k]) continue;
+                fi->params[fi->param_count] = g->params[k];
+                strcpy(fi->params[fi->param_count].name, names[c][k]);
+                fi->param_count++;
+            }
+            fi->quad_start = cl->start;
+            fi->quad_end = cl->end;
+
+            if (ctx->opts->report) {
+                fprintf(ctx->opts->report, "  fonction '%s' : clone '%s' (", g->name, cl->name);
+                for (int k = 0, first = 1; k < g->param_count; k++) {
+                    if (!cl->key[k]) continue;
+                    fprintf(ctx->opts->report, "%s%s = %s", first ? "" : ", ",
+                            g->params[k].name, cl->key[k]);
+                    first = 0;
+                }
+                fprintf(ctx->opts->report, "), %d appel(s), %+d quadruplet(s)\n",
+                        cl->calls, cl->end - cl->start);
+            }
+        }
+        free(origin);
+        free(names);
+        free(clone_at);
+        opt_index_invalidate();
+    }
+
+    for (int c = 0; c < nclones; c++) {
+        for (int k = 0; k < FT_MAX_PARAMS; k++) free(clones[c].key[k]);
+    }
+    free(clones);
+    free(drop);
+    free_sites(sites, count);
+    *cloned = nclones;
+    return propagated;
+}
@@ -0,0 +1,679 @@
+#include "optimizer.h"
+#include <stdlib.h>
+#include <string.h>
+
+/* ========================================================= */
+/*  FORME D'UNE BOUCLE POUR                                   */
+/* ========================================================= */
+
+static int same(const char* a, const char* b) {
+    return a && b && strcmp(a, b) == 0;
+}
+
+/* Verifie que les indices de li correspondent encore au motif genere
+   par instruction_pour (init, BG, ..., +, :=, BR), avec les bornes et
+   le pas enregistres : une passe qui les aurait reecrits dans les
+   quadruplets rendrait li->start, li->end ou li->step perimes */
+static int loop_has_pour_shape(const QuadList* list, const LoopInfo* li) {
+    if (li->removed) return 0;
+    if (li->init_quad < 0 || li->exit_quad > list->count) return 0;
+    if (!(li->init_quad < li->test_quad && li->test_quad < li->incr_quad &&
+          li->incr_quad + 1 < li->back_quad && li->back_quad < li->exit_quad))
+        return 0;
+
+    const Quadruplet* init = &list->quads[li->init_quad];
+    const Quadruplet* test = &list->quads[li->test_quad];
+    const Quadruplet* incr = &list->quads[li->incr_quad];
+    const Quadruplet* store = &list->quads[li->incr_quad + 1];
+    const Quadruplet* back = &list->quads[li->back_quad];
+
+    return init->op == QUAD_ASSIGN && same(init->result, li->var) &&
+           same(init->arg1, li->start) &&
+           test->op == QUAD_BG && same(test->arg1, li->var) && same(test->arg2, li->end) &&
+           incr->op == QUAD_ADD && same(incr->arg1, li->var) && same(incr->arg2, li->step) &&
+           store->op == QUAD_ASSIGN && same(store->arg1, incr->result) &&
+           same(store->result, li->var) &&
+           back->op == QUAD_BR && getQuadTarget(back) == li->test_quad;
+}
+
+/* ========================================================= */
+/*  NOMBRE D'ITERATIONS                                       */
+/* ========================================================= */
+
+int opt_compute_trip_counts(OptContext* ctx) {
+    int count, known = 0;
+    LoopInfo* loops = lt_get_all(&count);
+
+    for (int l = 0; l < count; l++) {
+        LoopInfo* li = &loops[l];
+        li->trip_count = -1;
+        if (!loop_has_pour_shape(ctx->list, li)) continue;
+
+        long start, end, step;
+        if (!opt_int_literal(li->start, &start) || !opt_int_literal(li->end, &end) ||
+            !opt_int_literal(li->step, &step))
+            continue;
+        /* La variable ne doit etre modifiee que par l'incrementation */
+        if (opt_count_defs(ctx->list, li->var, li->test_quad + 1, li->incr_quad) > 0)
+            continue;
+
+        if (start > end) {
+            li->trip_count = 0;
+        } else if (step > 0) {
+            li->trip_count = (long)(((unsigned long)end - (unsigned long)start) / (unsigned long)step) + 1;
+        } else {
+            continue; /* pas nul ou negatif : la boucle ne termine pas */
+        }
+        known++;
+    }
+    return known;
+}
+
+/* ========================================================= */
+/*  ORDRE DE TRAITEMENT DES BOUCLES                           */
+/* ========================================================= */
+/*
+ * Une passe qui reecrit une boucle a la fois recopierait toute la liste
+ * pour chaque boucle. Les passes traitent plutot les boucles par
+ * hauteur croissante dans l'arbre d'imbrication (0 : aucune boucle
+ * interne) : chaque boucle l'est encore apres ses boucles internes, et
+ * les boucles d'une meme hauteur, disjointes, partagent une seule
+ * reecriture.
+ */
+
+typedef struct {
+    LoopInfo** loops;    /* boucles de forme POUR, par debut croissant */
+    int* height;
+    int count;
+    int max_height;      /* -1 sans boucle */
+} LoopOrder;
+
+static int by_test_quad(const void* a, const void* b) {
+    const LoopInfo* x = *(const LoopInfo* const*)a;
+    const LoopInfo* y = *(const LoopInfo* const*)b;
+    return (x->test_quad > y->test_quad) - (x->test_quad < y->test_quad);
+}
+
+static void loop_order_begin(LoopOrder* order, const QuadList* list) {
+    int count;
+    LoopInfo* loops = lt_get_all(&count);
+    order->loops = (LoopInfo**)malloc(sizeof(LoopInfo*) * (count + 1));
+    order->height = (int*)malloc(sizeof(int) * (count + 1));
+    int* stack = (int*)malloc(sizeof(int) * (count + 1));
+
+    int n = 0;
+    for (int l = 0; l < count; l++) {
+        if (loop_has_pour_shape(list, &loops[l])) order->loops[n++] = &loops[l];
+    }
+    qsort(order->loops, n, sizeof(LoopInfo*), by_test_quad);
+
+    LoopInfo** sorted = order->loops;
+    int* height = order->height;
+    int top = 0, max = n > 0 ? 0 : -1;
+    for (int k = 0; k <= n; k++) {
+        if (k < n) height[k] = 0;
+        /* Fermer les boucles qui finissent avant celle-ci */
+        while (top > 0 && (k == n || sorted[stack[top - 1]]->back_quad < sorted[k]->test_quad)) {
+            int inner = stack[--top];
+            if (height[inner] > max) max = height[inner];
+            if (top > 0 && height[stack[top - 1]] < height[inner] + 1)
+                height[stack[top - 1]] = height[inner] + 1;
+        }
+        if (k < n) stack[top++] = k;
+    }
+    free(stack);
+    order->count = n;
+    order->max_height = max;
+}
+
+static void loop_order_end(LoopOrder* order) {
+    free(order->loops);
+    free(order->height);
+}
+
+/* ========================================================= */
+/*  REDUCTION DE FORCE DES VARIABLES D'INDUCTION              */
+/* ========================================================= */
+/*
+ * Dans le corps d'une boucle POUR, la variable i n'est modifiee que
+ * par "i := i + pas". Toute expression  t = i * k  (k invariant) ou
+ * t = i * i  est alors une variable d'induction derivee : au lieu de
+ * la recalculer a chaque tour, on la maintient dans un accumulateur
+ * initialise avant la boucle et mis a jour juste apres i :
+ *
+ *   i * k :  a <- i * k            ; a <- a + pas*k
+ *   i * i :  a <- i * i ;          ; a <- a + d
+ *            d <- i * 2pas + pas^2 ; d <- d + 2pas^2
+ *
+ * Les calculs restent entiers (Z) : l'egalite a == i*k est exacte,
+ * y compris en cas de depassement (arithmetique modulo 2^64).
+ */
+
+typedef enum { IV_LINEAR, IV_SQUARE } IvKind;
+
+typedef struct {
+    IvKind kind;
+    char* factor;    /* k (IV_LINEAR) */
+    char* acc;       /* accumulateur a */
+    char* delta;     /* increment de a : litteral ou temporaire */
+    char* delta2;    /* IV_SQUARE : d, et son increment */
+    char* delta2_incr;
+} DerivedIv;
+
+#define MAX_DERIVED_IV 32
+
+static int loop_has_call(const QuadList* list, int from, int to) {
+    for (int i = from; i < to; i++) {
+        if (list->quads[i].op == QUAD_CALL) return 1;
+    }
+    return 0;
+}
+
+/* Ce que la recherche des IV derivees sait d'une boucle, calcule une
+   fois pour toute la boucle : le corps n'est parcouru qu'une fois, et
+   non a chaque multiplication */
+typedef struct {
+    const LoopInfo* li;
+    FunctionInfo* fn;
+    int has_call;
+    OptDefIndex defs;        /* definitions dans [test_quad, back_quad) */
+    const char** outer_vars; /* variables entieres des boucles englobantes */
+    int outer_count;
+} LoopScan;
+
+static void scan_begin(LoopScan* scan, const OptContext* ctx, const LoopInfo* li, FunctionInfo* fn) {
+    scan->li = li;
+    scan->fn = fn;
+    scan->has_call = loop_has_call(ctx->list, li->test_quad, li->back_quad);
+    opt_defs_build(&scan->defs, ctx->list, li->test_quad, li->back_quad);
+
+    int count;
+    LoopInfo* loops = lt_get_all(&count);
+    scan->outer_vars = (const char**)malloc(sizeof(const char*) * (count + 1));
+    scan->outer_count = 0;
+    for (int l = 0; l < count; l++) {
+        const LoopInfo* outer = &loops[l];
+        if (outer == li || outer->removed) continue;
+        if (outer->test_quad < li->test_quad && li->back_quad < outer->back_quad &&
+            opt_addr_type(ctx, outer->start, fn) == TYPE_Z)
+            scan->outer_vars[scan->outer_count++] = outer->var;
+    }
+}
+
+static void scan_end(LoopScan* scan) {
+    opt_defs_free(&scan->defs);
+    free(scan->outer_vars);
+}
+
+/* addr est-elle la variable (entiere) d'une boucle POUR englobant la boucle ? */
+static int is_enclosing_loop_var(const LoopScan* scan, const char* addr) {
+    for (int k = 0; k < scan->outer_count; k++) {
+        if (same(scan->outer_vars[k], addr)) return 1;
+    }
+    return 0;
+}
+
+/* k est-il un entier invariant dans la boucle ? */
+static int is_invariant_int(const OptContext* ctx, const LoopScan* scan, const char* addr) {
+    if (opt_int_literal(addr, NULL)) return 1;
+    if (is_enclosing_loop_var(scan, addr))
+        return opt_defs_count(&scan->defs, addr) == 0;
+    if (opt_addr_type(ctx, addr, scan->fn) != TYPE_Z) return 0;
+    if (opt_defs_count(&scan->defs, addr) > 0) return 0;
+
+    int is_param = 0;
+    if (scan->fn) {
+        for (int p = 0; p < scan->fn->param_count; p++) {
+            if (strcmp(scan->fn->params[p].name, addr) == 0) is_param = 1;
+        }
+    }
+    if (!is_param && scan->has_call) {
+        /* Une variable globale peut etre modifiee par l'appel, sauf constante */
+        SymbolEntry* e = ctx->table ? find_symbol(ctx->table, addr) : NULL;
+        if (!e || !e->is_const) return 0;
+    }
+    return 1;
+}
+
+static char* literal_of(long v) {
+    char* s = (char*)malloc(32);
+    sprintf(s, "%ld", v);
+    return s;
+}
+
+static void free_ivs(DerivedIv* ivs, int n) {
+    for (int k = 0; k < n; k++) {
+        free(ivs[k].factor);
+        free(ivs[k].acc);
+        free(ivs[k].delta);
+        free(ivs[k].delta2);
+        free(ivs[k].delta2_incr);
+    }
+}
+
+/* Indice de l'IV derivee correspondant au quadruplet q, -1 sinon */
+static int match_derived(const OptContext* ctx, const LoopScan* scan,
+                         const Quadruplet* q, IvKind* kind, const char** factor) {
+    const LoopInfo* li = scan->li;
+    if (q->op != QUAD_MUL || !q->result) return 0;
+    if (strcmp(q->result, li->var) == 0) return 0;
+    /* Un temporaire defini une seule fois dans la boucle */
+    if (opt_defs_count(&scan->defs, q->result) != 1) return 0;
+
+    int left = same(q->arg1, li->var);
+    int right = same(q->arg2, li->var);
+    if (left && right) {
+        *kind = IV_SQUARE;
+        *factor = NULL;
+        return 1;
+    }
+    if (left && is_invariant_int(ctx, scan, q->arg2)) {
+        *kind = IV_LINEAR;
+        *factor = q->arg2;
+        return 1;
+    }
+    if (right && is_invariant_int(ctx, scan, q->arg1)) {
+        *kind = IV_LINEAR;
+        *factor = q->arg1;
+        return 1;
+    }
+    return 0;
+}
+
+static int find_iv(DerivedIv* ivs, int n, IvKind kind, const char* factor) {
+    for (int k = 0; k < n; k++) {
+        if (ivs[k].kind != kind) continue;
+        if (kind == IV_SQUARE || same(ivs[k].factor, factor)) return k;
+    }
+    return -1;
+}
+
+/* Emet (dans le prologue) a <- x op y, ou renvoie un litteral si x et y
+   sont des litteraux dont le resultat tient dans un long */
+static char* fold_or_emit(QuadRewrite* rw, QuadOp op, const char* x, const char* y) {
+    long a, b, r;
+    if (opt_int_literal(x, &a) && opt_int_literal(y, &b)) {
+        int overflow = (op == QUAD_MUL) ? __builtin_mul_overflow(a, b, &r)
+                                        : __builtin_add_overflow(a, b, &r);
+        if (!overflow) return literal_of(r);
+    }
+    char* t = newTemp();
+    rw_emit(rw, op, x, y, t);
+    return t;
+}
+
+/* Reduction prevue pour une boucle : IV derivees, et pour chaque
+   quadruplet du corps l'indice de son IV (-1 : copie telle quelle) */
+typedef struct {
+    LoopInfo* li;
+    DerivedIv ivs[MAX_DERIVED_IV];
+    int niv;
+    int replaced;
+    int* which;
+} ReducePlan;
+
+static int plan_reduction(OptContext* ctx, LoopInfo* li, ReducePlan* plan) {
+    QuadList* list = ctx->list;
+    const char* step = list->quads[li->incr_quad].arg2;
+    FunctionInfo* fn = opt_owner_function(li->test_quad);
+
+    /* i doit etre entiere : depart et pas entiers */
+    if (opt_addr_type(ctx, li->start, fn) != TYPE_Z) return 0;
+    if (opt_count_defs(list, li->var, li->test_quad + 1, li->incr_quad) > 0) return 0;
+
+    LoopScan scan;
+    scan_begin(&scan, ctx, li, fn);
+    if (!is_invariant_int(ctx, &scan, step)) {
+        scan_end(&scan);
+        return 0;
+    }
+
+    /* Recenser les IV derivees (une par facteur distinct) */
+    DerivedIv* ivs = plan->ivs;
+    int niv = 0, replaced = 0;
+    int* which = (int*)malloc(sizeof(int) * (li->incr_quad - li->test_quad));
+    for (int i = li->test_quad + 1; i < li->incr_quad; i++) {
+        IvKind kind;
+        const char* factor;
+        which[i - li->test_quad] = -1;
+        if (!match_derived(ctx, &scan, &list->quads[i], &kind, &factor)) continue;
+
+        int k = find_iv(ivs, niv, kind, factor);
+        if (k < 0) {
+            if (niv >= MAX_DERIVED_IV) continue;
+            k = niv++;
+            memset(&ivs[k], 0, sizeof(ivs[k]));
+            ivs[k].kind = kind;
+            ivs[k].factor = factor ? stringDuplicate(factor) : NULL;
+        }
+        which[i - li->test_quad] = k;
+        replaced++;
+    }
+    scan_end(&scan);
+    if (niv == 0) {
+        free(which);
+        return 0;
+    }
+    plan->li = li;
+    plan->niv = niv;
+    plan->replaced = replaced;
+    plan->which = which;
+    return 1;
+}
+
+/* Emet la boucle reduite a la place de [test_quad, back_quad) ; rw a
+   deja copie tout ce qui precede test_quad */
+static void emit_reduction(QuadRewrite* rw, const QuadList* list, ReducePlan* plan) {
+    const LoopInfo* li = plan->li;
+    const char* step = list->quads[li->incr_quad].arg2;
+
+    /* Prologue : valeurs initiales des accumulateurs */
+    for (int k = 0; k < plan->niv; k++) {
+        DerivedIv* iv = &plan->ivs[k];
+        iv->acc = newTemp();
+        if (iv->kind == IV_LINEAR) {
+            rw_emit(rw, QUAD_MUL, li->var, iv->factor, iv->acc);
+            iv->delta = fold_or_emit(rw, QUAD_MUL, step, iv->factor);
+        } else {
+            rw_emit(rw, QUAD_MUL, li->var, li->var, iv->acc);
+            char* two_step = fold_or_emit(rw, QUAD_ADD, step, step);
+            char* step_sq = fold_or_emit(rw, QUAD_MUL, step, step);
+            iv->delta2_incr = fold_or_emit(rw, QUAD_MUL, two_step, step);
+            iv->delta2 = newTemp();
+            char* t = newTemp();
+            rw_emit(rw, QUAD_MUL, li->var, two_step, t);
+            rw_emit(rw, QUAD_ADD, t, step_sq, iv->delta2);
+            free(t);
+            free(two_step);
+            free(step_sq);
+        }
+    }
+
+    /* Corps : t = i*k devient t := a */
+    for (int i = li->test_quad; i < li->incr_quad; i++) {
+        int k = (i > li->test_quad) ? plan->which[i - li->test_quad] : -1;
+        if (k < 0) {
+            rw_copy(rw, i);
+            continue;
+        }
+        rw_mark(rw, i);
+        rw_emit(rw, QUAD_ASSIGN, plan->ivs[k].acc, NULL, list->quads[i].result);
+    }
+
+    /* Incrementation de i, puis des accumulateurs */
+    rw_copy_range(rw, li->incr_quad, li->back_quad);
+    for (int k = 0; k < plan->niv; k++) {
+        DerivedIv* iv = &plan->ivs[k];
+        if (iv->kind == IV_LINEAR) {
+            rw_emit(rw, QUAD_ADD, iv->acc, iv->delta, iv->acc);
+        } else {
+            rw_emit(rw, QUAD_ADD, iv->acc, iv->delta2, iv->acc);
+            rw_emit(rw, QUAD_ADD, iv->delta2, iv->delta2_incr, iv->delta2);
+        }
+    }
+}
+
+/* Par hauteur (voir LoopOrder) : une reecriture par niveau d'imbrication */
+int opt_strength_reduce(OptContext* ctx) {
+    int total = 0;
+    LoopOrder order;
+    loop_order_begin(&order, ctx->list);
+    ReducePlan* plans = (ReducePlan*)malloc(sizeof(ReducePlan) * (order.count + 1));
+
+    for (int h = 0; h <= order.max_height; h++) {
+        /* Les plans suivent l'ordre des boucles : celui de la reecriture */
+        int planned = 0;
+        for (int k = 0; k < order.count; k++) {
+            LoopInfo* li = order.loops[k];
+            if (order.height[k] != h || !loop_has_pour_shape(ctx->list, li)) continue;
+            if (plan_reduction(ctx, li, &plans[planned])) planned++;
+        }
+        if (planned == 0) continue;
+
+        QuadList* list = ctx->list;
+        QuadRewrite rw;
+        rw_begin(&rw, list);
+        int cursor = 0;
+        for (int p = 0; p < planned; p++) {
+            rw_copy_range(&rw, cursor, plans[p].li->test_quad);
+            emit_reduction(&rw, list, &plans[p]);
+            cursor = plans[p].li->back_quad;
+        }
+        rw_copy_range(&rw, cursor, list->count);
+        rw_commit(&rw);
+
+        for (int p = 0; p < planned; p++) {
+            const LoopInfo* li = plans[p].li;
+            if (ctx->opts->report) {
+                fprintf(ctx->opts->report,
+                        "  boucle POUR '%s' (ligne %d) : %d expression(s) derivee(s), %d accumulateur(s)",
+                        li->var, li->line, plans[p].replaced, plans[p].niv);
+                if (li->trip_count >= 0)
+                    fprintf(ctx->opts->report, ", %ld iteration(s)", li->trip_count);
+                fprintf(ctx->opts->report, "\n");
+            }
+            total += plans[p].replaced;
+            free_ivs(plans[p].ivs, plans[p].niv);
+            free(plans[p].which);
+        }
+    }
+
+    loop_order_end(&order);
+    free(plans);
+    return total;
+}
+
+/* ========================================================= */
+/*  DEROULEMENT DES BOUCLES                                   */
+/* ========================================================= */
+/*
+ * Complet : une boucle dont le nombre d'iterations n est connu et petit
+ * devient n copies de (corps ; i := i + pas), sans test ni retour.
+ *
+ * Partiel (facteur F) : la boucle principale execute F copies par tour
+ * tant que i <= fin - (F-1)*pas ; la boucle d'origine, conservee a la
+ * suite, termine les iterations restantes :
+ *
+ *          lim <- fin - (F-1)*pas
+ *   M :    BG i, lim, R
+ *          corps ; i := i + pas     (F fois)
+ *          BR M
+ *   R :    BG i, fin, sortie        (boucle d'origine)
+ *          ...
+ */
+
+#define UNROLL_FULL_MAX_TRIP 16      /* iterations max d'un deroulement complet */
+#define UNROLL_MAX_QUADS 256         /* taille max du corps deroule */
+
+/* Les branchements du corps ne doivent viser ni le test ni le BR de
+   retour : une copie ne saurait pas ou les renvoyer. */
+static int loop_can_unroll(const QuadList* list, const LoopInfo* li) {
+    for (int i = li->test_quad + 1; i < li->back_quad; i++) {
+        int target = getQuadTarget(&list->quads[i]);
+        if (target == li->test_quad || target == li->back_quad) return 0;
+    }
+    return 1;
+}
+
+static void mark_inner_loops_removed(const LoopInfo* li) {
+    int count;
+    LoopInfo* loops = lt_get_all(&count);
+    for (int l = 0; l < count; l++) {
+        if (&loops[l] != li && loops[l].test_quad > li->test_quad &&
+            loops[l].back_quad < li->back_quad)
+            loops[l].removed = 1;
+    }
+}
+
+static void report_unroll(const OptContext* ctx, const LoopInfo* li,
+                          const char* what, int growth) {
+    if (!ctx->opts->report) return;
+    fprintf(ctx->opts->report, "  boucle POUR '%s' (ligne %d) : %s, %+d quadruplet(s)\n",
+            li->var, li->line, what, growth);
+}
+
+/* Deroulement prevu pour une boucle */
+typedef struct {
+    LoopInfo* li;
+    long span;           /* partiel : (F-1) * pas */
+    int growth;          /* quadruplets ajoutes */
+} UnrollPlan;
+
+/* "check" retient une boucle ; "emit" la remplace dans rw (qui a copie
+   tout ce qui precede test_quad) et renvoie l'indice d'origine ou la
+   copie reprend */
+typedef int (*UnrollCheck)(OptContext* ctx, LoopInfo* li, UnrollPlan* plan);
+typedef int (*UnrollEmit)(OptContext* ctx, QuadRewrite* rw, UnrollPlan* plan);
+
+/* Par hauteur (voir LoopOrder) ; renvoie le nombre de boucles deroulees */
+static int unroll_by_height(OptContext* ctx, UnrollCheck check, UnrollEmit emit,
+                            void (*report)(const OptContext*, const UnrollPlan*)) {
+    int total = 0;
+    LoopOrder order;
+    loop_order_begin(&order, ctx->list);
+    UnrollPlan* plans = (UnrollPlan*)malloc(sizeof(UnrollPlan) * (order.count + 1));
+
+    for (int h = 0; h <= order.max_height; h++) {
+        int planned = 0;
+        for (int k = 0; k < order.count; k++) {
+            LoopInfo* li = order.loops[k];
+            if (order.height[k] != h || !loop_has_pour_shape(ctx->list, li)) continue;
+            plans[planned].li = li;
+            if (check(ctx, li, &plans[planned])) planned++;
+        }
+        if (planned == 0) continue;
+
+        QuadList* list = ctx->list;
+        QuadRewrite rw;
+        rw_begin(&rw, list);
+        int cursor = 0;
+        for (int p = 0; p < planned; p++) {
+            rw_copy_range(&rw, cursor, plans[p].li->test_quad);
+            cursor = emit(ctx, &rw, &plans[p]);
+        }
+        rw_copy_range(&rw, cursor, list->count);
+        rw_commit(&rw);
+
+        for (int p = 0; p < planned; p++) report(ctx, &plans[p]);
+        total += planned;
+    }
+
+    loop_order_end(&order);
+    free(plans);
+    return total;
+}
+
+static int check_unroll_full(OptContext* ctx, LoopInfo* li, UnrollPlan* plan) {
+    (void)plan;
+    if (li->trip_count < 0 || li->trip_count > UNROLL_FULL_MAX_TRIP) return 0;
+
+    /* Une copie = corps + incrementation (sans le BR de retour) */
+    int size = li->back_quad - (li->test_quad + 1);
+    if (size * li->trip_count > UNROLL_MAX_QUADS) return 0;
+    return loop_can_unroll(ctx->list, li);
+}
+
+/* Remplace [test_quad, exit_quad) par trip_count copies du corps */
+static int emit_unroll_full(OptContext* ctx, QuadRewrite* rw, UnrollPlan* plan) {
+    (void)ctx;
+    LoopInfo* li = plan->li;
+    int first = rw_position(rw);
+    rw_mark(rw, li->test_quad);
+    for (long k = 0; k < li->trip_count; k++) {
+        rw_copy_block(rw, li->test_quad + 1, li->back_quad);
+    }
+    plan->growth = (rw_position(rw) - first) - (li->exit_quad - li->test_quad);
+
+    /* Les boucles internes n'existent plus qu'en copies */
+    mark_inner_loops_removed(li);
+    li->removed = 1;
+    return li->exit_quad;
+}
+
+static void report_unroll_full(const OptContext* ctx, const UnrollPlan* plan) {
+    char what[64];
+    snprintf(what, sizeof(what), "deroulee completement (%ld iteration(s))", plan->li->trip_count);
+    report_unroll(ctx, plan->li, what, plan->growth);
+}
+
+int opt_unroll_full(OptContext* ctx) {
+    return unroll_by_height(ctx, check_unroll_full, emit_unroll_full, report_unroll_full);
+}
+
+/* La borne de fin doit etre un entier invariant dans la boucle */
+static int end_is_invariant_int(const OptContext* ctx, const LoopInfo* li, FunctionInfo* fn) {
+    if (opt_value_type(ctx, li->end, fn) != TYPE_Z) return 0;
+    if (opt_int_literal(li->end, NULL)) return 1;
+    if (opt_count_defs(ctx->list, li->end, li->test_quad, li->back_quad) > 0) return 0;
+
+    /* Variable globale non constante : un appel peut la modifier */
+    if (loop_has_call(ctx->list, li->test_quad, li->back_quad)) {
+        int is_param = 0;
+        if (fn) {
+            for (int p = 0; p < fn->param_count; p++) {
+                if (strcmp(fn->params[p].name, li->end) == 0) is_param = 1;
+            }
+        }
+        SymbolEntry* e = ctx->table ? find_symbol(ctx->table, li->end) : NULL;
+        if (!is_param && e && !e->is_const) return 0;
+    }
+    return 1;
+}
+
+static int check_unroll_partial(OptContext* ctx, LoopInfo* li, UnrollPlan* plan) {
+    QuadList* list = ctx->list;
+    int factor = ctx->opts->unroll_factor;
+    if (li->trip_count >= 0 && li->trip_count < factor) return 0;
+
+    long step;
+    if (!opt_int_literal(list->quads[li->incr_quad].arg2, &step) || step <= 0) return 0;
+    if (opt_count_defs(list, li->var, li->test_quad + 1, li->incr_quad) > 0) return 0;
+
+    FunctionInfo* fn = opt_owner_function(li->test_quad);
+    if (opt_value_type(ctx, li->start, fn) != TYPE_Z) return 0;
+    if (!end_is_invariant_int(ctx, li, fn)) return 0;
+
+    int size = li->back_quad - (li->test_quad + 1);
+    if (factor < 2 || size > UNROLL_MAX_QUADS / factor) return 0;
+    if (!loop_can_unroll(list, li)) return 0;
+
+    return !__builtin_mul_overflow(step, (long)(factor - 1), &plan->span);
+}
+
+/* Emet la boucle deroulee devant la boucle d'origine, qui est copiee
+   ensuite telle quelle (reprise a test_quad) */
+static int emit_unroll_partial(OptContext* ctx, QuadRewrite* rw, UnrollPlan* plan) {
+    const LoopInfo* li = plan->li;
+    const QuadList* list = rw->src;
+    int factor = ctx->opts->unroll_factor;
+    int first = rw_position(rw);
+
+    char* span_lit = literal_of(plan->span);
+    char* limit = newTemp();
+    rw_emit(rw, QUAD_SUB, li->end, span_lit, limit);
+    free(span_lit);
+
+    int head = rw_emit(rw, QUAD_BG, li->var, limit, NULL);
+    rw_set_target(rw, head, li->test_quad, 1);
+    free(limit);
+    for (int k = 0; k < factor; k++) {
+        rw_copy_block(rw, li->test_quad + 1, li->back_quad);
+    }
+    int back = rw_emit(rw, QUAD_BR, NULL, NULL, NULL);
+    rw_set_target(rw, back, head, 0);
+    setQuadLocation(rw->out, back, list->quads[li->back_quad].line, list->quads[li->back_quad].column);
+
+    /* Boucle d'origine : iterations restantes (moins de F) */
+    plan->growth = rw_position(rw) - first;
+    return li->test_quad;
+}
+
+static void report_unroll_partial(const OptContext* ctx, const UnrollPlan* plan) {
+    char what[64];
+    snprintf(what, sizeof(what), "deroulee par %d", ctx->opts->unroll_factor);
+    report_unroll(ctx, plan->li, what, plan->growth);
+}
+
+int opt_unroll_partial(OptContext* ctx) {
+    return unroll_by_height(ctx, check_unroll_partial, emit_unroll_partial, report_unroll_partial);
+}
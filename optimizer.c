@@ -0,0 +1,516 @@
+#include "optimizer.h"
+#include <stdlib.h>
+#include <string.h>
+#include <errno.h>
+
+/* ========================================================= */
+/*  OPTIONS                                                   */
+/* ========================================================= */
+
+void opt_default_options(OptOptions* opts) {
+    if (!opts) return;
+    memset(opts, 0, sizeof(*opts));
+    opts->level = 1;
+    opts->strength_reduction = 1;
+    opts->const_calls = 1;
+    opts->specialize = 1;
+    opts->tail_calls = 1;
+    opts->inlining = 1;
+    opts->unroll = 1;
+    opts->unroll_factor = 4;
+    opts->report = stdout;
+}
+
+/* ========================================================= */
+/*  UTILITAIRES                                               */
+/* ========================================================= */
+
+/* Index de la liste en cours d'optimisation, reconstruit a la demande
+   apres chaque reecriture (opt_index_invalidate) :
+     - defs / next_def : definitions de chaque nom, chainees par indice,
+     - owner : fonction de chaque quadruplet (indice dans ft_get_all). */
+static struct {
+    const QuadList* list;       /* NULL : definitions a reconstruire */
+    OptDefIndex defs;
+    int* next_def;              /* definition suivante du meme nom, -1 */
+    int owner_valid;
+    int* owner;                 /* -1 : programme principal */
+    int owner_size;
+    int fcount;                 /* fonctions connues a la construction */
+} g_index;
+
+void opt_index_invalidate(void) {
+    opt_defs_free(&g_index.defs);
+    free(g_index.next_def);
+    free(g_index.owner);
+    memset(&g_index, 0, sizeof(g_index));
+}
+
+static void build_owner_index(void) {
+    int count;
+    FunctionInfo* functions = ft_get_all(&count);
+    int size = 0;
+    for (int f = 0; f < count; f++) {
+        if (functions[f].quad_end > size) size = functions[f].quad_end;
+    }
+    free(g_index.owner);
+    g_index.owner = (int*)malloc(sizeof(int) * (size + 1));
+    if (!g_index.owner) {
+        perror("malloc owner");
+        exit(EXIT_FAILURE);
+    }
+    for (int i = 0; i < size; i++) g_index.owner[i] = -1;
+    /* Meme resultat que le parcours des fonctions : la premiere gagne */
+    for (int f = count - 1; f >= 0; f--) {
+        for (int i = functions[f].quad_start; i >= 0 && i < functions[f].quad_end; i++)
+            g_index.owner[i] = f;
+    }
+    g_index.owner_size = size;
+    g_index.fcount = count;
+    g_index.owner_valid = 1;
+}
+
+FunctionInfo* opt_owner_function(int index) {
+    int count;
+    FunctionInfo* functions = ft_get_all(&count);
+    if (!g_index.owner_valid || g_index.fcount != count) build_owner_index();
+    if (index < 0 || index >= g_index.owner_size || g_index.owner[index] < 0) return NULL;
+    return &functions[g_index.owner[index]];
+}
+
+static void build_def_index(const QuadList* list) {
+    opt_defs_free(&g_index.defs);
+    free(g_index.next_def);
+    opt_defs_build(&g_index.defs, list, 0, list->count);
+
+    int* last = (int*)malloc(sizeof(int) * g_index.defs.capacity);
+    g_index.next_def = (int*)malloc(sizeof(int) * (list->count + 1));
+    if (!last || !g_index.next_def) {
+        perror("malloc defs");
+        exit(EXIT_FAILURE);
+    }
+    for (int k = 0; k < g_index.defs.capacity; k++) last[k] = -1;
+    for (int i = 0; i < list->count; i++) {
+        const Quadruplet* q = &list->quads[i];
+        g_index.next_def[i] = -1;
+        if (!q->result || !isAssigningOp(q->op)) continue;
+        int slot = (int)(opt_defs_find(&g_index.defs, q->result) - g_index.defs.slots);
+        if (last[slot] >= 0) g_index.next_def[last[slot]] = i;
+        last[slot] = i;
+    }
+    free(last);
+    g_index.list = list;
+}
+
+int opt_is_temp(const OptContext* ctx, const char* addr) {
+    if (!addr || addr[0] != 'T' || !addr[1]) return 0;
+    for (const char* p = addr + 1; *p; p++) {
+        if (*p < '0' || *p > '9') return 0;
+    }
+    return !ctx->table || !find_symbol(ctx->table, addr);
+}
+
+int opt_int_literal(const char* addr, long* value) {
+    if (!addr || !*addr) return 0;
+    const char* p = addr;
+    if (*p == '-') p++;
+    if (*p < '0' || *p > '9') return 0;
+    for (; *p; p++) {
+        if (*p < '0' || *p > '9') return 0;
+    }
+    errno = 0;
+    long v = strtol(addr, NULL, 10);
+    if (errno == ERANGE) return 0;
+    if (value) *value = v;
+    return 1;
+}
+
+DataType opt_addr_type(const OptContext* ctx, const char* addr, FunctionInfo* fn) {
+    if (!addr || !*addr) return TYPE_UNKNOWN;
+    if (opt_int_literal(addr, NULL)) return TYPE_Z;
+
+    if (fn) {
+        for (int p = 0; p < fn->param_count; p++) {
+            if (strcmp(fn->params[p].name, addr) == 0) return fn->params[p].type;
+        }
+    }
+    if (ctx->table) {
+        SymbolEntry* e = find_symbol(ctx->table, addr);
+        if (e && (e->category == SYMBOL_VARIABLE || e->category == SYMBOL_CONSTANT))
+            return e->type;
+    }
+    return TYPE_UNKNOWN;
+}
+
+/* Type d'une definition ; les operandes egaux a "self" (a <- a * n)
+   prennent le type de l'autre operande */
+static DataType value_type_rec(const OptContext* ctx, const char* addr, FunctionInfo* fn, int depth);
+
+static DataType join_numeric(DataType a, DataType b) {
+    if ((a != TYPE_Z && a != TYPE_R) || (b != TYPE_Z && b != TYPE_R)) return TYPE_UNKNOWN;
+    return (a == TYPE_R || b == TYPE_R) ? TYPE_R : TYPE_Z;
+}
+
+static DataType def_type(const OptContext* ctx, const Quadruplet* q, FunctionInfo* fn, int depth) {
+    const char* self = q->result;
+    DataType t1 = (q->arg1 && strcmp(q->arg1, self) == 0) ? TYPE_UNKNOWN
+                                                          : value_type_rec(ctx, q->arg1, fn, depth);
+    DataType t2 = (q->arg2 && strcmp(q->arg2, self) == 0) ? TYPE_UNKNOWN
+                                                          : value_type_rec(ctx, q->arg2, fn, depth);
+    if (q->arg1 && strcmp(q->arg1, self) == 0) t1 = t2;
+    if (q->arg2 && strcmp(q->arg2, self) == 0) t2 = t1;
+
+    switch (q->op) {
+        case QUAD_ADD:
+        case QUAD_SUB:
+        case QUAD_MUL:
+            return join_numeric(t1, t2);
+        case QUAD_MOD:
+        case QUAD_DIV_INT:
+            return TYPE_Z;
+        case QUAD_DIV:
+            return join_numeric(t1, t2) != TYPE_UNKNOWN ? TYPE_R : TYPE_UNKNOWN;
+        case QUAD_POW:
+            return join_numeric(t1, t2);
+        case QUAD_NEG:
+        case QUAD_ABS:
+        case QUAD_ASSIGN:
+            return t1;
+        case QUAD_EQ: case QUAD_NEQ: case QUAD_LT: case QUAD_GT:
+        case QUAD_LEQ: case QUAD_GEQ:
+        case QUAD_AND: case QUAD_OR: case QUAD_NOT: case QUAD_XOR:
+            return TYPE_B;
+        case QUAD_SIN: case QUAD_COS: case QUAD_EXP: case QUAD_LOG:
+        case QUAD_SQRT: case QUAD_FLOOR: case QUAD_CEIL: case QUAD_ROUND:
+            return (t1 == TYPE_Z || t1 == TYPE_R) ? TYPE_R : TYPE_UNKNOWN;
+        case QUAD_CALL: {
+            FunctionInfo* callee = ft_find(q->arg1);
+            return callee ? callee->return_type : TYPE_UNKNOWN;
+        }
+        default:
+            return TYPE_UNKNOWN;
+    }
+}
+
+static DataType value_type_rec(const OptContext* ctx, const char* addr, FunctionInfo* fn, int depth) {
+    if (!addr || !*addr || depth > 8) return TYPE_UNKNOWN;
+    DataType t = opt_addr_type(ctx, addr, fn);
+    if (t != TYPE_UNKNOWN) return t;
+
+    /* Litteraux */
+    if (addr[0] == '\'') return TYPE_CHAR;
+    if (addr[0] == '"') return TYPE_SIGMA;
+    if (strcmp(addr, "true") == 0 || strcmp(addr, "false") == 0) return TYPE_B;
+    if ((addr[0] >= '0' && addr[0] <= '9') || addr[0] == '-') {
+        char* end;
+        strtod(addr, &end);
+        return (*end == '\0') ? TYPE_R : TYPE_UNKNOWN;
+    }
+
+    /* Variable d'une boucle POUR (portee fermee) : toujours entiere */
+    int lcount;
+    LoopInfo* loops = lt_get_all(&lcount);
+    for (int l = 0; l < lcount; l++) {
+        if (strcmp(loops[l].var, addr) == 0) return TYPE_Z;
+    }
+
+    /* Temporaire : toutes ses definitions doivent donner le meme type */
+    const QuadList* list = ctx->list;
+    if (g_index.list != list) build_def_index(list);
+    const OptDefEntry* e = opt_defs_find(&g_index.defs, addr);
+    DataType result = TYPE_UNKNOWN;
+    for (int i = e ? e->first : -1; i >= 0; i = g_index.next_def[i]) {
+        const Quadruplet* q = &list->quads[i];
+        DataType d = def_type(ctx, q, fn, depth + 1);
+        if (d == TYPE_UNKNOWN) return TYPE_UNKNOWN;
+        if (result != TYPE_UNKNOWN && result != d) return TYPE_UNKNOWN;
+        result = d;
+    }
+    return result;
+}
+
+DataType opt_value_type(const OptContext* ctx, const char* addr, FunctionInfo* fn) {
+    return value_type_rec(ctx, addr, fn, 0);
+}
+
+int opt_count_defs(const QuadList* list, const char* name, int from, int to) {
+    int n = 0;
+    for (int i = from; i < to && i < list->count; i++) {
+        const Quadruplet* q = &list->quads[i];
+        if (q->result && isAssigningOp(q->op) && strcmp(q->result, name) == 0) n++;
+    }
+    return n;
+}
+
+void opt_defs_build(OptDefIndex* index, const QuadList* list, int from, int to) {
+    if (to > list->count) to = list->count;
+    int capacity = 16;
+    while (capacity < 2 * (to - from)) capacity *= 2;
+    index->capacity = capacity;
+    index->slots = (OptDefEntry*)calloc(capacity, sizeof(OptDefEntry));
+    if (!index->slots) {
+        perror("calloc defs");
+        exit(EXIT_FAILURE);
+    }
+
+    for (int i = from; i < to; i++) {
+        const Quadruplet* q = &list->quads[i];
+        if (!q->result || !isAssigningOp(q->op)) continue;
+        unsigned int h = hash_function(q->result) & (capacity - 1);
+        while (index->slots[h].name && strcmp(index->slots[h].name, q->result) != 0)
+            h = (h + 1) & (capacity - 1);
+        OptDefEntry* e = &index->slots[h];
+        if (!e->name) {
+            e->name = q->result;
+            e->first = i;
+        }
+        e->count++;
+    }
+}
+
+const OptDefEntry* opt_defs_find(const OptDefIndex* index, const char* name) {
+    if (!name || !index->slots) return NULL;
+    unsigned int h = hash_function(name) & (index->capacity - 1);
+    while (index->slots[h].name) {
+        if (strcmp(index->slots[h].name, name) == 0) return &index->slots[h];
+        h = (h + 1) & (index->capacity - 1);
+    }
+    return NULL;
+}
+
+int opt_defs_count(const OptDefIndex* index, const char* name) {
+    const OptDefEntry* e = opt_defs_find(index, name);
+    return e ? e->count : 0;
+}
+
+void opt_defs_free(OptDefIndex* index) {
+    free(index->slots);
+    index->slots = NULL;
+    index->capacity = 0;
+}
+
+int opt_call_params(const QuadList* list, int call, int* params, int max) {
+    /* Region de l'appelant : son corps, ou pour le programme principal,
+       la suite de quadruplets depuis la fin de la derniere fonction */
+    int start = 0;
+    FunctionInfo* owner = opt_owner_function(call);
+    if (owner) {
+        start = owner->quad_start;
+    } else {
+        int fcount;
+        FunctionInfo* functions = ft_get_all(&fcount);
+        for (int f = 0; f < fcount; f++) {
+            if (functions[f].quad_end <= call && functions[f].quad_end > start)
+                start = functions[f].quad_end;
+        }
+    }
+
+    int n = 0;
+    for (int i = call - 1; i >= start; i--) {
+        const Quadruplet* q = &list->quads[i];
+        if (q->op == QUAD_CALL) break;
+        if (q->op != QUAD_PARAM) continue;
+        if (n >= max) return -1;
+        params[n++] = i;
+    }
+    /* Remettre dans l'ordre du source */
+    for (int a = 0, b = n - 1; a < b; a++, b--) {
+        int t = params[a];
+        params[a] = params[b];
+        params[b] = t;
+    }
+    return n;
+}
+
+/* ========================================================= */
+/*  REECRITURE                                                */
+/* ========================================================= */
+
+static void rw_reserve_target(QuadRewrite* rw, int index) {
+    if (index < rw->target_capacity) return;
+    int cap = rw->target_capacity ? rw->target_capacity : 64;
+    while (cap <= index) cap *= 2;
+    rw->target_old = (char*)realloc(rw->target_old, cap);
+    if (!rw->target_old) {
+        perror("realloc target_old");
+        exit(EXIT_FAILURE);
+    }
+    memset(rw->target_old + rw->target_capacity, 0, cap - rw->target_capacity);
+    rw->target_capacity = cap;
+}
+
+void rw_begin(QuadRewrite* rw, QuadList* src) {
+    rw->src = src;
+    rw->out = initQuadList();
+    rw->map = (int*)malloc(sizeof(int) * (src->count + 1));
+    if (!rw->map) {
+        perror("malloc map");
+        exit(EXIT_FAILURE);
+    }
+    for (int i = 0; i <= src->count; i++) rw->map[i] = -1;
+    rw->target_old = NULL;
+    rw->target_capacity = 0;
+}
+
+int rw_position(const QuadRewrite* rw) {
+    return rw->out->count;
+}
+
+void rw_mark(QuadRewrite* rw, int old_index) {
+    if (old_index >= 0 && old_index <= rw->src->count && rw->map[old_index] < 0)
+        rw->map[old_index] = rw->out->count;
+}
+
+int rw_emit(QuadRewrite* rw, QuadOp op, const char* arg1,
+            const char* arg2, const char* result) {
+    int idx = createQuad(rw->out, op, arg1, arg2, result);
+    rw_reserve_target(rw, idx);
+    rw->target_old[idx] = 0;
+    return idx;
+}
+
+int rw_copy(QuadRewrite* rw, int old_index) {
+    const Quadruplet* q = &rw->src->quads[old_index];
+    rw_mark(rw, old_index);
+    int idx = rw_emit(rw, q->op, q->arg1, q->arg2, q->result);
+    rw->out->quads[idx].target = q->target;
+    setQuadLocation(rw->out, idx, q->line, q->column);
+    rw->target_old[idx] = 1;
+    return idx;
+}
+
+void rw_copy_range(QuadRewrite* rw, int from, int to) {
+    for (int i = from; i < to; i++) rw_copy(rw, i);
+}
+
+int rw_copy_block(QuadRewrite* rw, int from, int to) {
+    int first = rw_position(rw);
+    for (int i = from; i < to; i++) {
+        const Quadruplet* q = &rw->src->quads[i];
+        int idx = rw_emit(rw, q->op, q->arg1, q->arg2, q->result);
+        setQuadLocation(rw->out, idx, q->line, q->column);
+        int target = getQuadTarget(q);
+        if (target < 0) continue;
+        rw->out->quads[idx].target = target;
+        if (target >= from && target <= to)
+            rw_set_target(rw, idx, first + (target - from), 0);
+        else
+            rw->target_old[idx] = 1;
+    }
+    return first;
+}
+
+void rw_set_target(QuadRewrite* rw, int new_index, int target, int target_is_old) {
+    setQuadTarget(rw->out, new_index, target);
+    rw->target_old[new_index] = (char)target_is_old;
+}
+
+void rw_commit(QuadRewrite* rw) {
+    QuadList* list = rw->src;
+    int n = list->count;
+    int* map = rw->map;
+
+    /* Quadruplets supprimes : indice du prochain quadruplet conserve.
+       La fin de la liste garde sa marque eventuelle (rw_mark(rw, n)). */
+    if (map[n] < 0) map[n] = rw->out->count;
+    for (int i = n - 1; i >= 0; i--) {
+        if (map[i] < 0) map[i] = map[i + 1];
+    }
+
+    for (int i = 0; i < rw->out->count; i++) {
+        if (!rw->target_old[i]) continue;
+        int target = getQuadTarget(&rw->out->quads[i]);
+        if (target >= 0 && target <= n)
+            setQuadTarget(rw->out, i, map[target]);
+    }
+
+    int fcount;
+    FunctionInfo* functions = ft_get_all(&fcount);
+    for (int f = 0; f < fcount; f++) {
+        if (functions[f].quad_start >= 0 && functions[f].quad_start <= n)
+            functions[f].quad_start = map[functions[f].quad_start];
+        if (functions[f].quad_end >= 0 && functions[f].quad_end <= n)
+            functions[f].quad_end = map[functions[f].quad_end];
+    }
+    lt_remap(map);
+    opt_index_invalidate();
+
+    /* Remplacer le contenu de la liste par la nouvelle */
+    for (int i = 0; i < n; i++) {
+        free(list->quads[i].arg1);
+        free(list->quads[i].arg2);
+        free(list->quads[i].result);
+    }
+    free(list->quads);
+    list->quads = rw->out->quads;
+    list->count = rw->out->count;
+    list->capacity = rw->out->capacity;
+
+    free(rw->out);
+    free(rw->map);
+    free(rw->target_old);
+    rw->out = NULL;
+    rw->map = NULL;
+    rw->target_old = NULL;
+}
+
+/* ========================================================= */
+/*  POINT D'ENTRÉE                                            */
+/* ========================================================= */
+
+void optimize_quads(QuadList* list, SymbolTable* table, const OptOptions* opts) {
+    OptOptions defaults;
+    if (!opts) {
+        opt_default_options(&defaults);
+        opts = &defaults;
+    }
+    if (!list) return;
+
+    OptContext ctx = { list, table, opts };
+    int before = list->count;
+    opt_index_invalidate();
+
+    /* Analyses toujours faites : MEMOISER en depend meme en -O0 */
+    int pure = opt_analyze_purity(&ctx);
+    opt_compute_trip_counts(&ctx);
+    if (opts->level <= 0) {
+        opt_index_invalidate();
+        return;
+    }
+
+    if (opts->report) fprintf(opts->report, "\n=== OPTIMISATIONS ===\n\n");
+
+    /* L'evaluation des appels constants passe avant tout le reste : elle
+       a besoin des corps d'origine et supprime des appels a integrer.
+       La specialisation suit, pour que les clones profitent de tout le
+       reste. Ensuite les appels terminaux (ils ne touchent que les fonctions),
+       puis l'integration, qui profite des fonctions devenues des boucles,
+       puis le deroulement complet : les boucles qu'il consomme n'ont
+       plus besoin des autres passes. Le deroulement
+       partiel vient en dernier pour dupliquer les accumulateurs de la
+       reduction de force avec le corps. */
+    int folded = 0, propagated = 0, cloned = 0, tail = 0, inlined = 0, full = 0, partial = 0, reduced = 0;
+    if (opts->const_calls) folded = opt_fold_constant_calls(&ctx);
+    if (opts->specialize) propagated = opt_specialize(&ctx, &cloned);
+    if (opts->tail_calls) tail = opt_tail_calls(&ctx);
+    if (opts->inlining) inlined = opt_inline_calls(&ctx);
+    if (opts->unroll) full = opt_unroll_full(&ctx);
+    if (opts->strength_reduction) reduced = opt_strength_reduce(&ctx);
+    if (opts->unroll && opts->unroll_factor > 1) partial = opt_unroll_partial(&ctx);
+
+    if (opts->report) {
+        int fcount;
+        ft_get_all(&fcount);
+        fprintf(opts->report, "Fonctions pures : %d / %d\n", pure, fcount);
+        fprintf(opts->report, "Appels constants : %d evalue(s) a la compilation\n", folded);
+        fprintf(opts->report, "Specialisation : %d parametre(s) propage(s), %d clone(s)\n",
+                propagated, cloned);
+        fprintf(opts->report, "Appels terminaux : %d elimine(s)\n", tail);
+        fprintf(opts->report, "Integration : %d appel(s)\n", inlined);
+        fprintf(opts->report, "Reduction de force : %d expression(s) d'induction\n", reduced);
+        fprintf(opts->report, "Deroulement : %d boucle(s) completement, %d partiellement\n",
+                full, partial);
+        fprintf(opts->report, "Quadruplets : %d -> %d\n", before, list->count);
+    }
+    opt_index_invalidate();
+}
@@ -0,0 +1,159 @@
+#ifndef OPTIMIZER_H
+#define OPTIMIZER_H
+
+#include <stdio.h>
+#include "quadruplet.h"
+#include "symbol_table.h"
+#include "function_table.h"
+#include "loop_table.h"
+
+/* ========================================================= */
+/*  OPTIONS DES PASSES D'OPTIMISATION                         */
+/* ========================================================= */
+
+#define OPT_MAX_UNROLL_FACTOR 64
+
+typedef struct {
+    int level;                  /* 0 = aucune optimisation (-O0) */
+    int strength_reduction;     /* reduction de force des variables d'induction */
+    int const_calls;            /* evaluation des appels purs a arguments constants */
+    int specialize;             /* propagation interprocedurale des constantes, clones */
+    int tail_calls;             /* elimination des appels recursifs terminaux */
+    int inlining;               /* integration des petites fonctions */
+    int unroll;                 /* deroulement des boucles POUR */
+    int unroll_factor;          /* facteur du deroulement partiel (<= 1 : aucun,
+                                   au plus OPT_MAX_UNROLL_FACTOR) */
+    FILE* report;               /* rapport des passes (NULL = silencieux) */
+} OptOptions;
+
+void opt_default_options(OptOptions* opts);
+
+/* Point d'entree : enchaine les passes sur la liste de quadruplets.
+   A appeler apres le parsing, uniquement s'il n'y a pas d'erreur. */
+void optimize_quads(QuadList* list, SymbolTable* table, const OptOptions* opts);
+
+/* ========================================================= */
+/*  CONTEXTE PARTAGE PAR LES PASSES                           */
+/* ========================================================= */
+
+typedef struct {
+    QuadList* list;
+    SymbolTable* table;
+    const OptOptions* opts;
+} OptContext;
+
+/* Fonction contenant le quadruplet "index" (NULL = programme principal).
+   Repond par un index construit a la demande, comme opt_value_type. */
+FunctionInfo* opt_owner_function(int index);
+
+/* Oublie cet index : rw_commit l'appelle ; une passe qui deplace les
+   bornes d'une fonction ou les definitions hors de rw_commit aussi */
+void opt_index_invalidate(void);
+
+/* Type connu a la compilation d'une adresse : litteral, parametre de
+   "fn" ou variable globale. TYPE_UNKNOWN pour les temporaires. */
+DataType opt_addr_type(const OptContext* ctx, const char* addr, FunctionInfo* fn);
+
+/* Comme opt_addr_type, mais connait aussi les autres litteraux, les
+   variables de boucle POUR, et deduit le type d'un temporaire de ses
+   definitions (T = a + b, a et b entiers => Z) */
+DataType opt_value_type(const OptContext* ctx, const char* addr, FunctionInfo* fn);
+
+/* Temporaire du compilateur (newTemp : "T" suivi de chiffres) : defini
+   une fois par l'analyse, avant ses utilisations, dans le meme bloc.
+   Une variable de l'utilisateur ne l'est jamais. */
+int opt_is_temp(const OptContext* ctx, const char* addr);
+
+/* Litteral entier ("42", "-3") : renvoie 1 et la valeur dans *value */
+int opt_int_literal(const char* addr, long* value);
+
+/* Indices des PARAM consommes par le CALL "call" (ceux qui suivent le
+   CALL precedent dans la meme region), dans l'ordre des arguments.
+   Renvoie leur nombre, -1 s'il y en a plus que max. */
+int opt_call_params(const QuadList* list, int call, int* params, int max);
+
+/* Nombre de definitions de "name" dans [from, to) */
+int opt_count_defs(const QuadList* list, const char* name, int from, int to);
+
+/* Index des definitions d'un intervalle de quadruplets, construit en
+   une passe pour remplacer des appels repetes a opt_count_defs. Les
+   noms ne sont pas copies : l'index n'est valable que tant que la
+   liste n'est pas reecrite. */
+typedef struct {
+    const char* name;    /* NULL = alveole libre */
+    int count;           /* definitions dans l'intervalle */
+    int first;           /* indice de la premiere */
+} OptDefEntry;
+
+typedef struct {
+    OptDefEntry* slots;
+    int capacity;        /* puissance de 2 */
+} OptDefIndex;
+
+void opt_defs_build(OptDefIndex* index, const QuadList* list, int from, int to);
+const OptDefEntry* opt_defs_find(const OptDefIndex* index, const char* name);
+int opt_defs_count(const OptDefIndex* index, const char* name);
+void opt_defs_free(OptDefIndex* index);
+
+/* ========================================================= */
+/*  REECRITURE D'UNE LISTE DE QUADRUPLETS                     */
+/* ========================================================= */
+/*
+ * Une passe construit une nouvelle liste a partir de l'ancienne :
+ * copie de quadruplets existants (rw_copy), insertion de nouveaux
+ * (rw_emit). A la fin, rw_commit remplace le contenu de la liste et
+ * renumerote tout ce qui designe un indice de quadruplet : cibles de
+ * branchement, bornes des fonctions et des boucles.
+ *
+ * map[ancien] = indice du quadruplet copie ; un quadruplet supprime
+ * prend l'indice du prochain quadruplet conserve.
+ */
+typedef struct {
+    QuadList* src;
+    QuadList* out;
+    int* map;            /* taille src->count + 1 */
+    char* target_old;    /* 1 si la cible du nouveau quad est un ancien indice */
+    int target_capacity;
+} QuadRewrite;
+
+void rw_begin(QuadRewrite* rw, QuadList* src);
+int rw_copy(QuadRewrite* rw, int old_index);
+void rw_copy_range(QuadRewrite* rw, int from, int to);
+/* Duplique [from, to) sans toucher a map : les branchements internes au
+   bloc (cible dans [from, to]) visent la copie, les autres gardent leur
+   cible d'origine. Renvoie l'indice du premier quadruplet copie. */
+int rw_copy_block(QuadRewrite* rw, int from, int to);
+int rw_emit(QuadRewrite* rw, QuadOp op, const char* arg1,
+            const char* arg2, const char* result);
+void rw_set_target(QuadRewrite* rw, int new_index, int target, int target_is_old);
+void rw_mark(QuadRewrite* rw, int old_index);
+int rw_position(const QuadRewrite* rw);
+void rw_commit(QuadRewrite* rw);
+
+/* ========================================================= */
+/*  PASSES                                                    */
+/* ========================================================= */
+
+/* opt_loops.c */
+int opt_compute_trip_counts(OptContext* ctx);
+int opt_strength_reduce(OptContext* ctx);
+int opt_unroll_full(OptContext* ctx);
+int opt_unroll_partial(OptContext* ctx);
+
+/* opt_functions.c */
+/* Calcule FunctionInfo.is_pure et retire MEMOISER des fonctions qui ne
+   s'y pretent pas (avertissement). Renvoie le nombre de fonctions pures. */
+int opt_analyze_purity(OptContext* ctx);
+int opt_tail_calls(OptContext* ctx);
+int opt_inline_calls(OptContext* ctx);
+/* Propage les parametres constants a tous les sites et clone les
+   fonctions pour les autres ; renvoie le nombre de parametres propages,
+   et dans *cloned le nombre de clones */
+int opt_specialize(OptContext* ctx, int* cloned);
+
+/* opt_eval.c */
+/* Remplace "T <- CALL f" par le resultat quand f est pure et que ses
+   arguments sont constants. Renvoie le nombre d'appels evalues. */
+int opt_fold_constant_calls(OptContext* ctx);
+
+#endif
@@ -7,23 +7,15 @@
 /*                   VARIABLES GLOBALES                       */
 /* ========================================================= */
 
-static int tempCounter = 0;
-static int labelCounter = 0;
-
-// Piles globales pour les structures de contrôle
-IntStack ifStack;
-IntStack ifBrStack;        // Pile dédiée pour les BR du premier IF (avant SINON)
-IntStack elseStack;
-IntStack whileStartStack;
-IntStack whileExitStack;
-IntStack forStartStack;
-IntStack forExitStack;
-IntStack forIncrStack;
-IntStack forBreakStack;    // Pile dédiée pour les BR générés par SORTIR dans les boucles
-IntStack forContinueStack; // Pile dédiée pour les BR générés par CONTINUER dans les boucles
-IntStack repeatStartStack;
-IntStack whileBreakStack;
-IntStack repeatBreakStack;
+static _Thread_local int tempCounter = 0;
+static _Thread_local int labelCounter = 0;
+static _Thread_local int sourceLine = 0, sourceColumn = 0;
+
+// Contextes des structures de contrôle en cours d'analyse
+static _Thread_local LoopContext* loopStack = NULL;
+static _Thread_local int loopCount = 0, loopCapacity = 0;
+static _Thread_local IfContext* ifStack = NULL;
+static _Thread_local int ifCount = 0, ifCapacity = 0;
 
 /* ========================================================= */
 /*                   GESTION DES QUADRUPLETS                  */
@@ -79,21 +71,139 @@ int createQuad(QuadList* list, QuadOp op, const char* arg1,
     q->arg1 = arg1 ? stringDuplicate(arg1) : NULL;
     q->arg2 = arg2 ? stringDuplicate(arg2) : NULL;
     q->result = result ? stringDuplicate(result) : NULL;
+    q->target = -1;
+    q->line = sourceLine;
+    q->column = sourceColumn;
     
     return list->count++;
 }
 
-void updateQuad(QuadList* list, int index, const char* result) {
-    if (!list || index < 0 || index >= list->count) return;
-    
-    free(list->quads[index].result);
-    list->quads[index].result = result ? stringDuplicate(result) : NULL;
+int createBranch(QuadList* list, QuadOp op, const char* arg1,
+                 const char* arg2, int target) {
+    int index = createQuad(list, op, arg1, arg2, NULL);
+    if (index >= 0) list->quads[index].target = target;
+    return index;
 }
 
 int nextQuad(const QuadList* list) {
     return list ? list->count : 0;
 }
 
+/* ========================================================= */
+/*                   CIBLES DE BRANCHEMENT                    */
+/* ========================================================= */
+
+bool isBranchOp(QuadOp op) {
+    switch (op) {
+        case QUAD_BR: case QUAD_BZ: case QUAD_BNZ:
+        case QUAD_BG: case QUAD_BGE: case QUAD_BL:
+        case QUAD_BLE: case QUAD_BE: case QUAD_BNE:
+            return true;
+        default:
+            return false;
+    }
+}
+
+/* Opérations dont le champ "result" désigne une variable qui reçoit
+   une valeur (par opposition à une cible de branchement, comme dans
+   BR/BZ/BG..., ou un résultat non pertinent comme WRITE/WRITELN). */
+bool isAssigningOp(QuadOp op) {
+    switch (op) {
+        case QUAD_ADD:
+        case QUAD_SUB:
+        case QUAD_MUL:
+        case QUAD_DIV:
+        case QUAD_DIV_INT:
+        case QUAD_MOD:
+        case QUAD_POW:
+        case QUAD_NEG:
+        case QUAD_AND:
+        case QUAD_OR:
+        case QUAD_NOT:
+        case QUAD_XOR:
+        case QUAD_EQ:
+        case QUAD_NEQ:
+        case QUAD_LT:
+        case QUAD_GT:
+        case QUAD_LEQ:
+        case QUAD_GEQ:
+        case QUAD_ASSIGN:
+        case QUAD_SIN:
+        case QUAD_COS:
+        case QUAD_EXP:
+        case QUAD_LOG:
+        case QUAD_SQRT:
+        case QUAD_ABS:
+        case QUAD_FLOOR:
+        case QUAD_CEIL:
+        case QUAD_ROUND:
+        case QUAD_RE:
+        case QUAD_IM:
+        case QUAD_ARG:
+        case QUAD_MAJUSCULES:
+        case QUAD_MINUSCULES:
+        case QUAD_READ:
+        case QUAD_CALL:
+            return true;
+        default:
+            return false;
+    }
+}
+
+// Retourne -1 si le quadruplet n'est pas un branchement (ou cible non complétée)
+int getQuadTarget(const Quadruplet* quad) {
+    if (!quad || !isBranchOp(quad->op)) return -1;
+    return quad->target;
+}
+
+void setQuadTarget(QuadList* list, int index, int target) {
+    if (!list || index < 0 || index >= list->count) return;
+    list->quads[index].target = target;
+}
+
+void setQuadLocation(QuadList* list, int index, int line, int column) {
+    if (!list || index < 0 || index >= list->count) return;
+    list->quads[index].line = line;
+    list->quads[index].column = column;
+}
+
+void setSourcePosition(int line, int column) {
+    sourceLine = line;
+    sourceColumn = column;
+}
+
+/* ========================================================= */
+/*                   BACKPATCHING                             */
+/* ========================================================= */
+
+/* Tant que sa cible n'est pas connue, un branchement garde dans son
+   champ target l'indice du saut suivant de la même liste : une liste
+   ne coûte aucune allocation et se complète en un parcours. */
+
+int makeJumpList(QuadList* list, int index) {
+    if (!list || index < 0 || index >= list->count) return -1;
+    list->quads[index].target = -1;
+    return index;
+}
+
+// Chaîne "b" devant "a" : seule "b" est parcourue
+int mergeJumpLists(QuadList* list, int a, int b) {
+    if (b < 0) return a;
+    if (a < 0) return b;
+    int last = b;
+    while (list->quads[last].target >= 0) last = list->quads[last].target;
+    list->quads[last].target = a;
+    return b;
+}
+
+void backpatch(QuadList* list, int head, int target) {
+    while (head >= 0) {
+        int next = list->quads[head].target;
+        list->quads[head].target = target;
+        head = next;
+    }
+}
+
 /* ========================================================= */
 /*                   AFFICHAGE                                */
 /* ========================================================= */
@@ -165,44 +275,54 @@ const char* quadOpToString(QuadOp op) {
     }
 }
 
-void printQuadruplet(const Quadruplet* quad, int index) {
+void fprintQuadruplet(FILE* out, const Quadruplet* quad, int index) {
     if (!quad) return;
     
-    printf("%4d: ( %-8s , ", index, quadOpToString(quad->op));
+    fprintf(out, "%4d: ( %-8s , ", index, quadOpToString(quad->op));
     
-    if (quad->arg1) printf("%-10s", quad->arg1);
-    else printf("%-10s", "-");
+    if (quad->arg1) fprintf(out, "%-10s", quad->arg1);
+    else fprintf(out, "%-10s", "-");
     
-    printf(" , ");
+    fprintf(out, " , ");
     
-    if (quad->arg2) printf("%-10s", quad->arg2);
-    else printf("%-10s", "-");
+    if (quad->arg2) fprintf(out, "%-10s", quad->arg2);
+    else fprintf(out, "%-10s", "-");
     
-    printf(" , ");
+    fprintf(out, " , ");
     
-    if (quad->result) printf("%-10s", quad->result);
-    else printf("%-10s", "-");
+    if (isBranchOp(quad->op) && quad->target >= 0) fprintf(out, "%-10d", quad->target);
+    else if (quad->result) fprintf(out, "%-10s", quad->result);
+    else fprintf(out, "%-10s", "-");
     
-    printf(" )\n");
+    if (quad->line > 0) fprintf(out, " )  %d:%d\n", quad->line, quad->column);
+    else fprintf(out, " )\n");
 }
 
-void printQuadruplets(const QuadList* list) {
+void fprintQuadruplets(FILE* out, const QuadList* list) {
     if (!list) {
-        printf("Liste de quadruplets vide\n");
+        fprintf(out, "Liste de quadruplets vide\n");
         return;
     }
     
-    printf("\n══════════════════════════════════════════════════════════════\n");
-    printf("          CODE INTERMÉDIAIRE - %d QUADRUPLETS                   \n", list->count);
-    printf("══════════════════════════════════════════════════════════════\n");    
-    printf(" Idx  Operation    Arg1         Arg2         Result or Target\n");
-    printf("────────────────────────────────────────────────────────────────\n");
+    fprintf(out, "\n══════════════════════════════════════════════════════════════\n");
+    fprintf(out, "          CODE INTERMÉDIAIRE - %d QUADRUPLETS                   \n", list->count);
+    fprintf(out, "══════════════════════════════════════════════════════════════\n");    
+    fprintf(out, " Idx  Operation    Arg1         Arg2         Result or Target  Source\n");
+    fprintf(out, "────────────────────────────────────────────────────────────────\n");
     
     for (int i = 0; i < list->count; i++) {
-        printQuadruplet(&list->quads[i], i);
+        fprintQuadruplet(out, &list->quads[i], i);
     }
     
-    printf("\n");
+    fprintf(out, "\n");
+}
+
+void printQuadruplet(const Quadruplet* quad, int index) {
+    fprintQuadruplet(stdout, quad, index);
+}
+
+void printQuadruplets(const QuadList* list) {
+    fprintQuadruplets(stdout, list);
 }
 
 /* ========================================================= */
@@ -223,6 +343,10 @@ void resetTempCounter(void) {
     tempCounter = 0;
 }
 
+int getTempCount(void) {
+    return tempCounter;
+}
+
 char* newLabel(void) {
     char* label = (char*)malloc(16);
     if (!label) {
@@ -248,7 +372,7 @@ void initIntStack(IntStack* stack) {
 
 bool pushInt(IntStack* stack, int value) {
     if (!stack || stack->top >= MAX_STACK_SIZE - 1) {
-        fprintf(stderr, "Erreur: débordement de pile (IntStack)\n");
+        fprintf(diagnostic_stream(), "Erreur: débordement de pile (IntStack)\n");
         return false;
     }
     stack->data[++stack->top] = value;
@@ -257,7 +381,7 @@ bool pushInt(IntStack* stack, int value) {
 
 int popInt(IntStack* stack) {
     if (!stack || stack->top < 0) {
-        fprintf(stderr, "Erreur: pile vide (IntStack)\n");
+        fprintf(diagnostic_stream(), "Erreur: pile vide (IntStack)\n");
         return -1;
     }
     return stack->data[stack->top--];
@@ -289,7 +413,7 @@ void initStringStack(StringStack* stack) {
 
 bool pushString(StringStack* stack, const char* value) {
     if (!stack || stack->top >= MAX_STACK_SIZE - 1) {
-        fprintf(stderr, "Erreur: débordement de pile (StringStack)\n");
+        fprintf(diagnostic_stream(), "Erreur: débordement de pile (StringStack)\n");
         return false;
     }
     stack->data[++stack->top] = value ? stringDuplicate(value) : NULL;
@@ -298,7 +422,7 @@ bool pushString(StringStack* stack, const char* value) {
 
 char* popString(StringStack* stack) {
     if (!stack || stack->top < 0) {
-        fprintf(stderr, "Erreur: pile vide (StringStack)\n");
+        fprintf(diagnostic_stream(), "Erreur: pile vide (StringStack)\n");
         return NULL;
     }
     return stack->data[stack->top--];
@@ -324,23 +448,68 @@ void freeStringStack(StringStack* stack) {
 }
 
 /* ========================================================= */
-/*                   INITIALISATION DES PILES GLOBALES        */
+/*                   CONTEXTES DE CONTRÔLE                    */
 /* ========================================================= */
 
+LoopContext* pushLoop(int start) {
+    if (loopCount >= loopCapacity) {
+        loopCapacity = loopCapacity ? loopCapacity * 2 : 16;
+        loopStack = (LoopContext*)realloc(loopStack, sizeof(LoopContext) * loopCapacity);
+        if (!loopStack) {
+            perror("realloc loopStack");
+            exit(EXIT_FAILURE);
+        }
+    }
+    LoopContext* loop = &loopStack[loopCount++];
+    loop->start = start;
+    loop->break_list = -1;
+    loop->continue_list = -1;
+    return loop;
+}
+
+LoopContext* currentLoop(void) {
+    return loopCount > 0 ? &loopStack[loopCount - 1] : NULL;
+}
+
+void popLoop(void) {
+    if (loopCount > 0) loopCount--;
+}
+
+IfContext* pushIf(int false_list) {
+    if (ifCount >= ifCapacity) {
+        ifCapacity = ifCapacity ? ifCapacity * 2 : 16;
+        ifStack = (IfContext*)realloc(ifStack, sizeof(IfContext) * ifCapacity);
+        if (!ifStack) {
+            perror("realloc ifStack");
+            exit(EXIT_FAILURE);
+        }
+    }
+    IfContext* ctx = &ifStack[ifCount++];
+    ctx->false_list = false_list;
+    ctx->end_list = -1;
+    return ctx;
+}
+
+IfContext* currentIf(void) {
+    return ifCount > 0 ? &ifStack[ifCount - 1] : NULL;
+}
+
+void popIf(void) {
+    if (ifCount > 0) ifCount--;
+}
+
 void initControlStacks(void) {
-    initIntStack(&ifStack);
-    initIntStack(&ifBrStack);
-    initIntStack(&elseStack);
-    initIntStack(&whileStartStack);
-    initIntStack(&whileExitStack);
-    initIntStack(&forStartStack);
-    initIntStack(&forExitStack);
-    initIntStack(&forIncrStack);
-    initIntStack(&forBreakStack);
-    initIntStack(&forContinueStack);
-    initIntStack(&repeatStartStack);
-    initIntStack(&whileBreakStack);
-    initIntStack(&repeatBreakStack);
+    loopCount = 0;
+    ifCount = 0;
+}
+
+void freeControlStacks(void) {
+    free(loopStack);
+    loopStack = NULL;
+    loopCount = loopCapacity = 0;
+    free(ifStack);
+    ifStack = NULL;
+    ifCount = ifCapacity = 0;
 }
 
 /* ========================================================= */
@@ -90,7 +90,12 @@ typedef struct {
     QuadOp op;         // Opérateur
     char* arg1;        // Premier argument
     char* arg2;        // Deuxième argument
-    char* result;      // Résultat
+    char* result;      // Résultat (NULL pour un branchement)
+    int target;        // Branchement : indice du quadruplet visé ; en attente
+                       // de backpatch, saut suivant de sa liste (-1 : fin)
+    int line;          // Position dans le source (0 : inconnue, quadruplet
+    int column;        // ajouté par l'optimiseur) ; saut arrière d'une boucle :
+                       // position du TANT QUE / POUR / REPETER
 } Quadruplet;
 
 /* ========================================================= */
@@ -113,22 +118,43 @@ void freeQuadList(QuadList* list);
 int createQuad(QuadList* list, QuadOp op, const char* arg1, 
                const char* arg2, const char* result);
 
-// Modification de quadruplets (pour compléter les sauts)
-void updateQuad(QuadList* list, int index, const char* result);
+// Branchement vers "target" (-1 : cible à compléter par backpatch)
+int createBranch(QuadList* list, QuadOp op, const char* arg1,
+                 const char* arg2, int target);
 
 // Affichage
 void printQuadruplets(const QuadList* list);
 void printQuadruplet(const Quadruplet* quad, int index);
+void fprintQuadruplets(FILE* out, const QuadList* list);
+void fprintQuadruplet(FILE* out, const Quadruplet* quad, int index);
 
 // Récupération de l'index courant
 int nextQuad(const QuadList* list);
 
+// Branchements : cible d'un BR/BZ/BNZ/BG... (indice de quadruplet)
+bool isBranchOp(QuadOp op);
+bool isAssigningOp(QuadOp op);   // "result" reçoit une valeur
+int getQuadTarget(const Quadruplet* quad);
+void setQuadTarget(QuadList* list, int index, int target);
+void setQuadLocation(QuadList* list, int index, int line, int column);
+
+// Position du source donnée aux quadruplets créés ensuite (0 : aucune)
+void setSourcePosition(int line, int column);
+
+/* Listes de sauts en attente (backpatching) : chaînées par le champ
+   target des branchements, désignées par l'indice du premier saut,
+   -1 pour la liste vide. */
+int makeJumpList(QuadList* list, int index);          // { index }
+int mergeJumpLists(QuadList* list, int a, int b);    // a ∪ b, en O(|b|)
+void backpatch(QuadList* list, int head, int target); // O(1) par saut
+
 /* ========================================================= */
 /*                   TEMPORAIRES                              */
 /* ========================================================= */
 
 char* newTemp(void);
 void resetTempCounter(void);
+int getTempCount(void);          // temporaires créés depuis resetTempCounter
 
 /* ========================================================= */
 /*                   ÉTIQUETTES                               */
@@ -143,7 +169,7 @@ void resetLabelCounter(void);
 
 #define MAX_STACK_SIZE 1000
 
-// Pile d'entiers (pour les indices de quadruplets à compléter)
+// Pile d'entiers
 typedef struct {
     int data[MAX_STACK_SIZE];
     int top;
@@ -170,33 +196,34 @@ bool isStringStackEmpty(const StringStack* stack);
 void freeStringStack(StringStack* stack);
 
 /* ========================================================= */
-/*                   PILES GLOBALES                           */
+/*                   CONTEXTES DE CONTRÔLE                    */
 /* ========================================================= */
 
-// Piles pour IF/ELSE
-extern IntStack ifStack;        // Pour les BZ à compléter
-extern IntStack ifBrStack;      // Pour les BR du premier IF (avant SINON)
-extern IntStack elseStack;      // Pour les BR à compléter
-
-// Piles pour WHILE
-extern IntStack whileStartStack;    // Indices de début de boucle
-extern IntStack whileExitStack; 
-extern IntStack whileBreakStack;    // BZ de sortie à compléter
+// Boucle en cours d'analyse (TANT QUE, POUR, REPETER)
+typedef struct {
+    int start;          // début de la boucle, cible de CONTINUER (-1 pour POUR)
+    int break_list;     // sauts vers la sortie : test de fin, SORTIR
+    int continue_list;  // POUR : CONTINUER, vers l'incrémentation
+} LoopContext;
 
-// Piles pour FOR
-extern IntStack forStartStack;      // Indices de début de boucle
-extern IntStack forExitStack;       // BZ de sortie à compléter
-extern IntStack forIncrStack;       // Indices d'incrémentation
-extern IntStack forBreakStack;      // BR générés par SORTIR
-extern IntStack forContinueStack;   // BR générés par CONTINUER
+// SI en cours d'analyse, avec ses SINON SI / SINON
+typedef struct {
+    int false_list;     // saut de la condition courante quand elle est fausse
+    int end_list;       // BR de fin de chaque branche, vers après le FIN
+} IfContext;
 
-// Piles pour REPEAT
-extern IntStack repeatStartStack;   // Indices de début de boucle
-extern IntStack repeatBreakStack;    // BZ de sortie à compléter
+LoopContext* pushLoop(int start);
+LoopContext* currentLoop(void);      // boucle la plus interne, NULL hors boucle
+void popLoop(void);
 
+IfContext* pushIf(int false_list);
+IfContext* currentIf(void);
+void popIf(void);
 
-// Initialisation des piles globales
+// Vide les piles de contextes
 void initControlStacks(void);
+// Libere les piles (fin de compilation)
+void freeControlStacks(void);
 
 /* ========================================================= */
 /*                   UTILITAIRES                              */
@@ -0,0 +1,39 @@
+#!/usr/bin/env bash
+# Temps total de compilation des tests/*.ml : boucle sequentielle (un
+# ./parser par fichier, comme scripts/run_tests.sh) contre le mode lot
+# ./parser -j N. Usage :
+#   scripts/bench_batch.sh [copies] [processus]   (10 copies, nproc par defaut)
+set -euo pipefail
+
+if [ ! -x ./parser ]; then
+  echo "parser not found or not executable. Run 'make' first." >&2
+  exit 2
+fi
+
+COPIES=${1:-10}
+JOBS=${2:-$(nproc)}
+WORK=$(mktemp -d /tmp/mathlang_lot_XXXXXX)
+trap 'rm -rf "$WORK"' EXIT
+
+# Chaque copie dans son repertoire : a.ml -> a.c, a
+for c in $(seq "$COPIES"); do
+  mkdir -p "$WORK/serie/$c" "$WORK/lot/$c"
+  cp tests/*.ml "$WORK/serie/$c/"
+  cp tests/*.ml "$WORK/lot/$c/"
+done
+count=$(ls "$WORK"/lot/*/*.ml | wc -l)
+
+now() { date +%s%N; }
+
+start=$(now)
+for f in "$WORK"/serie/*/*.ml; do
+  ./parser -q -o "${f%.ml}" "$f" > /dev/null 2>&1 || true
+done
+serial=$(( ($(now) - start) / 1000000 ))
+
+start=$(now)
+./parser -q -j "$JOBS" "$WORK"/lot/*/*.ml > /dev/null 2>&1 || true
+batch=$(( ($(now) - start) / 1000000 ))
+
+echo "$count source(s) : boucle sequentielle ${serial} ms, -j $JOBS ${batch} ms"
+awk -v s="$serial" -v b="$batch" 'BEGIN { if (b > 0) printf "acceleration : x%.2f\n", s / b }'
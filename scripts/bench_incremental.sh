@@ -0,0 +1,70 @@
+#!/usr/bin/env bash
+# Latence modification -> executable sur un gros programme genere (N
+# fonctions de L lignes) : compilation complete, puis --incremental a
+# froid, puis --incremental apres une modification d'une ligne dans une
+# seule fonction. Usage :
+#   scripts/bench_incremental.sh [fonctions] [lignes]   (200 x 100 : ~20k lignes)
+set -euo pipefail
+
+if [ ! -x ./parser ]; then
+  echo "parser not found or not executable. Run 'make' first." >&2
+  exit 2
+fi
+
+N=${1:-200}
+L=${2:-100}
+WORK=$(mktemp -d /tmp/mathlang_incr_XXXXXX)
+trap 'rm -rf "$WORK"' EXIT
+PROG="$WORK/prog.ml"
+
+# Les variables de boucle sont propres a chaque fonction, et les appels
+# dependent de k : pas d'evaluation a la compilation
+awk -v n="$N" -v l="$L" 'BEGIN {
+  for (i = 1; i <= n; i++) {
+    printf "FONCTION f%d(n : Z, s : Z) : Z\n", i
+    printf "    POUR j%d DE 1 A n FAIRE\n", i
+    printf "        SI j%d mod 3 = 0 ALORS\n", i
+    for (k = 1; k < l - 10; k++)
+      printf "            s <- (s + j%d * %d) mod 100003\n", i, i + k
+    printf "        SINON\n"
+    printf "            s <- s - j%d + 7\n", i
+    printf "        FIN\n    FIN\n    RETOURNER s mod 1000\nFIN\n\n"
+  }
+  print "SOIT total dans Z tel que total <- 0"
+  print "POUR k DE 1 A 3 FAIRE"
+  for (i = 1; i <= n; i++) printf "    total <- total + f%d(k + %d, total)\n", i, i % 17
+  print "FIN"
+  print "AFFICHER_LIGNE(total)"
+}' > "$PROG"
+
+now() { date +%s%N; }
+ms() { echo $(( ($(now) - $1) / 1000000 )); }
+
+echo "$(wc -l < "$PROG") lignes, $N fonctions"
+
+start=$(now)
+./parser -q -o "$WORK/complet" "$PROG"
+echo "compilation complete          : $(ms "$start") ms"
+
+start=$(now)
+./parser -q --incremental="$WORK/cache" -o "$WORK/incr" "$PROG"
+echo "--incremental, cache vide     : $(ms "$start") ms"
+
+# Une ligne modifiee dans la fonction du milieu
+mid=$(( (N + 1) / 2 ))
+sed -i "/^FONCTION f$mid(/,/^FIN/ s/ + 7$/ + 8/" "$PROG"
+
+start=$(now)
+./parser --incremental="$WORK/cache" -o "$WORK/incr" "$PROG" | grep '^Incremental'
+echo "--incremental, une ligne modifiee : $(ms "$start") ms"
+
+start=$(now)
+./parser -q -o "$WORK/complet" "$PROG"
+echo "compilation complete, meme modification : $(ms "$start") ms"
+
+if [ "$("$WORK/complet")" = "$("$WORK/incr")" ]; then
+  echo "sorties identiques"
+else
+  echo "sorties differentes" >&2
+  exit 1
+fi
@@ -0,0 +1,83 @@
+#!/usr/bin/env bash
+# Debit du scanner (Mo/s) sur un source synthetique, lecture stdio
+# (--no-mmap) contre mmap + yy_scan_buffer. Usage :
+#   scripts/bench_lexer.sh [taille_en_Mo]   (100 par defaut)
+#   scripts/bench_lexer.sh --flex-modes [taille_en_Mo]
+# --flex-modes reconstruit le scanner avec chaque mode de tables de flex
+# (par defaut, -Cf, -CF) et compare taille des tables, temps de demarrage
+# et debit.
+set -euo pipefail
+
+FLEX_MODES=0
+if [ "${1:-}" = "--flex-modes" ]; then
+  FLEX_MODES=1
+  shift
+fi
+
+if [ "$FLEX_MODES" -eq 0 ] && [ ! -x ./parser ]; then
+  echo "parser not found or not executable. Run 'make' first." >&2
+  exit 2
+fi
+
+SIZE_MB=${1:-100}
+SRC=$(mktemp /tmp/mathlang_bench_XXXXXX.ml)
+trap 'rm -f "$SRC"' EXIT
+
+# Un bloc representatif (mots-cles, identificateurs, nombres, chaines,
+# commentaires), repete jusqu'a la taille voulue
+BLOCK=$(cat <<'ML'
+# bloc genere pour la mesure du scanner
+SOIT compteur_1 dans Z tel que compteur_1 <- 42
+SOIT x_reel dans R tel que x_reel <- 3.14159 * 2.0e3 - 0.5
+SI compteur_1 >= 10 et non (x_reel < 1.0) ALORS
+    AFFICHER_LIGNE("valeur : ", sqrt(x_reel) + abs(-7) mod 3)
+SINON
+    compteur_1 <- compteur_1 div 2
+FIN
+POUR i DE 1 A 100 PAR 3 FAIRE
+    AFFICHER(majuscules("abc"), 'z', 2i + 1)
+FIN
+ML
+)
+block_bytes=$(( ${#BLOCK} + 1 ))
+block_lines=$(printf '%s\n' "$BLOCK" | wc -l)
+blocks=$(( SIZE_MB * 1000000 / block_bytes ))
+yes "$BLOCK" | head -n $(( blocks * block_lines )) > "$SRC" || true
+echo "Source synthetique : $(stat -c %s "$SRC") octets"
+
+if [ "$FLEX_MODES" -eq 1 ]; then
+  EMPTY=$(mktemp /tmp/mathlang_empty_XXXXXX.ml)
+  trap 'rm -f "$SRC" "$EMPTY"' EXIT
+  for mode in "" "-Cf" "-CF"; do
+    make -s -B lex.yy.c FLEXFLAGS="$mode"
+    make -s parser
+    tables=$(grep -c '^static const' lex.yy.c || true)
+    bytes=$(size -A parser | awk '$1 == ".rodata" { print $2 }')
+    echo "== flex ${mode:-(defaut)} : $tables tables, .rodata $bytes octets"
+    start=$(date +%s%N)
+    for _ in $(seq 100); do ./parser --bench-lex "$EMPTY" > /dev/null; done
+    echo "demarrage : $(( ($(date +%s%N) - start) / 100000 )) us par lancement"
+    for run in 1 2 3; do ./parser --bench-lex "$SRC"; done
+  done
+  # Retour au mode du Makefile
+  make -s -B lex.yy.c
+  make -s parser
+  exit 0
+fi
+
+# Meilleur debit de chaque lecture sur les trois essais : le tableau
+# avant/apres a reporter
+best_stdio=0
+best_mmap=0
+for run in 1 2 3; do
+  line=$(./parser --no-mmap --bench-lex "$SRC")
+  echo "$line"
+  best_stdio=$(echo "$line" | awk -v b="$best_stdio" '{ v = $(NF - 1); print (v > b ? v : b) }')
+  line=$(./parser --bench-lex "$SRC")
+  echo "$line"
+  best_mmap=$(echo "$line" | awk -v b="$best_mmap" '{ v = $(NF - 1); print (v > b ? v : b) }')
+done
+printf '%-28s %10s\n' "lecture ($SIZE_MB Mo)" "Mo/s"
+printf '%-28s %10.1f\n' "stdio (--no-mmap)" "$best_stdio"
+printf '%-28s %10.1f   (%+.1f %%)\n' "mmap + yy_scan_buffer" "$best_mmap" \
+  "$(awk -v a="$best_mmap" -v b="$best_stdio" 'BEGIN { print (b > 0 ? 100 * (a - b) / b : 0) }')"
@@ -0,0 +1,34 @@
+#!/usr/bin/env bash
+# Test de charge du serveur de compilation : demarre ./parser --server,
+# envoie N requetes depuis C clients paralleles (./mlclient --load) pour
+# chaque programme de tests/, affiche p50/p99 puis arrete le serveur.
+# Usage :
+#   scripts/load_server.sh [requetes] [clients] [options...]
+#   (200 requetes, 4 clients ; ex. options : --run, --emit=quads, -O0)
+set -euo pipefail
+
+if [ ! -x ./parser ] || [ ! -x ./mlclient ]; then
+  echo "parser or mlclient not found or not executable. Run 'make' first." >&2
+  exit 2
+fi
+
+REQUESTS=${1:-200}
+CLIENTS=${2:-4}
+shift $(( $# > 2 ? 2 : $# ))
+SOCKET=$(mktemp -u /tmp/mathlang_XXXXXX.sock)
+
+./parser -q --server "$SOCKET" &
+server=$!
+trap 'kill -TERM "$server" 2>/dev/null || true; wait "$server" 2>/dev/null || true' EXIT
+
+for _ in $(seq 50); do
+  [ -S "$SOCKET" ] && break
+  sleep 0.1
+done
+
+status=0
+for f in tests/*.ml; do
+  echo "== $(basename "$f") ${*:-}"
+  ./mlclient -s "$SOCKET" --load -n "$REQUESTS" -c "$CLIENTS" "$@" "$f" || status=1
+done
+exit $status
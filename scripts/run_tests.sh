@@ -9,21 +9,33 @@ fi
 RUN_TIMEOUT=5
 fail=0
 
+# Tests qui doivent etre refuses par le compilateur (erreurs de syntaxe
+# ou semantiques volontaires) : noms sans extension, separes par des
+# espaces. Tout autre test echoue au moindre code de sortie non nul.
+EXPECTED_FAILURES=""
+
+# Sortie attendue : tests/<test>.out, comparee a celle du programme ;
+# entree standard : tests/<test>.in s'il existe, vide sinon.
 echo "Running tests in tests/"
 for f in tests/*.ml; do
+  name=$(basename "$f" .ml)
   echo "=== $f ==="
   rm -f output.c output
 
-  if ! ./parser "$f"; then
-    echo "Test failed (parser crashed): $f" >&2
-    fail=1
+  status=0
+  ./parser "$f" || status=$?
+  if [[ " $EXPECTED_FAILURES " == *" $name "* ]]; then
+    if [ "$status" -eq 1 ] && [ ! -f output.c ]; then
+      echo "-- rejected as expected"
+    else
+      echo "Test failed (expected compilation errors, exit $status): $f" >&2
+      fail=1
+    fi
     continue
   fi
-
-  # Pas d'output.c genere : normal si le fichier contient des erreurs
-  # semantiques volontaires (ex: tests/test_semantic_errors.ml).
-  if [ ! -f output.c ]; then
-    echo "-- no output.c generated (ok if this test expects semantic errors)"
+  if [ "$status" -ne 0 ] || [ ! -f output.c ]; then
+    echo "Test failed (parser exit $status): $f" >&2
+    fail=1
     continue
   fi
 
@@ -33,7 +45,9 @@ for f in tests/*.ml; do
     continue
   fi
 
-  if timeout "$RUN_TIMEOUT" ./output < /dev/null > /dev/null; then
+  input=/dev/null
+  [ -f "tests/$name.in" ] && input="tests/$name.in"
+  if timeout "$RUN_TIMEOUT" ./output < "$input" > "output.txt"; then
     status=0
   else
     status=$?
@@ -49,12 +63,24 @@ for f in tests/*.ml; do
     continue
   fi
 
-  echo "-- ok (compiled and ran)"
+  if [ ! -f "tests/$name.out" ]; then
+    echo "Test failed (no expected output tests/$name.out): $f" >&2
+    fail=1
+    continue
+  fi
+  if ! diff -u "tests/$name.out" output.txt >&2; then
+    echo "Test failed (output differs from tests/$name.out): $f" >&2
+    fail=1
+    continue
+  fi
+
+  echo "-- ok (output matches tests/$name.out)"
 done
+rm -f output.txt
 
 if [ $fail -ne 0 ]; then
   echo "Some tests failed." >&2
   exit 1
 fi
 
-echo "All tests passed."
\ No newline at end of file
+echo "All tests passed."
@@ -0,0 +1,481 @@
+#define _GNU_SOURCE
+#include "server.h"
+#include "mathlang.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <errno.h>
+#include <signal.h>
+#include <unistd.h>
+#include <fcntl.h>
+#include <dirent.h>
+#include <pthread.h>
+#include <sys/socket.h>
+#include <sys/stat.h>
+#include <sys/un.h>
+#include <sys/wait.h>
+
+#define RUN_TIMEOUT 10      /* secondes accordees a un programme (--run) */
+
+/* ========================================================= */
+/*  TRAMES                                                    */
+/* ========================================================= */
+
+static int write_all(int fd, const char* data, size_t size) {
+    while (size > 0) {
+        ssize_t n = write(fd, data, size);
+        if (n < 0 && errno == EINTR) continue;
+        if (n <= 0) return -1;
+        data += n;
+        size -= (size_t)n;
+    }
+    return 0;
+}
+
+/* 1 : tout lu, 0 : fin de connexion avant le premier octet, -1 : erreur */
+static int read_all(int fd, char* data, size_t size) {
+    size_t got = 0;
+    while (got < size) {
+        ssize_t n = read(fd, data + got, size - got);
+        if (n < 0 && errno == EINTR) continue;
+        if (n < 0) return -1;
+        if (n == 0) return got == 0 ? 0 : -1;
+        got += (size_t)n;
+    }
+    return 1;
+}
+
+int ml_frame_write(int fd, char type, const char* data, size_t size) {
+    unsigned char header[5];
+    header[0] = (unsigned char)type;
+    header[1] = (unsigned char)(size >> 24);
+    header[2] = (unsigned char)(size >> 16);
+    header[3] = (unsigned char)(size >> 8);
+    header[4] = (unsigned char)size;
+    if (write_all(fd, (const char*)header, sizeof(header)) != 0) return -1;
+    return write_all(fd, data, size);
+}
+
+int ml_frame_read(int fd, char* type, char** data, size_t* size) {
+    unsigned char header[5];
+    int r = read_all(fd, (char*)header, sizeof(header));
+    if (r <= 0) return r;
+    size_t len = ((size_t)header[1] << 24) | ((size_t)header[2] << 16) |
+                 ((size_t)header[3] << 8) | (size_t)header[4];
+    if (len > ML_FRAME_MAX) return -1;
+    char* buf = (char*)malloc(len + 1);
+    if (!buf) return -1;
+    if (len > 0 && read_all(fd, buf, len) != 1) {
+        free(buf);
+        return -1;
+    }
+    buf[len] = '\0';
+    *type = (char)header[0];
+    *data = buf;
+    *size = len;
+    return 1;
+}
+
+/* ========================================================= */
+/*  ETAT DU SERVEUR                                           */
+/* ========================================================= */
+
+static char work_dir[] = "/tmp/mathlang_server_XXXXXX";
+static volatile sig_atomic_t stopping = 0;
+static pthread_mutex_t stats_lock = PTHREAD_MUTEX_INITIALIZER;
+static long served = 0;
+static long cache_hits = 0;
+
+static void on_stop_signal(int sig) {
+    (void)sig;
+    stopping = 1;
+}
+
+/* FNV-1a 64 bits */
+static unsigned long long hash_bytes(const char* data, size_t size) {
+    unsigned long long h = 14695981039346656037ULL;
+    for (size_t i = 0; i < size; i++) {
+        h ^= (unsigned char)data[i];
+        h *= 1099511628211ULL;
+    }
+    return h;
+}
+
+/* ========================================================= */
+/*  TRAITEMENT D'UNE REQUETE                                  */
+/* ========================================================= */
+
+enum { OUT_TOKENS, OUT_SYMBOLS, OUT_QUADS, OUT_REPORT, OUT_C, OUT_BIN, OUT_COUNT };
+
+static const char* const out_names[OUT_COUNT] = {
+    "tokens", "symbols", "quads", "report", "c", "bin"
+};
+static const char out_frames[OUT_COUNT] = {
+    ML_FRAME_TOKENS, ML_FRAME_SYMBOLS, ML_FRAME_QUADS, ML_FRAME_REPORT, ML_FRAME_C, ML_FRAME_BINARY
+};
+
+typedef struct {
+    char* text;
+    size_t size;
+    FILE* stream;
+} Capture;
+
+static FILE* capture_open(Capture* c) {
+    c->text = NULL;
+    c->size = 0;
+    c->stream = open_memstream(&c->text, &c->size);
+    return c->stream;
+}
+
+static void capture_close(Capture* c) {
+    if (c->stream) fclose(c->stream);
+    c->stream = NULL;
+}
+
+/* Lit les options de la requete ; ecrit l'erreur dans "diag" et
+   renvoie -1 sur une option inconnue */
+static int parse_request_options(MlOptions* o, char* text, int* outputs,
+                                 int* run, FILE* diag) {
+    int emit_given = 0;
+    for (char* save = NULL, *arg = strtok_r(text, " \t\n", &save); arg;
+         arg = strtok_r(NULL, " \t\n", &save)) {
+        int known = ml_parse_option(o, arg);
+        if (known > 0) {
+            continue;
+        } else if (known < 0) {
+            fprintf(diag, "Valeur invalide : %s (--unroll=0..%d, --memo-capacity=1..%d)\n",
+                    arg, OPT_MAX_UNROLL_FACTOR, MEMO_MAX_CAPACITY);
+            return -1;
+        } else if (strcmp(arg, "--run") == 0) {
+            *run = 1;
+        } else if (strncmp(arg, "--stop-after=", 13) == 0) {
+            const char* stage = arg + 13;
+            if (strcmp(stage, "lex") == 0) o->stop_after = ML_STAGE_LEX;
+            else if (strcmp(stage, "parse") == 0) o->stop_after = ML_STAGE_PARSE;
+            else if (strcmp(stage, "opt") == 0) o->stop_after = ML_STAGE_OPT;
+            else if (strcmp(stage, "c") == 0 || strcmp(stage, "bin") == 0) o->stop_after = ML_STAGE_C;
+            else {
+                fprintf(diag, "Etape inconnue pour --stop-after : %s\n", stage);
+                return -1;
+            }
+        } else if (strncmp(arg, "--emit=", 7) == 0) {
+            emit_given = 1;
+            for (char* s2 = NULL, *name = strtok_r(arg + 7, ",", &s2); name;
+                 name = strtok_r(NULL, ",", &s2)) {
+                int k = 0;
+                while (k < OUT_COUNT && strcmp(name, out_names[k]) != 0) k++;
+                if (k == OUT_COUNT) {
+                    fprintf(diag, "Sortie inconnue pour --emit : %s\n", name);
+                    return -1;
+                }
+                outputs[k] = 1;
+            }
+        } else {
+            fprintf(diag, "Option inconnue : %s\n", arg);
+            return -1;
+        }
+    }
+    if (!emit_given) outputs[OUT_C] = 1;     /* par defaut : le C */
+    if (*run) outputs[OUT_BIN] = 1;
+    return 0;
+}
+
+/* Executable du C "c_text" dans le repertoire de travail, nomme par le
+   hachage du C : un programme deja compile n'est pas repasse a gcc.
+   Renvoie le chemin (a liberer) ou NULL, *hit a 1 si deja present. */
+static char* build_binary(const char* c_text, size_t c_size, int* hit, FILE* diag) {
+    char* bin_path = NULL;
+    if (asprintf(&bin_path, "%s/%016llx", work_dir, hash_bytes(c_text, c_size)) < 0) return NULL;
+    *hit = access(bin_path, X_OK) == 0;
+    if (*hit) return bin_path;
+
+    /* Fichiers propres au thread, renommes une fois complets */
+    char c_path[sizeof(work_dir) + 32], tmp_bin[sizeof(work_dir) + 32];
+    snprintf(c_path, sizeof(c_path), "%s/tmp_XXXXXX.c", work_dir);
+    int fd = mkostemps(c_path, 2, O_CLOEXEC);
+    if (fd < 0 || write_all(fd, c_text, c_size) != 0) {
+        if (fd >= 0) close(fd);
+        fprintf(diag, "Erreur : impossible d'ecrire le C dans %s\n", work_dir);
+        free(bin_path);
+        return NULL;
+    }
+    close(fd);
+    snprintf(tmp_bin, sizeof(tmp_bin), "%.*s", (int)(strlen(c_path) - 2), c_path);
+
+    char* command = NULL;
+    int ok = asprintf(&command, "gcc \"%s\" -lm -o \"%s\" 2>&1", c_path, tmp_bin) >= 0;
+    FILE* gcc = ok ? popen(command, "re") : NULL;
+    if (gcc) {
+        char line[512];
+        while (fgets(line, sizeof(line), gcc)) fputs(line, diag);
+        ok = pclose(gcc) == 0;
+    } else {
+        ok = 0;
+    }
+    free(command);
+    /* Le C reserve le nom de tmp_bin : il n'est supprime qu'apres */
+    if (!ok || rename(tmp_bin, bin_path) != 0) {
+        fprintf(diag, "Erreur : la compilation du C par gcc a echoue\n");
+        remove(tmp_bin);
+        free(bin_path);
+        bin_path = NULL;
+    }
+    remove(c_path);
+    return bin_path;
+}
+
+/* Comme tmpfile(), mais ferme a l'exec : les programmes lances par les
+   autres threads n'heritent pas des entrees et sorties de celui-ci.
+   dup2() sur 0, 1 et 2 rend la copie visible au seul programme lance. */
+static FILE* private_tmpfile(void) {
+    char path[sizeof(work_dir) + 16];
+    snprintf(path, sizeof(path), "%s/io_XXXXXX", work_dir);
+    int fd = mkostemp(path, O_CLOEXEC);
+    if (fd < 0) return NULL;
+    unlink(path);
+    FILE* f = fdopen(fd, "w+");
+    if (!f) close(fd);
+    return f;
+}
+
+/* Execute "bin_path" avec "input" sur l'entree standard ; la sortie
+   (stdout et stderr) est renvoyee dans *out. Renvoie le code de sortie,
+   128 + signal si le programme est tue (RUN_TIMEOUT depasse : SIGALRM). */
+static int run_binary(const char* bin_path, const char* input, size_t input_size,
+                      char** out, size_t* out_size) {
+    FILE* in = private_tmpfile();
+    FILE* capture = private_tmpfile();
+    int status = -1;
+    *out = NULL;
+    *out_size = 0;
+    if (in && capture && (input_size == 0 || fwrite(input, 1, input_size, in) == input_size)) {
+        fflush(in);
+        rewind(in);
+        pid_t pid = fork();
+        if (pid == 0) {
+            dup2(fileno(in), STDIN_FILENO);
+            dup2(fileno(capture), STDOUT_FILENO);
+            dup2(fileno(capture), STDERR_FILENO);
+            alarm(RUN_TIMEOUT);
+            execl(bin_path, bin_path, (char*)NULL);
+            _exit(127);
+        }
+        int wstatus;
+        if (pid > 0 && waitpid(pid, &wstatus, 0) == pid) {
+            status = WIFEXITED(wstatus) ? WEXITSTATUS(wstatus) : 128 + WTERMSIG(wstatus);
+        }
+        off_t size = lseek(fileno(capture), 0, SEEK_END);
+        if (size > 0) {
+            *out = (char*)malloc((size_t)size);
+            if (*out && pread(fileno(capture), *out, (size_t)size, 0) == size) {
+                *out_size = (size_t)size;
+            }
+        }
+    }
+    if (in) fclose(in);
+    if (capture) fclose(capture);
+    return status;
+}
+
+/* Compile (et execute) une requete et ecrit la reponse sur "fd" */
+static int serve_request(int fd, char* options, const char* source, size_t source_size,
+                         const char* input, size_t input_size) {
+    MathLangContext ctx;
+    ml_context_init(&ctx);
+    MlOptions* o = &ctx.options;
+    int outputs[OUT_COUNT] = { 0 };
+    int run = 0, status = 1, hit = 0, run_status = -1;
+    Capture diag, dumps[OUT_BIN];
+    memset(dumps, 0, sizeof(dumps));
+    capture_open(&diag);
+
+    char* bin_path = NULL;
+    char* run_out = NULL;
+    size_t run_size = 0;
+    if (parse_request_options(o, options, outputs, &run, diag.stream) == 0) {
+        if (outputs[OUT_TOKENS]) o->tokens_out = capture_open(&dumps[OUT_TOKENS]);
+        if (outputs[OUT_SYMBOLS]) o->symbols_out = capture_open(&dumps[OUT_SYMBOLS]);
+        if (outputs[OUT_QUADS]) o->quads_out = capture_open(&dumps[OUT_QUADS]);
+        if (outputs[OUT_REPORT]) o->opt.report = capture_open(&dumps[OUT_REPORT]);
+        if ((outputs[OUT_C] || outputs[OUT_BIN]) && o->stop_after == ML_STAGE_C) {
+            o->c_out = capture_open(&dumps[OUT_C]);
+        }
+        o->diagnostics = diag.stream;
+
+        status = ml_compile_string(&ctx, source, source_size) == 0 ? 0 : 1;
+        for (int k = 0; k < OUT_BIN; k++) capture_close(&dumps[k]);
+
+        if (status == 0 && ctx.c_generated && outputs[OUT_BIN]) {
+            bin_path = build_binary(dumps[OUT_C].text, dumps[OUT_C].size, &hit, diag.stream);
+            if (!bin_path) status = 1;
+        }
+        if (bin_path && run) {
+            run_status = run_binary(bin_path, input, input_size, &run_out, &run_size);
+        }
+    }
+    capture_close(&diag);
+
+    int rc = 0;
+    if (diag.size > 0) rc |= ml_frame_write(fd, ML_FRAME_DIAGNOSTICS, diag.text, diag.size);
+    for (int k = 0; k < OUT_BIN; k++) {
+        if (outputs[k] && dumps[k].text) {
+            rc |= ml_frame_write(fd, out_frames[k], dumps[k].text, dumps[k].size);
+        }
+    }
+    if (bin_path) rc |= ml_frame_write(fd, ML_FRAME_BINARY, bin_path, strlen(bin_path));
+    if (run_status >= 0) rc |= ml_frame_write(fd, ML_FRAME_RUN, run_out ? run_out : "", run_size);
+
+    char summary[64];
+    int n = run_status >= 0
+        ? snprintf(summary, sizeof(summary), "status=%d cache=%d run=%d", status, hit, run_status)
+        : snprintf(summary, sizeof(summary), "status=%d cache=%d", status, hit);
+    rc |= ml_frame_write(fd, ML_FRAME_STATUS, summary, (size_t)n);
+
+    pthread_mutex_lock(&stats_lock);
+    served++;
+    cache_hits += hit;
+    pthread_mutex_unlock(&stats_lock);
+
+    free(diag.text);
+    for (int k = 0; k < OUT_BIN; k++) free(dumps[k].text);
+    free(bin_path);
+    free(run_out);
+    return rc;
+}
+
+/* Un thread par client : requetes successives jusqu'a la fermeture */
+static void* client_main(void* arg) {
+    int fd = (int)(long)arg;
+    char* options = strdup("");
+    char* source = NULL;
+    char* input = NULL;
+    size_t source_size = 0, input_size = 0;
+    for (;;) {
+        char type;
+        char* data;
+        size_t size;
+        if (ml_frame_read(fd, &type, &data, &size) != 1) break;
+        if (type == ML_FRAME_OPTIONS) {
+            free(options);
+            options = data;
+        } else if (type == ML_FRAME_SOURCE) {
+            free(source);
+            source = data;
+            source_size = size;
+        } else if (type == ML_FRAME_INPUT) {
+            free(input);
+            input = data;
+            input_size = size;
+        } else if (type == ML_FRAME_GO) {
+            free(data);
+            int rc = serve_request(fd, options, source ? source : "", source_size,
+                                   input, input_size);
+            /* Une requete ne herite pas des trames de la precedente */
+            free(options);
+            free(source);
+            free(input);
+            options = strdup("");
+            source = input = NULL;
+            source_size = input_size = 0;
+            if (rc != 0) break;
+        } else {
+            free(data);
+            break;
+        }
+    }
+    free(options);
+    free(source);
+    free(input);
+    close(fd);
+    return NULL;
+}
+
+/* ========================================================= */
+/*  BOUCLE D'ACCEPTATION                                      */
+/* ========================================================= */
+
+static void remove_work_dir(void) {
+    DIR* dir = opendir(work_dir);
+    if (!dir) return;
+    struct dirent* e;
+    while ((e = readdir(dir)) != NULL) {
+        if (strcmp(e->d_name, ".") == 0 || strcmp(e->d_name, "..") == 0) continue;
+        char path[sizeof(work_dir) + 256];
+        snprintf(path, sizeof(path), "%s/%s", work_dir, e->d_name);
+        remove(path);
+    }
+    closedir(dir);
+    rmdir(work_dir);
+}
+
+int ml_server_run(const char* socket_path, int quiet) {
+    struct sockaddr_un addr;
+    memset(&addr, 0, sizeof(addr));
+    addr.sun_family = AF_UNIX;
+    if (strlen(socket_path) >= sizeof(addr.sun_path)) {
+        fprintf(stderr, "Serveur : chemin de socket trop long : %s\n", socket_path);
+        return 1;
+    }
+    strcpy(addr.sun_path, socket_path);
+
+    /* Une socket laissee par un serveur arrete est remplacee */
+    struct stat st;
+    if (lstat(socket_path, &st) == 0 && S_ISSOCK(st.st_mode)) unlink(socket_path);
+
+    /* Socket reservee au proprietaire : les droits sont fixes avant
+       listen(), aucun client ne peut se connecter entre les deux */
+    int listen_fd = socket(AF_UNIX, SOCK_STREAM | SOCK_CLOEXEC, 0);
+    int bound = listen_fd >= 0 && bind(listen_fd, (struct sockaddr*)&addr, sizeof(addr)) == 0;
+    if (!bound || chmod(socket_path, 0600) != 0 || listen(listen_fd, 64) != 0) {
+        fprintf(stderr, "Serveur : impossible d'ecouter sur %s : %s\n",
+                socket_path, strerror(errno));
+        if (listen_fd >= 0) close(listen_fd);
+        if (bound) unlink(socket_path);
+        return 1;
+    }
+    if (!mkdtemp(work_dir)) {
+        fprintf(stderr, "Serveur : impossible de creer le repertoire de travail\n");
+        close(listen_fd);
+        unlink(socket_path);
+        return 1;
+    }
+
+    /* Pas de SA_RESTART : accept4() rend la main sur SIGINT/SIGTERM */
+    struct sigaction sa;
+    memset(&sa, 0, sizeof(sa));
+    sa.sa_handler = on_stop_signal;
+    sigaction(SIGINT, &sa, NULL);
+    sigaction(SIGTERM, &sa, NULL);
+    signal(SIGPIPE, SIG_IGN);
+
+    if (!quiet) {
+        printf("Serveur : ecoute sur %s (executables dans %s)\n", socket_path, work_dir);
+        fflush(stdout);
+    }
+
+    pthread_attr_t attr;
+    pthread_attr_init(&attr);
+    pthread_attr_setdetachstate(&attr, PTHREAD_CREATE_DETACHED);
+    while (!stopping) {
+        int fd = accept4(listen_fd, NULL, NULL, SOCK_CLOEXEC);
+        if (fd < 0) {
+            if (errno == EINTR || errno == ECONNABORTED) continue;
+            fprintf(stderr, "Serveur : accept : %s\n", strerror(errno));
+            break;
+        }
+        pthread_t thread;
+        if (pthread_create(&thread, &attr, client_main, (void*)(long)fd) != 0) close(fd);
+    }
+    pthread_attr_destroy(&attr);
+    close(listen_fd);
+    unlink(socket_path);
+    remove_work_dir();
+
+    if (!quiet) {
+        pthread_mutex_lock(&stats_lock);
+        printf("Serveur : %ld requete(s), %ld executable(s) repris du cache\n",
+               served, cache_hits);
+        pthread_mutex_unlock(&stats_lock);
+    }
+    return 0;
+}
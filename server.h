@@ -0,0 +1,58 @@
+#ifndef SERVER_H
+#define SERVER_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+/* ========================================================= */
+/*  SERVEUR DE COMPILATION (socket Unix)                      */
+/* ========================================================= */
+/*
+ * Echange par trames : un octet de type, la longueur du contenu sur
+ * 4 octets (gros-boutiste), puis le contenu.
+ *
+ * Requete (client -> serveur), terminee par ML_FRAME_GO :
+ *   'O' options, separees par des espaces (-O0, -fno-inline...,
+ *       --emit=tokens,symbols,quads,report,c,bin, --stop-after=<etape>,
+ *       --run : executer le programme)
+ *   'S' texte du source
+ *   'I' entree standard du programme (--run)
+ *
+ * Reponse, terminee par ML_FRAME_STATUS ("<code> cache=<0|1>") :
+ *   'D' diagnostics, 'T' tokens, 'Y' symboles, 'Q' quadruplets,
+ *   'P' rapport des optimisations, 'C' code C, 'B' chemin de
+ *   l'executable, 'R' sortie du programme (--run)
+ *
+ * Une connexion peut enchainer plusieurs requetes.
+ */
+
+#define ML_FRAME_OPTIONS     'O'
+#define ML_FRAME_SOURCE      'S'
+#define ML_FRAME_INPUT       'I'
+#define ML_FRAME_GO          'G'
+#define ML_FRAME_DIAGNOSTICS 'D'
+#define ML_FRAME_TOKENS      'T'
+#define ML_FRAME_SYMBOLS     'Y'
+#define ML_FRAME_QUADS       'Q'
+#define ML_FRAME_REPORT      'P'
+#define ML_FRAME_C           'C'
+#define ML_FRAME_BINARY      'B'
+#define ML_FRAME_RUN         'R'
+#define ML_FRAME_STATUS      'X'
+
+#define ML_FRAME_MAX (64u << 20)    /* trames de plus de 64 Mo refusees */
+
+/* 0 si la trame est ecrite entierement, -1 sinon */
+int ml_frame_write(int fd, char type, const char* data, size_t size);
+
+/* Lit une trame : *data (termine par '\0', a liberer) et *size.
+   1 : trame lue, 0 : fin de connexion, -1 : erreur */
+int ml_frame_read(int fd, char* type, char** data, size_t* size);
+
+/* Ecoute sur "socket_path" et sert chaque client dans son thread,
+   jusqu'a SIGINT/SIGTERM. Les executables sont produits dans un
+   repertoire de travail et reutilises pour un meme source et les memes
+   options. Renvoie 1 si la socket ne peut etre ouverte. */
+int ml_server_run(const char* socket_path, int quiet);
+
+#endif
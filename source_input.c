@@ -0,0 +1,75 @@
+#include "source_input.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+
+/* Copie du fichier dans un tampon termine par deux nuls */
+static int load_copy(int fd, size_t size, SourceInput* in) {
+    char* data = (char*)malloc(size + 2);
+    if (!data) return -1;
+    size_t done = 0;
+    while (done < size) {
+        ssize_t n = read(fd, data + done, size - done);
+        if (n < 0 && errno == EINTR) continue;
+        if (n <= 0) {
+            free(data);
+            if (n == 0) errno = EIO;   /* fichier raccourci pendant la lecture */
+            return -1;
+        }
+        done += (size_t)n;
+    }
+    data[size] = data[size + 1] = '\0';
+    in->data = data;
+    in->size = size;
+    in->map_size = 0;
+    return 0;
+}
+
+int source_load(const char* path, SourceInput* in) {
+    memset(in, 0, sizeof(*in));
+    int fd = open(path, O_RDONLY);
+    if (fd < 0) return -1;
+
+    struct stat st;
+    int bad = (fstat(fd, &st) < 0) ? errno : (!S_ISREG(st.st_mode) ? EINVAL : 0);
+    if (bad) {
+        close(fd);
+        errno = bad;   /* tube, terminal... : le pilote repasse par stdio */
+        return -1;
+    }
+    size_t size = (size_t)st.st_size;
+    size_t page = (size_t)sysconf(_SC_PAGESIZE);
+    size_t tail = size % page;
+
+    int status;
+    if (size > 0 && tail != 0 && tail <= page - 2) {
+        /* Les deux nuls sont dans la derniere page, deja remplie de zeros */
+        void* map = mmap(NULL, size + 2, PROT_READ | PROT_WRITE, MAP_PRIVATE, fd, 0);
+        if (map != MAP_FAILED) {
+            in->data = (char*)map;
+            in->size = size;
+            in->map_size = size + 2;
+            status = 0;
+        } else {
+            status = load_copy(fd, size, in);
+        }
+    } else {
+        status = load_copy(fd, size, in);
+    }
+    int saved = errno;
+    close(fd);
+    errno = saved;
+    return status;
+}
+
+void source_release(SourceInput* in) {
+    if (!in->data) return;
+    if (in->map_size > 0) munmap(in->data, in->map_size);
+    else free(in->data);
+    memset(in, 0, sizeof(*in));
+}
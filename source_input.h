@@ -0,0 +1,27 @@
+#ifndef SOURCE_INPUT_H
+#define SOURCE_INPUT_H
+
+#include <stddef.h>
+
+/*
+ * Fichier source en memoire, pret pour yy_scan_buffer : le contenu est
+ * suivi de deux octets nuls, et le tampon est modifiable (flex y pose
+ * temporairement un '\0' a la fin de chaque yytext).
+ *
+ * Un fichier regulier est projete par mmap (MAP_PRIVATE : les ecritures
+ * de flex ne touchent pas le fichier) quand les deux nuls tiennent dans
+ * la derniere page, que le noyau complete par des zeros. Sinon (taille
+ * multiple de la page, fichier vide...) le contenu est copie dans un
+ * tampon alloue, deux octets plus grand.
+ */
+typedef struct {
+    char* data;        /* contenu + "\0\0" */
+    size_t size;       /* taille du fichier, sans les deux nuls */
+    size_t map_size;   /* longueur projetee (0 : tampon alloue) */
+} SourceInput;
+
+/* 0 si le fichier est charge, -1 sinon (errno indique pourquoi) */
+int source_load(const char* path, SourceInput* in);
+void source_release(SourceInput* in);
+
+#endif
@@ -3,8 +3,9 @@
 #include <stdlib.h>
 #include <string.h>
 
-static SemanticErrorMode error_mode = SEMANTIC_FATAL;
-static int semantic_error_count = 0;
+static _Thread_local SemanticErrorMode error_mode = SEMANTIC_FATAL;
+static _Thread_local int semantic_error_count = 0;
+static _Thread_local FILE* diagnostic_out = NULL;   /* NULL : stderr */
 
 /* ========================================================= */
 /* UTILITAIRES                                               */
@@ -26,19 +27,35 @@ unsigned int hash_function(const char* name) {
     int c;
     while ((c = *name++))
         hash = ((hash << 5) + hash) + c;
-    return hash % HASH_TABLE_SIZE;
+    return hash;
 }
 
 /* ========================================================= */
 /* INITIALISATION / DESTRUCTION                               */
 /* ========================================================= */
 
+static void free_entry(SymbolEntry* e) {
+    free(e->details);
+    free(e);
+}
+
+static SymbolSlot* alloc_slots(int capacity) {
+    SymbolSlot* slots = calloc((size_t)capacity, sizeof(SymbolSlot));
+    if (!slots) {
+        perror("calloc");
+        exit(EXIT_FAILURE);
+    }
+    return slots;
+}
+
 SymbolTable* init_symbol_table(void) {
     SymbolTable* table = calloc(1, sizeof(SymbolTable));
     if (!table) {
         perror("calloc");
         exit(EXIT_FAILURE);
     }
+    table->capacity = SYMBOL_TABLE_MIN_CAPACITY;
+    table->slots = alloc_slots(table->capacity);
     table->current_scope = 0;
     table->scopes = NULL;
     return table;
@@ -50,19 +67,68 @@ void free_symbol_table(SymbolTable* table) {
     while (table->scopes)
         exit_scope(table);
 
-    for (int i = 0; i < HASH_TABLE_SIZE; i++) {
-        SymbolEntry* e = table->entries[i];
+    for (int i = 0; i < table->capacity; i++) {
+        SymbolEntry* e = table->slots[i].decls;
         while (e) {
             SymbolEntry* next = e->next;
-            free(e->name);
-            free(e->details);
-            free(e);
+            free_entry(e);
             e = next;
         }
+        free(table->slots[i].name);
     }
+    free(table->slots);
     free(table);
 }
 
+/* ========================================================= */
+/* ALVÉOLES ET NOMS INTERNÉS                                  */
+/* ========================================================= */
+
+/* Alvéole du nom, ou alvéole libre où l'insérer. Un nom déjà interné
+   (entry->name) est reconnu par simple comparaison de pointeurs ; sinon
+   le hash mémorisé écarte les autres noms avant strcmp. */
+static SymbolSlot* find_slot(const SymbolTable* table, const char* name, unsigned h) {
+    unsigned mask = (unsigned)table->capacity - 1;
+    for (unsigned i = h & mask;; i = (i + 1) & mask) {
+        SymbolSlot* slot = &table->slots[i];
+        if (!slot->name || slot->name == name ||
+            (slot->hash == h && strcmp(slot->name, name) == 0))
+            return slot;
+    }
+}
+
+static void grow_table(SymbolTable* table) {
+    SymbolSlot* old = table->slots;
+    int old_capacity = table->capacity;
+    table->capacity *= 2;
+    table->slots = alloc_slots(table->capacity);
+
+    unsigned mask = (unsigned)table->capacity - 1;
+    for (int i = 0; i < old_capacity; i++) {
+        if (!old[i].name) continue;
+        unsigned k = old[i].hash & mask;
+        while (table->slots[k].name) k = (k + 1) & mask;
+        table->slots[k] = old[i];
+    }
+    free(old);
+}
+
+/* Alvéole du nom, créée (nom interné) si besoin */
+static SymbolSlot* intern_slot(SymbolTable* table, const char* name) {
+    unsigned h = hash_function(name);
+    SymbolSlot* slot = find_slot(table, name, h);
+    if (slot->name) return slot;
+
+    if ((table->used + 1) * 100 > table->capacity * SYMBOL_TABLE_MAX_LOAD) {
+        grow_table(table);
+        slot = find_slot(table, name, h);
+    }
+    slot->name = string_duplicate(name);
+    slot->hash = h;
+    table->used++;
+    return slot;
+}
+
 /* ========================================================= */
 /* PORTÉES                                                   */
 /* ========================================================= */
@@ -74,31 +140,30 @@ void enter_scope(SymbolTable* table) {
     table->scopes = s;
 }
 
+/* Détache "e" des déclarations de son nom. Les symboles de la portée la
+   plus interne sont en tête : la recherche s'arrête aussitôt. */
+static void unlink_declaration(SymbolTable* table, SymbolEntry* e) {
+    SymbolSlot* slot = find_slot(table, e->name, hash_function(e->name));
+    SymbolEntry** link = &slot->decls;
+    while (*link && *link != e)
+        link = &(*link)->next;
+    if (*link) *link = e->next;
+}
+
+/* Coût proportionnel au nombre de symboles de la portée */
 void exit_scope(SymbolTable* table) {
     if (!table || !table->scopes) return;
 
-    int level = table->current_scope;
-
-    for (int i = 0; i < HASH_TABLE_SIZE; i++) {
-        SymbolEntry *e = table->entries[i], *prev = NULL;
-        while (e) {
-            if (e->scope_level == level) {
-                SymbolEntry* del = e;
-                e = e->next;
-                if (prev) prev->next = e;
-                else table->entries[i] = e;
-                free(del->name);
-                free(del->details);
-                free(del);
-                table->count--;
-            } else {
-                prev = e;
-                e = e->next;
-            }
-        }
+    ScopeStack* old = table->scopes;
+    SymbolEntry* e = old->symbols;
+    while (e) {
+        SymbolEntry* next = e->scope_next;
+        unlink_declaration(table, e);
+        free_entry(e);
+        table->count--;
+        e = next;
     }
 
-    ScopeStack* old = table->scopes;
     table->scopes = old->parent;
     free(old);
     table->current_scope--;
@@ -116,66 +181,59 @@ bool add_symbol(SymbolTable* table,
                 int line,
                 int col) {
 
-    SymbolEntry* old = find_symbol_in_current_scope(table, name);
-    if (old) {
+    SymbolSlot* slot = intern_slot(table, name);
+    if (slot->decls && slot->decls->scope_level == table->current_scope) {
         error_redeclared_symbol(name, line, col, 0);
         return false;
     }
 
     SymbolEntry* e = calloc(1, sizeof(SymbolEntry));
-    e->name = string_duplicate(name);
+    e->name = slot->name;
     e->category = category;
     e->type = type;
     e->subtype = subtype;
     e->scope_level = table->current_scope;
     e->is_const = (category == SYMBOL_CONSTANT);
 
-    unsigned idx = hash_function(name);
-    e->next = table->entries[idx];
-    table->entries[idx] = e;
+    /* En tête : la portée courante est la plus interne, la première
+       déclaration du nom est donc celle qui est visible */
+    e->next = slot->decls;
+    slot->decls = e;
+    if (table->scopes) {
+        e->scope_next = table->scopes->symbols;
+        table->scopes->symbols = e;
+    }
     table->count++;
     return true;
 }
 
 SymbolEntry* find_symbol(SymbolTable* table, const char* name) {
-    unsigned idx = hash_function(name);
-    SymbolEntry* best = NULL;
-    int best_scope = -1;
-
-    for (SymbolEntry* e = table->entries[idx]; e; e = e->next) {
-        if (!strcmp(e->name, name) && e->scope_level >= best_scope) {
-            best = e;
-            best_scope = e->scope_level;
-        }
-    }
-    return best;
+    SymbolSlot* slot = find_slot(table, name, hash_function(name));
+    return slot->decls;
 }
 
 SymbolEntry* find_symbol_in_current_scope(SymbolTable* table, const char* name) {
-    unsigned idx = hash_function(name);
-    for (SymbolEntry* e = table->entries[idx]; e; e = e->next)
-        if (!strcmp(e->name, name) && e->scope_level == table->current_scope)
-            return e;
-    return NULL;
+    SymbolEntry* e = find_symbol(table, name);
+    return (e && e->scope_level == table->current_scope) ? e : NULL;
 }
 
+/* Retire la déclaration la plus interne de "name" */
 bool remove_symbol(SymbolTable* table, const char* name) {
-    unsigned idx = hash_function(name);
-    SymbolEntry *e = table->entries[idx], *prev = NULL;
-    while (e) {
-        if (!strcmp(e->name, name)) {
-            if (prev) prev->next = e->next;
-            else table->entries[idx] = e->next;
-            free(e->name);
-            free(e->details);
-            free(e);
-            table->count--;
-            return true;
-        }
-        prev = e;
-        e = e->next;
+    SymbolEntry* e = find_symbol(table, name);
+    if (!e) return false;
+
+    unlink_declaration(table, e);
+    for (ScopeStack* s = table->scopes; s; s = s->parent) {
+        if (s->level != e->scope_level) continue;
+        SymbolEntry** link = &s->symbols;
+        while (*link && *link != e)
+            link = &(*link)->scope_next;
+        if (*link) *link = e->scope_next;
+        break;
     }
-    return false;
+    free_entry(e);
+    table->count--;
+    return true;
 }
 
 void update_symbol_details(SymbolEntry* entry, TypeDetails* details) {
@@ -388,18 +446,18 @@ bool check_comparable_types(DataType left, DataType right) {
 
 void semantic_error(const char* msg, int line, int col) {
     semantic_error_count++;
-    fprintf(stderr, "ERREUR [%d:%d] %s\n", line, col, msg);
+    fprintf(diagnostic_stream(), "ERREUR [%d:%d] %s\n", line, col, msg);
     if (error_mode == SEMANTIC_FATAL)
     exit(EXIT_FAILURE);
 }
 
 void semantic_warning(const char* msg, int line, int col) {
-    fprintf(stderr, "AVERTISSEMENT [%d:%d] %s\n", line, col, msg);
+    fprintf(diagnostic_stream(), "AVERTISSEMENT [%d:%d] %s\n", line, col, msg);
 }
 
 void error_undeclared_symbol(const char* name, int line, int col) {
     semantic_error_count++;
-    fprintf(stderr, "ERREUR [%d:%d] symbole '%s' non déclaré\n", line, col, name);
+    fprintf(diagnostic_stream(), "ERREUR [%d:%d] symbole '%s' non déclaré\n", line, col, name);
     if (error_mode == SEMANTIC_FATAL)
     exit(EXIT_FAILURE);
 }
@@ -407,11 +465,11 @@ void error_undeclared_symbol(const char* name, int line, int col) {
 void error_redeclared_symbol(const char* name, int line, int col, int prev_line) {
     semantic_error_count++;
     if (prev_line > 0) {
-        fprintf(stderr,
+        fprintf(diagnostic_stream(),
                 "ERREUR [%d:%d] symbole '%s' déjà déclaré (ligne %d)\n",
                 line, col, name, prev_line);
     } else {
-        fprintf(stderr,
+        fprintf(diagnostic_stream(),
                 "ERREUR [%d:%d] symbole '%s' déjà déclaré\n",
                 line, col, name);
     }
@@ -421,7 +479,7 @@ void error_redeclared_symbol(const char* name, int line, int col, int prev_line)
 
 void error_type_mismatch(DataType expected, DataType found, int line, int col) {
     semantic_error_count++;
-    fprintf(stderr,
+    fprintf(diagnostic_stream(),
             "ERREUR [%d:%d] type attendu %s, trouvé %s\n",
             line, col,
             type_to_string(expected),
@@ -438,7 +496,7 @@ void error_uninitialized_variable(const char* name, int line, int col) {
 
 void error_const_assignment(const char* name, int line, int col) {
     semantic_error_count++;
-    fprintf(stderr,
+    fprintf(diagnostic_stream(),
             "ERREUR [%d:%d] tentative de modification de la constante '%s'\n",
             line, col, name);
     if (error_mode == SEMANTIC_FATAL)
@@ -453,6 +511,18 @@ int get_semantic_error_count(void) {
     return semantic_error_count;
 }
 
+void reset_semantic_error_count(void) {
+    semantic_error_count = 0;
+}
+
+void set_diagnostic_stream(FILE* out) {
+    diagnostic_out = out;
+}
+
+FILE* diagnostic_stream(void) {
+    return diagnostic_out ? diagnostic_out : stderr;
+}
+
 
 /* ========================================================= */
 /* AFFICHAGE                                                 */
@@ -497,24 +567,24 @@ static int cmp_entries(const void* a, const void* b) {
     return strcmp(ea->name, eb->name);
 }
 
-void print_symbol_table(const SymbolTable* table) {
+void fprint_symbol_table(FILE* out, const SymbolTable* table) {
     if (!table) {
-        printf("Symbol table: (null)\n");
+        fprintf(out, "Symbol table: (null)\n");
         return;
     }
 
-    printf("\n=== SYMBOL TABLE (%d symbols) ===\n", table->count);
-    printf("%-20s %-10s %-10s %-5s %-6s %-6s %-6s\n",
-           "Name", "Category", "Type", "Scope", "Const", "Init", "Used");
-    printf("-----------------------------------------------------------------------\n");
+    fprintf(out, "\n=== SYMBOL TABLE (%d symbols) ===\n", table->count);
+    fprintf(out, "%-20s %-10s %-10s %-5s %-6s %-6s %-6s\n",
+            "Name", "Category", "Type", "Scope", "Const", "Init", "Used");
+    fprintf(out, "-----------------------------------------------------------------------\n");
 
     SymbolEntry** list = NULL;
     if (table->count > 0) {
         list = (SymbolEntry**)malloc(sizeof(SymbolEntry*) * table->count);
     }
     int idx = 0;
-    for (int i = 0; i < HASH_TABLE_SIZE; i++) {
-        for (SymbolEntry* e = table->entries[i]; e; e = e->next) {
+    for (int i = 0; i < table->capacity; i++) {
+        for (SymbolEntry* e = table->slots[i].decls; e; e = e->next) {
             if (list && idx < table->count) list[idx++] = e;
         }
     }
@@ -522,16 +592,20 @@ void print_symbol_table(const SymbolTable* table) {
 
     for (int i = 0; i < idx; i++) {
         SymbolEntry* e = list[i];
-        printf("%-20s %-10s %-10s %-5d %-6s %-6s %-6s\n",
-               e->name,
-               category_to_string(e->category),
-               type_to_string(e->type),
-               e->scope_level,
-               e->is_const ? "yes" : "no",
-               e->is_initialized ? "yes" : "no",
-               e->is_used ? "yes" : "no");
+        fprintf(out, "%-20s %-10s %-10s %-5d %-6s %-6s %-6s\n",
+                e->name,
+                category_to_string(e->category),
+                type_to_string(e->type),
+                e->scope_level,
+                e->is_const ? "yes" : "no",
+                e->is_initialized ? "yes" : "no",
+                e->is_used ? "yes" : "no");
     }
 
     free(list);
-    printf("=======================================================================\n");
-}
\ No newline at end of file
+    fprintf(out, "=======================================================================\n");
+}
+
+void print_symbol_table(const SymbolTable* table) {
+    fprint_symbol_table(stdout, table);
+}
@@ -1,6 +1,7 @@
 #ifndef SYMBOL_TABLE_H
 #define SYMBOL_TABLE_H
 
+#include <stdio.h>
 #include <stdbool.h>
 
 /* ========================================================= */
@@ -111,7 +112,7 @@ typedef struct {
 /* ========================================================= */
 
 typedef struct SymbolEntry {
-    char* name;
+    char* name;                       /* interné : appartient à la table */
     SymbolCategory category;
 
     DataType type;
@@ -125,7 +126,8 @@ typedef struct SymbolEntry {
 
     TypeDetails* details;
 
-    struct SymbolEntry* next;
+    struct SymbolEntry* next;         /* déclaration masquée du même nom */
+    struct SymbolEntry* scope_next;   /* déclaré avant dans la même portée */
 } SymbolEntry;
 
 /* ========================================================= */
@@ -134,6 +136,7 @@ typedef struct SymbolEntry {
 
 typedef struct ScopeStack {
     int level;
+    SymbolEntry* symbols;   /* symboles de la portée, du plus récent au plus ancien */
     struct ScopeStack* parent;
 } ScopeStack;
 
@@ -141,11 +144,23 @@ typedef struct ScopeStack {
 /*                 TABLE DES SYMBOLES                         */
 /* ========================================================= */
 
-#define HASH_TABLE_SIZE 211
+/* Alvéole : un nom interné et ses déclarations visibles, de la plus
+   interne à la plus externe. Un nom reste interné jusqu'à la
+   destruction de la table, même sans déclaration. */
+typedef struct {
+    char* name;             /* NULL : alvéole libre */
+    unsigned int hash;      /* hash_function(name) */
+    SymbolEntry* decls;
+} SymbolSlot;
+
+#define SYMBOL_TABLE_MIN_CAPACITY 256    /* puissance de 2 */
+#define SYMBOL_TABLE_MAX_LOAD 70         /* en %, au-delà la table double */
 
 typedef struct {
-    SymbolEntry* entries[HASH_TABLE_SIZE];
-    int count;
+    SymbolSlot* slots;      /* adressage ouvert, sondage linéaire */
+    int capacity;
+    int used;               /* alvéoles occupées (noms internés) */
+    int count;              /* déclarations visibles */
     int current_scope;
     ScopeStack* scopes;
 } SymbolTable;
@@ -181,6 +196,7 @@ void mark_symbol_initialized(SymbolEntry* entry);
 
 /* Debug */
 void print_symbol_table(const SymbolTable* table);
+void fprint_symbol_table(FILE* out, const SymbolTable* table);
 
 /* ========================================================= */
 /*                 SÉMANTIQUE / TYPES                         */
@@ -242,5 +258,9 @@ typedef enum {
 
 void set_semantic_error_mode(SemanticErrorMode mode);
 int get_semantic_error_count(void);
+void reset_semantic_error_count(void);
+/* Flux des erreurs et avertissements (NULL : stderr), propre au thread */
+void set_diagnostic_stream(FILE* out);
+FILE* diagnostic_stream(void);
 
 #endif /* SYMBOL_TABLE_H */
\ No newline at end of file
@@ -0,0 +1,321 @@
+/* ============================================ */
+/* TEST DE LIBMATHLANG - COMPILATION EN THREADS */
+/* ============================================ */
+
+#include "mathlang.h"
+#include <pthread.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdbool.h>
+#include <unistd.h>
+
+/* Couleurs pour l'affichage */
+#define COLOR_GREEN "\033[0;32m"
+#define COLOR_RED "\033[0;31m"
+#define COLOR_BLUE "\033[0;34m"
+#define COLOR_RESET "\033[0m"
+
+#define NTHREADS 8
+#define ROUNDS 20
+
+static int tests_passed = 0;
+static int tests_failed = 0;
+
+/* Deux programmes differents : fonctions, boucles, appels constants */
+static const char* const programs[2] = {
+    "FONCTION fact(n : Z) : Z\n"
+    "    SI n <= 1 ALORS\n"
+    "        RETOURNER 1\n"
+    "    FIN\n"
+    "    RETOURNER n * fact(n - 1)\n"
+    "FIN\n"
+    "SOIT s dans Z tel que s <- 0\n"
+    "POUR i DE 1 A 10 FAIRE\n"
+    "    s <- s + fact(i) * i\n"
+    "FIN\n"
+    "AFFICHER_LIGNE(s)\n",
+
+    "FONCTION carre(x : R) : R\n"
+    "    RETOURNER x * x\n"
+    "FIN\n"
+    "SOIT total dans R tel que total <- 0.0\n"
+    "SOIT k dans Z tel que k <- 0\n"
+    "TANT QUE k < 50 FAIRE\n"
+    "    total <- total + carre(1.5)\n"
+    "    k <- k + 1\n"
+    "FIN\n"
+    "AFFICHER_LIGNE(total)\n",
+};
+
+/* ========================================================= */
+/* OUTILS DE TEST                                            */
+/* ========================================================= */
+
+static void print_test_header(const char *test_name)
+{
+    printf("\n" COLOR_BLUE
+           "═══════════════════════════════════════════════════════════\n"
+           "  TEST: %s\n"
+           "═══════════════════════════════════════════════════════════" COLOR_RESET "\n",
+           test_name);
+}
+
+static void assert_test(const char *description, bool condition)
+{
+    if (condition)
+    {
+        printf(COLOR_GREEN "✓ PASS" COLOR_RESET ": %s\n", description);
+        tests_passed++;
+    }
+    else
+    {
+        printf(COLOR_RED "✗ FAIL" COLOR_RESET ": %s\n", description);
+        tests_failed++;
+    }
+}
+
+/* Compile "source" et renvoie le C genere (a liberer), NULL si erreur */
+static char *compile_to_c(const char *source, int *status)
+{
+    char *text = NULL;
+    size_t size = 0;
+    MathLangContext ctx;
+    ml_context_init(&ctx);
+    ctx.options.c_out = open_memstream(&text, &size);
+    *status = ml_compile_string(&ctx, source, strlen(source));
+    fclose(ctx.options.c_out);
+    if (*status != 0 || !ctx.c_generated)
+    {
+        free(text);
+        return NULL;
+    }
+    return text;
+}
+
+/* ========================================================= */
+/* TEST 1 : COMPILATION SEQUENTIELLE                         */
+/* ========================================================= */
+
+static char *reference[2];
+
+static void test_sequential(void)
+{
+    print_test_header("Compilation sequentielle (reference)");
+    for (int p = 0; p < 2; p++)
+    {
+        int status;
+        reference[p] = compile_to_c(programs[p], &status);
+        assert_test("le programme compile sans erreur", status == 0 && reference[p] != NULL);
+    }
+
+    int status;
+    char *again = compile_to_c(programs[0], &status);
+    assert_test("une seconde compilation dans le meme thread donne le meme C",
+                again && reference[0] && strcmp(again, reference[0]) == 0);
+    free(again);
+
+    char *bad = compile_to_c("SOIT x dans Z tel que x <- 1\ny <- 2\n", &status);
+    assert_test("erreur semantique : statut 1 et pas de C", status == 1 && bad == NULL);
+    free(bad);
+
+    /* Un parametre au-dela de FT_MAX_PARAMS est une erreur, pas un oubli */
+    char large[2048] = "FONCTION large(";
+    for (int p = 0; p <= FT_MAX_PARAMS; p++)
+        snprintf(large + strlen(large), sizeof(large) - strlen(large), "%sp%d : Z", p ? ", " : "", p);
+    strncat(large, ") : Z\n    RETOURNER p0\nFIN\n", sizeof(large) - strlen(large) - 1);
+    bad = compile_to_c(large, &status);
+    assert_test("trop de parametres : statut 1 et pas de C", status == 1 && bad == NULL);
+    free(bad);
+}
+
+/* ========================================================= */
+/* TEST 2 : COMPILATIONS PARALLELES                          */
+/* ========================================================= */
+
+typedef struct
+{
+    int index;
+    int mismatches;
+} Worker;
+
+static void *worker_main(void *arg)
+{
+    Worker *w = (Worker *)arg;
+    for (int r = 0; r < ROUNDS; r++)
+    {
+        int p = (w->index + r) % 2;
+        int status;
+        char *c = compile_to_c(programs[p], &status);
+        if (!c || strcmp(c, reference[p]) != 0) w->mismatches++;
+        free(c);
+    }
+    return NULL;
+}
+
+static void test_parallel(void)
+{
+    print_test_header("Compilations paralleles");
+    pthread_t threads[NTHREADS];
+    Worker workers[NTHREADS];
+    for (int i = 0; i < NTHREADS; i++)
+    {
+        workers[i].index = i;
+        workers[i].mismatches = 0;
+        pthread_create(&threads[i], NULL, worker_main, &workers[i]);
+    }
+    int mismatches = 0;
+    for (int i = 0; i < NTHREADS; i++)
+    {
+        pthread_join(threads[i], NULL);
+        mismatches += workers[i].mismatches;
+    }
+    printf("%d threads x %d compilations, %d C different(s) de la reference\n",
+           NTHREADS, ROUNDS, mismatches);
+    assert_test("chaque thread produit exactement le C de la reference", mismatches == 0);
+}
+
+/* ========================================================= */
+/* TEST 3 : OPTIONS DE COMPILATION                           */
+/* ========================================================= */
+
+static void test_options(void)
+{
+    print_test_header("Options de compilation");
+    MathLangContext ctx;
+    ml_context_init(&ctx);
+    MlOptions *o = &ctx.options;
+
+    assert_test("--unroll=8 accepte", ml_parse_option(o, "--unroll=8") == 1 && o->opt.unroll_factor == 8);
+    assert_test("--unroll=0 accepte (aucun deroulement)", ml_parse_option(o, "--unroll=0") == 1);
+    assert_test("--unroll=-3 refuse", ml_parse_option(o, "--unroll=-3") == -1);
+    assert_test("--unroll=8x refuse", ml_parse_option(o, "--unroll=8x") == -1);
+    assert_test("--unroll= refuse", ml_parse_option(o, "--unroll=") == -1);
+    assert_test("--unroll au-dela du maximum refuse", ml_parse_option(o, "--unroll=99999999999") == -1);
+    assert_test("--memo-capacity=0 refuse", ml_parse_option(o, "--memo-capacity=0") == -1);
+    assert_test("--memo-capacity=abc refuse", ml_parse_option(o, "--memo-capacity=abc") == -1);
+    assert_test("--memo-capacity=16 accepte",
+                ml_parse_option(o, "--memo-capacity=16") == 1 && o->memo_capacity == 16);
+    assert_test("option inconnue : 0", ml_parse_option(o, "--inconnue") == 0);
+}
+
+/* ========================================================= */
+/* TEST 4 : UNITES DE --incremental ET #line                 */
+/* ========================================================= */
+
+/* Compile le fichier "path" en unites (#line actives), NULL si erreur */
+static CUnit *compile_units(const char *path, const char *source, int *count)
+{
+    FILE *f = fopen(path, "w");
+    if (!f)
+        return NULL;
+    fputs(source, f);
+    fclose(f);
+
+    MathLangContext ctx;
+    ml_context_init(&ctx);
+    ctx.options.split_units = 1;
+    ctx.options.line_directives = 1;
+    ml_parse_option(&ctx.options, "-fno-inline");
+    CUnit *units = NULL;
+    *count = 0;
+    if (ml_compile_file(&ctx, path) == 0 && ctx.c_generated)
+    {
+        units = ctx.units;
+        *count = ctx.unit_count;
+        ctx.units = NULL;
+        ctx.unit_count = 0;
+    }
+    ml_free_units(&ctx);
+    remove(path);
+    return units;
+}
+
+static const CUnit *find_unit(const CUnit *units, int count, const char *name)
+{
+    for (int u = 0; u < count; u++)
+        if (strcmp(units[u].name, name) == 0)
+            return &units[u];
+    return NULL;
+}
+
+static bool same_unit(const CUnit *a, const CUnit *b)
+{
+    return a && b && a->size == b->size && memcmp(a->text, b->text, a->size) == 0;
+}
+
+static void test_units(void)
+{
+    print_test_header("Unites de --incremental apres ajout de lignes");
+    /* Le corps de "premier" gagne trois lignes dans la seconde version :
+       "second" et main sont decalees mais inchangees (sans integration,
+       qui recopierait "premier" dans main) */
+    static const char *const versions[2] = {
+        "FONCTION premier(n : Z) : Z\n"
+        "    RETOURNER n + 1\n"
+        "FIN\n"
+        "FONCTION second(n : Z) : Z\n"
+        "    RETOURNER n * 3\n"
+        "FIN\n"
+        "SOIT k dans Z\n"
+        "LIRE(k)\n"
+        "AFFICHER_LIGNE(premier(k) + second(k))\n",
+
+        "FONCTION premier(n : Z) : Z\n"
+        "    SI n > 100 ALORS\n"
+        "        RETOURNER n\n"
+        "    FIN\n"
+        "    RETOURNER n + 1\n"
+        "FIN\n"
+        "FONCTION second(n : Z) : Z\n"
+        "    RETOURNER n * 3\n"
+        "FIN\n"
+        "SOIT k dans Z\n"
+        "LIRE(k)\n"
+        "AFFICHER_LIGNE(premier(k) + second(k))\n",
+    };
+    char path[] = "/tmp/mathlang_unites_XXXXXX.ml";
+    int fd = mkstemps(path, 3);
+    if (fd < 0)
+    {
+        assert_test("fichier temporaire cree", false);
+        return;
+    }
+    close(fd);
+
+    int count[2];
+    CUnit *units[2];
+    for (int v = 0; v < 2; v++)
+        units[v] = compile_units(path, versions[v], &count[v]);
+    assert_test("les deux versions compilent en unites", units[0] && units[1]);
+    if (units[0] && units[1])
+    {
+        const CUnit *second = find_unit(units[0], count[0], "second");
+        assert_test("une unite ne contient pas de #line",
+                    second && !strstr(second->text, "#line"));
+        assert_test("fonction decalee : meme unite (reprise du cache)",
+                    same_unit(second, find_unit(units[1], count[1], "second")));
+        assert_test("main decale : meme unite (reprise du cache)",
+                    same_unit(find_unit(units[0], count[0], "main"),
+                              find_unit(units[1], count[1], "main")));
+    }
+    free_c_units(units[0], count[0]);
+    free_c_units(units[1], count[1]);
+}
+
+/* ========================================================= */
+/* MAIN                                                      */
+/* ========================================================= */
+
+int main(void)
+{
+    test_sequential();
+    if (reference[0] && reference[1]) test_parallel();
+    test_options();
+    test_units();
+
+    printf("\nTests reussis : %d, echoues : %d\n", tests_passed, tests_failed);
+    free(reference[0]);
+    free(reference[1]);
+    return tests_failed == 0 ? 0 : 1;
+}
@@ -4,7 +4,9 @@
 
 #include "symbol_table.h"
 #include <stdio.h>
+#include <stdlib.h>
 #include <stdbool.h>
+#include <time.h>
 
 /* Couleurs pour l'affichage */
 #define COLOR_GREEN "\033[0;32m"
@@ -280,6 +282,149 @@ void test_realistic_scenario(void)
     free_symbol_table(table);
 }
 
+/* ========================================================= */
+/* TEST 10 : STRESS - UN MILLION DE SYMBOLES IMBRIQUÉS       */
+/* ========================================================= */
+
+#define STRESS_DEPTH 1000
+#define STRESS_NAMES 1000
+
+static double elapsed_ms(clock_t start)
+{
+    return (double)(clock() - start) * 1000.0 / CLOCKS_PER_SEC;
+}
+
+/* Boucles POUR imbriquées qui redéclarent les mêmes noms : chaque
+   portée masque la précédente, la sortie ne doit coûter que ses
+   propres symboles. */
+void test_stress_nested_scopes(void)
+{
+    print_test_header("Stress : 10^6 symboles, 1000 portées imbriquées");
+
+    SymbolTable *table = init_symbol_table();
+    char name[16];
+    bool inner_found = true;
+
+    clock_t t0 = clock();
+    for (int d = 1; d <= STRESS_DEPTH; d++)
+    {
+        enter_scope(table);
+        for (int k = 0; k < STRESS_NAMES; k++)
+        {
+            snprintf(name, sizeof(name), "v%d", k);
+            add_symbol(table, name, SYMBOL_VARIABLE, TYPE_Z, SUBTYPE_DEFAULT, d, k);
+        }
+    }
+    double t_add = elapsed_ms(t0);
+
+    t0 = clock();
+    for (int k = 0; k < STRESS_NAMES; k++)
+    {
+        snprintf(name, sizeof(name), "v%d", k);
+        for (int r = 0; r < STRESS_DEPTH; r++)
+        {
+            SymbolEntry *e = find_symbol(table, name);
+            if (!e || e->scope_level != STRESS_DEPTH) inner_found = false;
+        }
+    }
+    double t_find = elapsed_ms(t0);
+
+    assert_test("10^6 symboles dans la table", table->count == STRESS_DEPTH * STRESS_NAMES);
+    assert_test("find_symbol renvoie la déclaration la plus interne", inner_found);
+
+    t0 = clock();
+    bool levels_ok = true;
+    for (int d = STRESS_DEPTH; d >= 1; d--)
+    {
+        SymbolEntry *e = find_symbol(table, "v0");
+        if (!e || e->scope_level != d) levels_ok = false;
+        exit_scope(table);
+    }
+    double t_exit = elapsed_ms(t0);
+
+    assert_test("chaque sortie démasque la portée englobante", levels_ok);
+    assert_test("table vide après les sorties", table->count == 0 && !find_symbol(table, "v0"));
+    printf("ajout %.1f ms, 10^6 recherches %.1f ms, 1000 sorties %.1f ms\n",
+           t_add, t_find, t_exit);
+
+    /* remove_symbol détache aussi le symbole de la liste de sa portée */
+    add_symbol(table, "g", SYMBOL_VARIABLE, TYPE_Z, SUBTYPE_DEFAULT, 1, 1);
+    enter_scope(table);
+    add_symbol(table, "g", SYMBOL_VARIABLE, TYPE_R, SUBTYPE_DEFAULT, 2, 1);
+    add_symbol(table, "h", SYMBOL_VARIABLE, TYPE_R, SUBTYPE_DEFAULT, 3, 1);
+    remove_symbol(table, "g");
+    SymbolEntry *g = find_symbol(table, "g");
+    assert_test("remove_symbol retire la déclaration interne", g && g->type == TYPE_Z);
+    exit_scope(table);
+    assert_test("sortie après remove_symbol", table->count == 1 && !find_symbol(table, "h"));
+
+    free_symbol_table(table);
+}
+
+/* ========================================================= */
+/* TEST 11 : DÉBIT DES RECHERCHES (10^3, 10^5, 10^6)          */
+/* ========================================================= */
+
+#define LOOKUPS 2000000
+#define NAME_SIZE 12
+
+/* n globales, puis LOOKUPS recherches d'un nom pris au hasard : par une
+   chaîne venant d'ailleurs (strcmp) et par le nom interné (pointeur) */
+static void bench_lookups(int n)
+{
+    SymbolTable *table = init_symbol_table();
+    char *names = malloc((size_t)n * NAME_SIZE);
+    int *picks = malloc(sizeof(int) * LOOKUPS);
+    for (int i = 0; i < n; i++)
+        snprintf(names + (size_t)i * NAME_SIZE, NAME_SIZE, "g%d", i);
+    srand(42);
+    for (int k = 0; k < LOOKUPS; k++)
+        picks[k] = (int)(((unsigned)rand() * 65536u + (unsigned)rand()) % (unsigned)n);
+
+    clock_t t0 = clock();
+    for (int i = 0; i < n; i++)
+        add_symbol(table, names + (size_t)i * NAME_SIZE, SYMBOL_VARIABLE, TYPE_Z,
+                   SUBTYPE_DEFAULT, i, 1);
+    double t_add = elapsed_ms(t0);
+
+    int found = 0;
+    t0 = clock();
+    for (int k = 0; k < LOOKUPS; k++)
+        found += find_symbol(table, names + (size_t)picks[k] * NAME_SIZE) != NULL;
+    double t_find = elapsed_ms(t0);
+
+    const char **interned = malloc(sizeof(char *) * n);
+    for (int i = 0; i < n; i++)
+        interned[i] = find_symbol(table, names + (size_t)i * NAME_SIZE)->name;
+    int same = 0;
+    t0 = clock();
+    for (int k = 0; k < LOOKUPS; k++)
+    {
+        SymbolEntry *e = find_symbol(table, interned[picks[k]]);
+        same += e && e->name == interned[picks[k]];
+    }
+    double t_interned = elapsed_ms(t0);
+
+    char description[96];
+    snprintf(description, sizeof(description), "%d symboles : toutes les recherches aboutissent", n);
+    assert_test(description, found == LOOKUPS && same == LOOKUPS && table->count == n);
+    printf("%8d symboles : ajout %.1f ms, %.1f M recherches/s, %.1f M/s par nom interné\n",
+           n, t_add, LOOKUPS / t_find / 1000.0, LOOKUPS / t_interned / 1000.0);
+
+    free(interned);
+    free(picks);
+    free(names);
+    free_symbol_table(table);
+}
+
+void test_lookup_throughput(void)
+{
+    print_test_header("Débit des recherches");
+    bench_lookups(1000);
+    bench_lookups(100000);
+    bench_lookups(1000000);
+}
+
 /* ========================================================= */
 /* MAIN                                                      */
 /* ========================================================= */
@@ -301,6 +446,8 @@ int main(void)
     test_type_inference();
     test_type_predicates();
     test_realistic_scenario();
+    test_stress_nested_scopes();
+    test_lookup_throughput();
 
     printf("\n╔═══════════════════════════════════════════════════════════╗\n");
     printf("║ RÉSULTATS FINAUX                                          ║\n");
@@ -0,0 +1,31 @@
+# =====================================================================
+#  TEST DES APPELS EN ARGUMENT
+# =====================================================================
+#  Un argument qui est lui-meme un appel : les parametres de l'appel
+#  interne ne doivent pas se meler a ceux de l'appel externe.
+#  ackermann(2, n) = 2n + 3 ; ecart(10, carre(3)) = 1 ;
+#  ecart(carre(2), ecart(9, carre(2))) = -1
+#  Sortie attendue : 13, 1, -1
+# =====================================================================
+FONCTION ackermann(m : Z, n : Z) : Z
+    SI m = 0 ALORS
+        RETOURNER n + 1
+    FIN
+    SI n = 0 ALORS
+        RETOURNER ackermann(m - 1, 1)
+    FIN
+    RETOURNER ackermann(m - 1, ackermann(m, n - 1))
+FIN
+
+FONCTION carre(x : Z) : Z
+    RETOURNER x * x
+FIN
+
+FONCTION ecart(a : Z, b : Z) : Z
+    RETOURNER a - b
+FIN
+
+SOIT n dans Z tel que n <- 5
+AFFICHER_LIGNE(ackermann(2, n))
+AFFICHER_LIGNE(ecart(10, carre(n - 2)))
+AFFICHER_LIGNE(ecart(carre(n - 3), ecart(9, carre(n - 3))))
@@ -0,0 +1,49 @@
+# =====================================================================
+#  TEST DES SAUTS DE BOUCLE (SORTIR, CONTINUER)
+# =====================================================================
+#  SORTIR et CONTINUER visent la boucle la plus interne, quelle que
+#  soit sa nature. Dans POUR ... PAR, CONTINUER passe par
+#  l'incrementation et SORTIR quitte la boucle.
+#  Attendu : 29, 12, 4, 3, 112
+# =====================================================================
+
+SOIT s dans Z tel que s <- 0
+POUR i DE 1 A 20 PAR 2 FAIRE
+    SI i = 7 ALORS
+        CONTINUER
+    FIN
+    SI i > 12 ALORS
+        SORTIR
+    FIN
+    s <- s + i
+FIN
+AFFICHER_LIGNE(s)
+SOIT k dans Z tel que k <- 0
+SOIT t dans Z tel que t <- 0
+TANT QUE k < 5 FAIRE
+    k <- k + 1
+    POUR j DE 1 A 10 FAIRE
+        SI j > 3 ALORS
+            SORTIR
+        FIN
+        t <- t + 1
+    FIN
+    SI k = 4 ALORS
+        SORTIR
+    FIN
+FIN
+AFFICHER_LIGNE(t)
+AFFICHER_LIGNE(k)
+SOIT r dans Z tel que r <- 0
+REPETER
+    r <- r + 1
+    SI r = 3 ALORS
+        SORTIR
+    SINON SI r = 1 ALORS
+        CONTINUER
+    SINON
+        t <- t + 100
+    FIN
+JUSQUA r >= 10
+AFFICHER_LIGNE(r)
+AFFICHER_LIGNE(t)
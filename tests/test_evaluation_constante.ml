@@ -0,0 +1,75 @@
+# =====================================================================
+#  TEST DE L'EVALUATION DES APPELS CONSTANTS A LA COMPILATION
+# =====================================================================
+#  Chaque appel a arguments constants est remplace par son resultat.
+#  Les valeurs doivent etre celles du programme compile sans
+#  optimisation (-O0) : factorielle(25) et puissance(3, 41) debordent
+#  et bouclent modulo 2^64, tiers(1.0) est arrondi en double.
+#  collatz(837799) depasse la profondeur de recursion permise a
+#  l'evaluation : l'appel reste a l'execution.
+#  Une variable affectee une seule fois, mais dans une branche non
+#  prise, n'est pas une constante : carre(x) vaut 0.
+# =====================================================================
+
+SOIT_CONST N dans Z tel que N <- 12
+SOIT_CONST X dans R tel que X <- 0.1
+
+FONCTION factorielle(n : Z) : Z
+    SI n <= 1 ALORS
+        RETOURNER 1
+    SINON
+        RETOURNER n * factorielle(n - 1)
+    FIN
+FIN
+
+FONCTION puissance(b : Z, e : Z) : Z
+    SI e = 0 ALORS
+        RETOURNER 1
+    FIN
+    RETOURNER b * puissance(b, e - 1)
+FIN
+
+FONCTION hypot2(a : R, b : R) : R
+    RETOURNER sqrt(a * a + b * b)
+FIN
+
+FONCTION tiers(x : R) : R
+    RETOURNER x / 3
+FIN
+
+FONCTION carre(x : Z) : Z
+    RETOURNER x * x
+FIN
+
+FONCTION pair(x : Z) : B
+    RETOURNER x mod 2 = 0
+FIN
+
+FONCTION collatz(n : Z) : Z
+    SI n = 1 ALORS
+        RETOURNER 0
+    FIN
+    SI n mod 2 = 0 ALORS
+        RETOURNER 1 + collatz(n div 2)
+    FIN
+    RETOURNER 1 + collatz(3 * n + 1)
+FIN
+
+AFFICHER_LIGNE(factorielle(10))
+AFFICHER_LIGNE(factorielle(25))
+AFFICHER_LIGNE(factorielle(N))
+AFFICHER_LIGNE(puissance(3, 41))
+AFFICHER_LIGNE(hypot2(3.0, 4.0))
+AFFICHER_LIGNE(hypot2(X, X))
+AFFICHER_LIGNE(tiers(1.0) * 3.0)
+AFFICHER_LIGNE(carre(carre(3)))
+AFFICHER_LIGNE(pair(carre(7)))
+AFFICHER_LIGNE(collatz(27))
+AFFICHER_LIGNE(collatz(837799))
+
+SOIT c dans B tel que c <- faux
+SOIT x dans Z
+SI c ALORS
+    x <- 5
+FIN
+AFFICHER_LIGNE(carre(x))
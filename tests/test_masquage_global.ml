@@ -0,0 +1,27 @@
+# =====================================================================
+#  TEST D'UNE GLOBALE MASQUEE PAR UN PARAMETRE
+# =====================================================================
+#  decale lit la globale n ; somme a un parametre n qui la masque.
+#  Integrer decale dans somme ne doit pas lui faire lire ce parametre.
+#  somme(n) = decale(n) + decale(1) = n + 201 pour n >= 0, et
+#  somme(n) = -somme(-n) sinon (appel non terminal : somme n'est
+#  pas integree, son corps s'execute tel quel).
+#  Sortie attendue : 201, 202, 203, -206
+# =====================================================================
+SOIT n dans Z tel que n <- 100
+
+FONCTION decale(x : Z) : Z
+    RETOURNER x + n
+FIN
+
+FONCTION somme(n : Z) : Z
+    SI n < 0 ALORS
+        RETOURNER 0 - somme(0 - n)
+    FIN
+    RETOURNER decale(n) + decale(1)
+FIN
+
+POUR i DE 0 A 2 FAIRE
+    AFFICHER_LIGNE(somme(i))
+FIN
+AFFICHER_LIGNE(somme(0 - 5))
@@ -0,0 +1,39 @@
+# =====================================================================
+#  TEST DE L'ANNOTATION MEMOISER
+# =====================================================================
+#  - fibonacci(90) en recursion naive : sans cache, l'executable ne
+#    terminerait pas dans le delai de scripts/run_tests.sh
+#  - cle composee de parametres R, Char et Z
+#  - une fonction impure annotee : le compilateur doit avertir et
+#    generer un appel normal
+# =====================================================================
+
+SOIT appels dans Z tel que appels <- 0
+
+MEMOISER
+FONCTION fibonacci(n : Z) : Z
+    SI n <= 1 ALORS
+        RETOURNER n
+    SINON
+        RETOURNER fibonacci(n - 1) + fibonacci(n - 2)
+    FIN
+FIN
+
+MEMOISER
+FONCTION pondere(x : R, c : Char, n : Z) : R
+    RETOURNER x * n
+FIN
+
+# Lit une variable globale modifiable : MEMOISER ignore (avertissement)
+MEMOISER
+FONCTION decalee(n : Z) : Z
+    RETOURNER n + appels
+FIN
+
+AFFICHER("fibonacci(90) = ") AFFICHER_LIGNE(fibonacci(90))
+AFFICHER("pondere(1.5, 'a', 4) = ") AFFICHER_LIGNE(pondere(1.5, 'a', 4))
+AFFICHER("pondere(1.5, 'b', 4) = ") AFFICHER_LIGNE(pondere(1.5, 'b', 4))
+appels <- 10
+AFFICHER("decalee(1) = ") AFFICHER_LIGNE(decalee(1))
+appels <- 20
+AFFICHER("decalee(1) = ") AFFICHER_LIGNE(decalee(1))
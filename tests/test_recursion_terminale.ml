@@ -0,0 +1,45 @@
+# =====================================================================
+#  TEST DE L'ELIMINATION DES APPELS RECURSIFS TERMINAUX
+# =====================================================================
+#  Profondeur 10^7 : sans la transformation en boucle, la pile C
+#  deborde. factorielle et somme passent par un accumulateur
+#  (RETOURNER n * f(n - 1)), pgcd et compte sont terminaux directs.
+#  factorielle(10^7) vaut 0 en arithmetique 64 bits (2^64 divise n!
+#  des que n >= 66).
+# =====================================================================
+
+FONCTION factorielle(n : Z) : Z
+    SI n <= 1 ALORS
+        RETOURNER 1
+    SINON
+        RETOURNER n * factorielle(n - 1)
+    FIN
+FIN
+
+FONCTION somme(n : Z) : Z
+    SI n = 0 ALORS
+        RETOURNER 0
+    FIN
+    RETOURNER n + somme(n - 1)
+FIN
+
+FONCTION pgcd(a : Z, b : Z) : Z
+    SI b = 0 ALORS
+        RETOURNER a
+    FIN
+    RETOURNER pgcd(b, a mod b)
+FIN
+
+PROCEDURE compte(n : Z, pas : Z)
+    SI n > 0 ALORS
+        AFFICHER(n) AFFICHER(" ")
+        compte(n - pas, pas)
+    FIN
+FIN
+
+AFFICHER("factorielle(20) = ") AFFICHER_LIGNE(factorielle(20))
+AFFICHER("factorielle(10^7) = ") AFFICHER_LIGNE(factorielle(10000000))
+AFFICHER("somme(10^7) = ") AFFICHER_LIGNE(somme(10000000))
+AFFICHER("pgcd(1071, 462) = ") AFFICHER_LIGNE(pgcd(1071, 462))
+compte(10, 3)
+AFFICHER_LIGNE("")
@@ -0,0 +1,63 @@
+# =====================================================================
+#  TEST DE LA PROPAGATION INTERPROCEDURALE ET DE LA SPECIALISATION
+# =====================================================================
+#  arrondi recoit toujours 3 chiffres et norme toujours DIM : le
+#  parametre est remplace par la constante dans le corps. puissance et
+#  ligne ne recoivent une constante qu'a certains sites : ces sites
+#  appellent un clone specialise (puissance#1...), les autres gardent
+#  la fonction d'origine. Les arguments variables viennent des boucles
+#  pour que les appels ne soient pas evalues a la compilation.
+#  Dans choisir, y n'est affecte que dans une branche non prise : ce
+#  n'est pas une constante, suivant(y) recoit 2.
+# =====================================================================
+
+SOIT_CONST DIM dans Z tel que DIM <- 8
+SOIT x dans R tel que x <- 0.0
+SOIT drapeau dans B tel que drapeau <- faux
+
+FONCTION arrondi(v : R, chiffres : Z) : R
+    RETOURNER floor(v * 10 ^ chiffres + 0.5) / 10 ^ chiffres
+FIN
+
+FONCTION puissance(b : Z, e : Z) : Z
+    SI e = 0 ALORS
+        RETOURNER 1
+    FIN
+    RETOURNER b * puissance(b, e - 1)
+FIN
+
+FONCTION norme(a : R, b : R, dim : Z) : R
+    RETOURNER sqrt(a * a + b * b) * dim
+FIN
+
+PROCEDURE ligne(largeur : Z, c : Char)
+    POUR i DE 1 A largeur FAIRE
+        AFFICHER(c)
+    FIN
+    AFFICHER_LIGNE("")
+FIN
+
+FONCTION suivant(v : Z) : Z
+    RETOURNER v + 1
+FIN
+
+FONCTION choisir(y : Z, c : B) : Z
+    SI c ALORS
+        y <- 5
+    FIN
+    RETOURNER suivant(y)
+FIN
+
+POUR k DE 1 A 20 PAR 7 FAIRE
+    x <- k * 1.5
+    AFFICHER_LIGNE(arrondi(x / 7, 3))
+    AFFICHER_LIGNE(puissance(2, k))
+    AFFICHER_LIGNE(puissance(k, 3))
+    AFFICHER_LIGNE(puissance(k, k))
+    AFFICHER_LIGNE(norme(x, 1.0, DIM))
+    AFFICHER_LIGNE(norme(1.0, x, DIM))
+    ligne(k, '*')
+    ligne(k + 2, '-')
+FIN
+ligne(10, '=')
+AFFICHER_LIGNE(choisir(2, drapeau))
@@ -0,0 +1,28 @@
+# =====================================================================
+#  TEST DES VARIABLES LOCALES (C genere)
+# =====================================================================
+#  Chaque fonction declare ses propres variables de boucle : le meme
+#  nom "i" est reutilise dans a, b et le programme principal sans
+#  collision. "s" n'est lue par aucune fonction et devient une locale
+#  de main.
+#  Sortie attendue : 39
+# =====================================================================
+FONCTION a(n : Z) : Z
+    POUR i DE 1 A n FAIRE
+        RETOURNER n + i * 10
+    FIN
+    RETOURNER 0
+FIN
+FONCTION b(n : Z) : R
+    POUR i DE 1 A n FAIRE
+        SI i = n ALORS
+            RETOURNER i / 2
+        FIN
+    FIN
+    RETOURNER 0.0
+FIN
+SOIT s dans R tel que s <- 0.0
+POUR i DE 1 A 3 FAIRE
+    s <- s + a(i) + b(i)
+FIN
+AFFICHER_LIGNE(s)
@@ -62,6 +62,7 @@ extern YYSTYPE yylval;
 #define TOK_PROCEDURE       151
 #define TOK_RETOURNER       152
 #define TOK_LAMBDA          153
+#define TOK_MEMOISER        154
 
 /* ============================================ */
 /* CONSTANTES BOOLÉENNES                       */